@@ -16,6 +16,12 @@
 #define NUCLEUS_ARCH_X86
 #endif
 #if defined(__arm__) || defined(_M_ARM)
+#define NUCLEUS_ARCH_ARM_32BITS
+#endif
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define NUCLEUS_ARCH_ARM_64BITS
+#endif
+#if defined(NUCLEUS_ARCH_ARM_32BITS) || defined(NUCLEUS_ARCH_ARM_64BITS)
 #define NUCLEUS_ARCH_ARM
 #endif
 
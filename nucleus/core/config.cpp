@@ -15,6 +15,14 @@ Config::Config() {
     // Default settings
     console = false;
     debugger = false;
+    profile = false;
+    profileCycles = false;
+    perfMap = false;
+    spuAsyncDma = false;
+    hugePages = false;
+    memoryStats = false;
+    traceAlloc = false;
+    fastmem = false;
 
     language = LANGUAGE_DEFAULT;
     ppuTranslator = CPU_TRANSLATOR_FUNCTION;
@@ -32,6 +40,44 @@ void Config::parseArguments(int argc, char** argv) {
         if (!strcmp(argv[i], "--debugger")) {
             debugger = true;
         }
+        if (!strcmp(argv[i], "--profile")) {
+            profile = true;
+        }
+        if (!strcmp(argv[i], "--profile-cycles")) {
+            profile = true;
+            profileCycles = true;
+        }
+        if (!strcmp(argv[i], "--perf-map")) {
+            perfMap = true;
+        }
+        if (!strcmp(argv[i], "--spu-module")) {
+            spuTranslator = CPU_TRANSLATOR_MODULE;
+        }
+        if (!strcmp(argv[i], "--spu-interpreter")) {
+            spuTranslator = CPU_TRANSLATOR_INSTRUCTION;
+        }
+        if (!strcmp(argv[i], "--spu-tiered")) {
+            spuTranslator = static_cast<ConfigCpuTranslator>(CPU_TRANSLATOR_INSTRUCTION | CPU_TRANSLATOR_FUNCTION);
+        }
+        if (!strcmp(argv[i], "--spu-async-dma")) {
+            spuAsyncDma = true;
+        }
+        if (!strcmp(argv[i], "--huge-pages")) {
+            hugePages = true;
+        }
+        if (!strcmp(argv[i], "--memory-stats")) {
+            memoryStats = true;
+        }
+        if (!strcmp(argv[i], "--trace-alloc")) {
+            memoryStats = true;
+            traceAlloc = true;
+        }
+        if (!strcmp(argv[i], "--fastmem")) {
+            fastmem = true;
+        }
+        if (!strcmp(argv[i], "--hir-dump") && i + 1 < argc) {
+            hirDump = argv[++i];
+        }
     }
 
     // Check if booting an executable was requested
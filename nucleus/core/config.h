@@ -54,6 +54,15 @@ public:
     std::string boot;       // Boot the specified file automatically
     bool console;           // Run Nucleus in console-only mode, preventing UI or GPU backends from running
     bool debugger;          // Start Nerve debugging server
+    bool profile;           // Count calls to JIT-compiled functions and report the hottest ones at exit
+    bool profileCycles;     // Additionally measure time spent in JIT-compiled functions
+    bool perfMap;           // Describe JIT-compiled code to Linux perf via /tmp/perf-<pid>.map and jitdump files
+    bool spuAsyncDma;       // Execute large SPU DMA transfers on a background thread
+    bool hugePages;         // Advise transparent huge pages for guest main, user and RSX local memory
+    bool memoryStats;       // Report guest memory usage per segment at exit
+    bool traceAlloc;        // Log guest memory allocations along with the guest code requesting them
+    bool fastmem;           // Emit guest memory accesses relative to a pinned base register, handling faults with slow paths
+    std::string hirDump;    // Save the HIR of every translated PPU/SPU module to this directory at exit
 
     // Saved settings
     ConfigLanguage language;
@@ -0,0 +1,102 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "futex.h"
+
+#if defined(NUCLEUS_TARGET_LINUX) || defined(NUCLEUS_TARGET_ANDROID)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <climits>
+#define NUCLEUS_FUTEX_LINUX
+#elif defined(NUCLEUS_TARGET_WINDOWS)
+#include <Windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#define NUCLEUS_FUTEX_WINDOWS
+#else
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#endif
+
+namespace core {
+
+#if defined(NUCLEUS_FUTEX_LINUX)
+void futexWait(std::atomic<U32>& word, U32 expected) {
+    syscall(SYS_futex, reinterpret_cast<U32*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+}
+
+void futexWakeOne(std::atomic<U32>& word) {
+    syscall(SYS_futex, reinterpret_cast<U32*>(&word), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+}
+
+void futexWakeAll(std::atomic<U32>& word) {
+    syscall(SYS_futex, reinterpret_cast<U32*>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
+void futexWakeOneFromHandler(std::atomic<U32>& word) {
+    futexWakeOne(word);
+}
+
+#elif defined(NUCLEUS_FUTEX_WINDOWS)
+void futexWait(std::atomic<U32>& word, U32 expected) {
+    WaitOnAddress(&word, &expected, sizeof(U32), INFINITE);
+}
+
+void futexWakeOne(std::atomic<U32>& word) {
+    WakeByAddressSingle(&word);
+}
+
+void futexWakeAll(std::atomic<U32>& word) {
+    WakeByAddressAll(&word);
+}
+
+void futexWakeOneFromHandler(std::atomic<U32>& word) {
+    futexWakeOne(word);
+}
+
+#else
+// Waiters are spread over a fixed set of buckets hashed by address
+#define FUTEX_BUCKET_COUNT  64
+
+// Waiters wake up after this period even without notification, since
+// wakeups from signal handlers cannot take the lock of the bucket
+#define FUTEX_RECHECK_MS  1
+
+struct FutexBucket {
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+
+static FutexBucket& getBucket(const void* addr) {
+    static FutexBucket buckets[FUTEX_BUCKET_COUNT];
+    return buckets[(reinterpret_cast<uintptr_t>(addr) >> 2) % FUTEX_BUCKET_COUNT];
+}
+
+void futexWait(std::atomic<U32>& word, U32 expected) {
+    auto& bucket = getBucket(&word);
+    std::unique_lock<std::mutex> lock(bucket.mutex);
+    if (word.load() == expected) {
+        bucket.cv.wait_for(lock, std::chrono::milliseconds(FUTEX_RECHECK_MS));
+    }
+}
+
+void futexWakeOne(std::atomic<U32>& word) {
+    // Buckets are shared, so waking a single thread could pick a waiter of another word
+    futexWakeAll(word);
+}
+
+void futexWakeAll(std::atomic<U32>& word) {
+    auto& bucket = getBucket(&word);
+    std::lock_guard<std::mutex> lock(bucket.mutex);
+    bucket.cv.notify_all();
+}
+
+void futexWakeOneFromHandler(std::atomic<U32>& word) {
+    // Waiters will notice the change on their next periodic check
+}
+#endif
+
+}  // namespace core
@@ -0,0 +1,51 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+
+#include <atomic>
+
+namespace core {
+
+/**
+ * Futex
+ * =====
+ * Parks the calling thread on the address of an atomic word, so that waiting for
+ * another thread does not burn host CPU time. Uses the native primitive of the host
+ * when available (futex on Linux, WaitOnAddress on Windows) and a hashed table of
+ * condition variables otherwise. Spurious wakeups are possible, so callers must
+ * re-check their condition in a loop.
+ */
+
+/**
+ * Block the calling thread while the word holds the expected value
+ * @param[in]  word      Atomic word to wait on
+ * @param[in]  expected  Value the word must hold for the thread to sleep
+ */
+void futexWait(std::atomic<U32>& word, U32 expected);
+
+/**
+ * Wake up one thread waiting on the word
+ * @param[in]  word  Atomic word, modified by the caller before waking up waiters
+ */
+void futexWakeOne(std::atomic<U32>& word);
+
+/**
+ * Wake up every thread waiting on the word
+ * @param[in]  word  Atomic word, modified by the caller before waking up waiters
+ */
+void futexWakeAll(std::atomic<U32>& word);
+
+/**
+ * Wake up one thread waiting on the word, from a signal or exception handler.
+ * Only the native primitives are async-signal-safe: the fallback implementation
+ * does not wake up anyone, and its waiters re-check the word periodically instead.
+ * @param[in]  word  Atomic word, modified by the caller before waking up waiters
+ */
+void futexWakeOneFromHandler(std::atomic<U32>& word);
+
+}  // namespace core
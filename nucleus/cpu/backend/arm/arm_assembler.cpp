@@ -10,7 +10,539 @@ namespace cpu {
 namespace backend {
 namespace arm {
 
-// Instruction set architecture
+// Encoding helpers
+static inline U32 sf(const Register& r) {
+    return r.is64Bit() ? (1U << 31) : 0;
+}
+static inline U32 ftype(const VReg& v) {
+    return v.is64Bit() ? (1U << 22) : 0;
+}
+static inline Reg zr(const Reg& r) {
+    return Reg(REG_ZR, r.size);
+}
+static inline Condition invert(Condition cond) {
+    return static_cast<Condition>(cond ^ 1);
+}
+
+// Registers
+Reg Reg::getWReg() const {
+    return Reg(code, 32);
+}
+Reg Reg::getXReg() const {
+    return Reg(code, 64);
+}
+VReg VReg::getSReg() const {
+    return VReg(code, 32);
+}
+VReg VReg::getDReg() const {
+    return VReg(code, 64);
+}
+VReg VReg::getQReg() const {
+    return VReg(code, 128);
+}
+
+// Assembler
+ARMAssembler::ARMAssembler(Size codeSize, void* codeAddr) :
+    Assembler(codeSize, codeAddr) {
+}
+
+void ARMAssembler::patchBranch(Size offset, Size target) {
+    U32* instr = reinterpret_cast<U32*>(reinterpret_cast<intptr_t>(codeAddr) + offset);
+    const S64 delta = (S64(target) - S64(offset)) >> 2;
+    if ((*instr & 0x7C000000) == 0x14000000) {
+        // B, BL: imm26
+        assert_true(-(1LL << 25) <= delta && delta < (1LL << 25), "Branch target out of range");
+        *instr = (*instr & 0xFC000000) | U32(delta & 0x3FFFFFF);
+    } else {
+        // B.cond, CBZ, CBNZ: imm19
+        assert_true(-(1LL << 18) <= delta && delta < (1LL << 18), "Branch target out of range");
+        *instr = (*instr & 0xFF00001F) | (U32(delta & 0x7FFFF) << 5);
+    }
+}
+
+void ARMAssembler::emitBranch(U32 instr, Label& label) {
+    const Size offset = curSize;
+    emit32(instr);
+    if (label.isBound()) {
+        patchBranch(offset, label.offset);
+    } else {
+        label.references.push_back(offset);
+    }
+}
+
+void ARMAssembler::L(Label& label) {
+    assert_true(!label.isBound(), "Label is already bound");
+    label.offset = curSize;
+    for (const auto& reference : label.references) {
+        patchBranch(reference, curSize);
+    }
+    label.references.clear();
+}
+
+// Data processing (register)
+void ARMAssembler::add(const Reg& rd, const Reg& rn, const Reg& rm) {
+    emit32(sf(rd) | 0x0B000000 | (rm.code << 16) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::adds(const Reg& rd, const Reg& rn, const Reg& rm) {
+    emit32(sf(rd) | 0x2B000000 | (rm.code << 16) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::sub(const Reg& rd, const Reg& rn, const Reg& rm) {
+    emit32(sf(rd) | 0x4B000000 | (rm.code << 16) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::subs(const Reg& rd, const Reg& rn, const Reg& rm) {
+    emit32(sf(rd) | 0x6B000000 | (rm.code << 16) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::cmp(const Reg& rn, const Reg& rm) {
+    subs(zr(rn), rn, rm);
+}
+void ARMAssembler::neg(const Reg& rd, const Reg& rm) {
+    sub(rd, zr(rd), rm);
+}
+void ARMAssembler::and_(const Reg& rd, const Reg& rn, const Reg& rm) {
+    emit32(sf(rd) | 0x0A000000 | (rm.code << 16) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::ands(const Reg& rd, const Reg& rn, const Reg& rm) {
+    emit32(sf(rd) | 0x6A000000 | (rm.code << 16) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::bic(const Reg& rd, const Reg& rn, const Reg& rm) {
+    emit32(sf(rd) | 0x0A200000 | (rm.code << 16) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::orr(const Reg& rd, const Reg& rn, const Reg& rm) {
+    emit32(sf(rd) | 0x2A000000 | (rm.code << 16) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::orn(const Reg& rd, const Reg& rn, const Reg& rm) {
+    emit32(sf(rd) | 0x2A200000 | (rm.code << 16) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::eor(const Reg& rd, const Reg& rn, const Reg& rm) {
+    emit32(sf(rd) | 0x4A000000 | (rm.code << 16) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::tst(const Reg& rn, const Reg& rm) {
+    ands(zr(rn), rn, rm);
+}
+void ARMAssembler::mov(const Reg& rd, const Reg& rm) {
+    orr(rd, zr(rd), rm);
+}
+void ARMAssembler::mvn(const Reg& rd, const Reg& rm) {
+    orn(rd, zr(rd), rm);
+}
+void ARMAssembler::madd(const Reg& rd, const Reg& rn, const Reg& rm, const Reg& ra) {
+    emit32(sf(rd) | 0x1B000000 | (rm.code << 16) | (ra.code << 10) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::msub(const Reg& rd, const Reg& rn, const Reg& rm, const Reg& ra) {
+    emit32(sf(rd) | 0x1B008000 | (rm.code << 16) | (ra.code << 10) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::mul(const Reg& rd, const Reg& rn, const Reg& rm) {
+    madd(rd, rn, rm, zr(rd));
+}
+void ARMAssembler::smulh(const Reg& rd, const Reg& rn, const Reg& rm) {
+    assert_true(rd.is64Bit());
+    emit32(0x9B400000 | (rm.code << 16) | (REG_ZR << 10) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::umulh(const Reg& rd, const Reg& rn, const Reg& rm) {
+    assert_true(rd.is64Bit());
+    emit32(0x9BC00000 | (rm.code << 16) | (REG_ZR << 10) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::smull(const Reg& rd, const Reg& rn, const Reg& rm) {
+    assert_true(rd.is64Bit());
+    emit32(0x9B200000 | (rm.code << 16) | (REG_ZR << 10) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::umull(const Reg& rd, const Reg& rn, const Reg& rm) {
+    assert_true(rd.is64Bit());
+    emit32(0x9BA00000 | (rm.code << 16) | (REG_ZR << 10) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::sdiv(const Reg& rd, const Reg& rn, const Reg& rm) {
+    emit32(sf(rd) | 0x1AC00C00 | (rm.code << 16) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::udiv(const Reg& rd, const Reg& rn, const Reg& rm) {
+    emit32(sf(rd) | 0x1AC00800 | (rm.code << 16) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::lslv(const Reg& rd, const Reg& rn, const Reg& rm) {
+    emit32(sf(rd) | 0x1AC02000 | (rm.code << 16) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::lsrv(const Reg& rd, const Reg& rn, const Reg& rm) {
+    emit32(sf(rd) | 0x1AC02400 | (rm.code << 16) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::asrv(const Reg& rd, const Reg& rn, const Reg& rm) {
+    emit32(sf(rd) | 0x1AC02800 | (rm.code << 16) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::rorv(const Reg& rd, const Reg& rn, const Reg& rm) {
+    emit32(sf(rd) | 0x1AC02C00 | (rm.code << 16) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::clz(const Reg& rd, const Reg& rn) {
+    emit32(sf(rd) | 0x5AC01000 | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::rev16(const Reg& rd, const Reg& rn) {
+    emit32(sf(rd) | 0x5AC00400 | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::rev32(const Reg& rd, const Reg& rn) {
+    assert_true(rd.is64Bit());
+    emit32(0xDAC00800 | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::rev(const Reg& rd, const Reg& rn) {
+    if (rd.is64Bit()) {
+        emit32(0xDAC00C00 | (rn.code << 5) | rd.code);
+    } else {
+        emit32(0x5AC00800 | (rn.code << 5) | rd.code);
+    }
+}
+void ARMAssembler::csel(const Reg& rd, const Reg& rn, const Reg& rm, Condition cond) {
+    emit32(sf(rd) | 0x1A800000 | (rm.code << 16) | (cond << 12) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::csinc(const Reg& rd, const Reg& rn, const Reg& rm, Condition cond) {
+    emit32(sf(rd) | 0x1A800400 | (rm.code << 16) | (cond << 12) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::csinv(const Reg& rd, const Reg& rn, const Reg& rm, Condition cond) {
+    emit32(sf(rd) | 0x5A800000 | (rm.code << 16) | (cond << 12) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::cset(const Reg& rd, Condition cond) {
+    csinc(rd, zr(rd), zr(rd), invert(cond));
+}
+void ARMAssembler::csetm(const Reg& rd, Condition cond) {
+    csinv(rd, zr(rd), zr(rd), invert(cond));
+}
+
+// Data processing (immediate)
+void ARMAssembler::add(const Reg& rd, const Reg& rn, U32 imm12, bool shift12) {
+    assert_true(imm12 < 4096);
+    emit32(sf(rd) | 0x11000000 | (shift12 << 22) | (imm12 << 10) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::adds(const Reg& rd, const Reg& rn, U32 imm12, bool shift12) {
+    assert_true(imm12 < 4096);
+    emit32(sf(rd) | 0x31000000 | (shift12 << 22) | (imm12 << 10) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::sub(const Reg& rd, const Reg& rn, U32 imm12, bool shift12) {
+    assert_true(imm12 < 4096);
+    emit32(sf(rd) | 0x51000000 | (shift12 << 22) | (imm12 << 10) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::subs(const Reg& rd, const Reg& rn, U32 imm12, bool shift12) {
+    assert_true(imm12 < 4096);
+    emit32(sf(rd) | 0x71000000 | (shift12 << 22) | (imm12 << 10) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::cmp(const Reg& rn, U32 imm12) {
+    subs(zr(rn), rn, imm12);
+}
+void ARMAssembler::movz(const Reg& rd, U32 imm16, unsigned shift) {
+    assert_true(imm16 <= 0xFFFF && (shift % 16) == 0 && shift < rd.size);
+    emit32(sf(rd) | 0x52800000 | ((shift / 16) << 21) | (imm16 << 5) | rd.code);
+}
+void ARMAssembler::movk(const Reg& rd, U32 imm16, unsigned shift) {
+    assert_true(imm16 <= 0xFFFF && (shift % 16) == 0 && shift < rd.size);
+    emit32(sf(rd) | 0x72800000 | ((shift / 16) << 21) | (imm16 << 5) | rd.code);
+}
+void ARMAssembler::movn(const Reg& rd, U32 imm16, unsigned shift) {
+    assert_true(imm16 <= 0xFFFF && (shift % 16) == 0 && shift < rd.size);
+    emit32(sf(rd) | 0x12800000 | ((shift / 16) << 21) | (imm16 << 5) | rd.code);
+}
+void ARMAssembler::ubfm(const Reg& rd, const Reg& rn, unsigned immr, unsigned imms) {
+    const U32 n = rd.is64Bit() ? (1 << 22) : 0;
+    emit32(sf(rd) | 0x53000000 | n | (immr << 16) | (imms << 10) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::sbfm(const Reg& rd, const Reg& rn, unsigned immr, unsigned imms) {
+    const U32 n = rd.is64Bit() ? (1 << 22) : 0;
+    emit32(sf(rd) | 0x13000000 | n | (immr << 16) | (imms << 10) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::extr(const Reg& rd, const Reg& rn, const Reg& rm, unsigned lsb) {
+    const U32 n = rd.is64Bit() ? (1 << 22) : 0;
+    emit32(sf(rd) | 0x13800000 | n | (rm.code << 16) | (lsb << 10) | (rn.code << 5) | rd.code);
+}
+void ARMAssembler::lsl(const Reg& rd, const Reg& rn, unsigned shift) {
+    assert_true(shift < rd.size);
+    ubfm(rd, rn, (rd.size - shift) & (rd.size - 1), rd.size - 1 - shift);
+}
+void ARMAssembler::lsr(const Reg& rd, const Reg& rn, unsigned shift) {
+    assert_true(shift < rd.size);
+    ubfm(rd, rn, shift, rd.size - 1);
+}
+void ARMAssembler::asr(const Reg& rd, const Reg& rn, unsigned shift) {
+    assert_true(shift < rd.size);
+    sbfm(rd, rn, shift, rd.size - 1);
+}
+void ARMAssembler::ror(const Reg& rd, const Reg& rn, unsigned shift) {
+    assert_true(shift < rd.size);
+    extr(rd, rn, rn, shift);
+}
+void ARMAssembler::uxtb(const Reg& rd, const Reg& rn) {
+    ubfm(rd.getWReg(), rn.getWReg(), 0, 7);
+}
+void ARMAssembler::uxth(const Reg& rd, const Reg& rn) {
+    ubfm(rd.getWReg(), rn.getWReg(), 0, 15);
+}
+void ARMAssembler::sxtb(const Reg& rd, const Reg& rn) {
+    sbfm(rd, Reg(rn.code, rd.size), 0, 7);
+}
+void ARMAssembler::sxth(const Reg& rd, const Reg& rn) {
+    sbfm(rd, Reg(rn.code, rd.size), 0, 15);
+}
+void ARMAssembler::sxtw(const Reg& rd, const Reg& rn) {
+    assert_true(rd.is64Bit());
+    sbfm(rd, rn.getXReg(), 0, 31);
+}
+
+// Loads and stores (unsigned offset)
+#define EMIT_LDST_UOFFSET(opcode, scale) \
+    assert_true((offset % (scale)) == 0 && (offset / (scale)) < 4096); \
+    emit32((opcode) | ((offset / (scale)) << 10) | (xn.code << 5) | rt.code);
+
+void ARMAssembler::ldrb(const Reg& rt, const Reg& xn, U32 offset) {
+    EMIT_LDST_UOFFSET(0x39400000, 1);
+}
+void ARMAssembler::ldrh(const Reg& rt, const Reg& xn, U32 offset) {
+    EMIT_LDST_UOFFSET(0x79400000, 2);
+}
+void ARMAssembler::ldr(const Reg& rt, const Reg& xn, U32 offset) {
+    if (rt.is64Bit()) {
+        EMIT_LDST_UOFFSET(0xF9400000, 8);
+    } else {
+        EMIT_LDST_UOFFSET(0xB9400000, 4);
+    }
+}
+void ARMAssembler::ldr(const VReg& rt, const Reg& xn, U32 offset) {
+    switch (rt.size) {
+    case 32:  EMIT_LDST_UOFFSET(0xBD400000, 4);  break;
+    case 64:  EMIT_LDST_UOFFSET(0xFD400000, 8);  break;
+    case 128: EMIT_LDST_UOFFSET(0x3DC00000, 16); break;
+    default:
+        assert_always("Unsupported register size");
+    }
+}
+void ARMAssembler::strb(const Reg& rt, const Reg& xn, U32 offset) {
+    EMIT_LDST_UOFFSET(0x39000000, 1);
+}
+void ARMAssembler::strh(const Reg& rt, const Reg& xn, U32 offset) {
+    EMIT_LDST_UOFFSET(0x79000000, 2);
+}
+void ARMAssembler::str(const Reg& rt, const Reg& xn, U32 offset) {
+    if (rt.is64Bit()) {
+        EMIT_LDST_UOFFSET(0xF9000000, 8);
+    } else {
+        EMIT_LDST_UOFFSET(0xB9000000, 4);
+    }
+}
+void ARMAssembler::str(const VReg& rt, const Reg& xn, U32 offset) {
+    switch (rt.size) {
+    case 32:  EMIT_LDST_UOFFSET(0xBD000000, 4);  break;
+    case 64:  EMIT_LDST_UOFFSET(0xFD000000, 8);  break;
+    case 128: EMIT_LDST_UOFFSET(0x3D800000, 16); break;
+    default:
+        assert_always("Unsupported register size");
+    }
+}
+
+#undef EMIT_LDST_UOFFSET
+
+// Loads and stores (register offset)
+void ARMAssembler::ldrb(const Reg& rt, const Reg& xn, const Reg& xm) {
+    emit32(0x38606800 | (xm.code << 16) | (xn.code << 5) | rt.code);
+}
+void ARMAssembler::ldrh(const Reg& rt, const Reg& xn, const Reg& xm) {
+    emit32(0x78606800 | (xm.code << 16) | (xn.code << 5) | rt.code);
+}
+void ARMAssembler::ldr(const Reg& rt, const Reg& xn, const Reg& xm) {
+    emit32((rt.is64Bit() ? 0xF8606800 : 0xB8606800) | (xm.code << 16) | (xn.code << 5) | rt.code);
+}
+void ARMAssembler::strb(const Reg& rt, const Reg& xn, const Reg& xm) {
+    emit32(0x38206800 | (xm.code << 16) | (xn.code << 5) | rt.code);
+}
+void ARMAssembler::strh(const Reg& rt, const Reg& xn, const Reg& xm) {
+    emit32(0x78206800 | (xm.code << 16) | (xn.code << 5) | rt.code);
+}
+void ARMAssembler::str(const Reg& rt, const Reg& xn, const Reg& xm) {
+    emit32((rt.is64Bit() ? 0xF8206800 : 0xB8206800) | (xm.code << 16) | (xn.code << 5) | rt.code);
+}
+
+// Load and store pairs
+void ARMAssembler::stpPre(const Reg& rt1, const Reg& rt2, const Reg& xn, S32 offset) {
+    assert_true(rt1.is64Bit() && (offset % 8) == 0 && -512 <= offset && offset < 512);
+    emit32(0xA9800000 | ((U32(offset / 8) & 0x7F) << 15) | (rt2.code << 10) | (xn.code << 5) | rt1.code);
+}
+void ARMAssembler::ldpPost(const Reg& rt1, const Reg& rt2, const Reg& xn, S32 offset) {
+    assert_true(rt1.is64Bit() && (offset % 8) == 0 && -512 <= offset && offset < 512);
+    emit32(0xA8C00000 | ((U32(offset / 8) & 0x7F) << 15) | (rt2.code << 10) | (xn.code << 5) | rt1.code);
+}
+void ARMAssembler::stpPre(const VReg& vt1, const VReg& vt2, const Reg& xn, S32 offset) {
+    if (vt1.size == 128) {
+        assert_true((offset % 16) == 0 && -1024 <= offset && offset < 1024);
+        emit32(0xAD800000 | ((U32(offset / 16) & 0x7F) << 15) | (vt2.code << 10) | (xn.code << 5) | vt1.code);
+    } else {
+        assert_true(vt1.is64Bit() && (offset % 8) == 0 && -512 <= offset && offset < 512);
+        emit32(0x6D800000 | ((U32(offset / 8) & 0x7F) << 15) | (vt2.code << 10) | (xn.code << 5) | vt1.code);
+    }
+}
+void ARMAssembler::ldpPost(const VReg& vt1, const VReg& vt2, const Reg& xn, S32 offset) {
+    if (vt1.size == 128) {
+        assert_true((offset % 16) == 0 && -1024 <= offset && offset < 1024);
+        emit32(0xACC00000 | ((U32(offset / 16) & 0x7F) << 15) | (vt2.code << 10) | (xn.code << 5) | vt1.code);
+    } else {
+        assert_true(vt1.is64Bit() && (offset % 8) == 0 && -512 <= offset && offset < 512);
+        emit32(0x6CC00000 | ((U32(offset / 8) & 0x7F) << 15) | (vt2.code << 10) | (xn.code << 5) | vt1.code);
+    }
+}
+
+// Branches
+void ARMAssembler::b(Label& label) {
+    emitBranch(0x14000000, label);
+}
+void ARMAssembler::b(Label& label, Condition cond) {
+    emitBranch(0x54000000 | cond, label);
+}
+void ARMAssembler::bl(Label& label) {
+    emitBranch(0x94000000, label);
+}
+void ARMAssembler::cbz(const Reg& rt, Label& label) {
+    emitBranch(sf(rt) | 0x34000000 | rt.code, label);
+}
+void ARMAssembler::cbnz(const Reg& rt, Label& label) {
+    emitBranch(sf(rt) | 0x35000000 | rt.code, label);
+}
+void ARMAssembler::blr(const Reg& xn) {
+    emit32(0xD63F0000 | (xn.code << 5));
+}
+void ARMAssembler::br(const Reg& xn) {
+    emit32(0xD61F0000 | (xn.code << 5));
+}
+void ARMAssembler::ret(const Reg& xn) {
+    emit32(0xD65F0000 | (xn.code << 5));
+}
+
+// System
+void ARMAssembler::dmb(BarrierOption option) {
+    emit32(0xD50330BF | (option << 8));
+}
+void ARMAssembler::mrs(const Reg& xt, SystemRegister sysreg) {
+    emit32(0xD5300000 | (sysreg << 5) | xt.code);
+}
+void ARMAssembler::brk(U32 imm16) {
+    emit32(0xD4200000 | ((imm16 & 0xFFFF) << 5));
+}
+void ARMAssembler::nop() {
+    emit32(0xD503201F);
+}
+
+// Floating-point (scalar)
+void ARMAssembler::fadd(const VReg& vd, const VReg& vn, const VReg& vm) {
+    emit32(0x1E202800 | ftype(vd) | (vm.code << 16) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::fsub(const VReg& vd, const VReg& vn, const VReg& vm) {
+    emit32(0x1E203800 | ftype(vd) | (vm.code << 16) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::fmul(const VReg& vd, const VReg& vn, const VReg& vm) {
+    emit32(0x1E200800 | ftype(vd) | (vm.code << 16) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::fdiv(const VReg& vd, const VReg& vn, const VReg& vm) {
+    emit32(0x1E201800 | ftype(vd) | (vm.code << 16) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::fneg(const VReg& vd, const VReg& vn) {
+    emit32(0x1E214000 | ftype(vd) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::fabs(const VReg& vd, const VReg& vn) {
+    emit32(0x1E20C000 | ftype(vd) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::fsqrt(const VReg& vd, const VReg& vn) {
+    emit32(0x1E21C000 | ftype(vd) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::fmov(const VReg& vd, const VReg& vn) {
+    emit32(0x1E204000 | ftype(vd) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::fmov(const Reg& rd, const VReg& vn) {
+    assert_true(rd.size == vn.size);
+    emit32((rd.is64Bit() ? 0x9E660000 : 0x1E260000) | (vn.code << 5) | rd.code);
+}
+void ARMAssembler::fmov(const VReg& vd, const Reg& rn) {
+    assert_true(vd.size == rn.size);
+    emit32((rn.is64Bit() ? 0x9E670000 : 0x1E270000) | (rn.code << 5) | vd.code);
+}
+void ARMAssembler::fcmp(const VReg& vn, const VReg& vm) {
+    emit32(0x1E202000 | ftype(vn) | (vm.code << 16) | (vn.code << 5));
+}
+void ARMAssembler::fcsel(const VReg& vd, const VReg& vn, const VReg& vm, Condition cond) {
+    emit32(0x1E200C00 | ftype(vd) | (vm.code << 16) | (cond << 12) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::fcvt(const VReg& vd, const VReg& vn) {
+    if (vd.is64Bit()) {
+        assert_true(vn.is32Bit());
+        emit32(0x1E22C000 | (vn.code << 5) | vd.code);
+    } else {
+        assert_true(vn.is64Bit());
+        emit32(0x1E624000 | (vn.code << 5) | vd.code);
+    }
+}
+void ARMAssembler::scvtf(const VReg& vd, const Reg& rn) {
+    emit32(sf(rn) | 0x1E220000 | ftype(vd) | (rn.code << 5) | vd.code);
+}
+void ARMAssembler::fcvtzs(const Reg& rd, const VReg& vn) {
+    emit32(sf(rd) | 0x1E380000 | ftype(vn) | (vn.code << 5) | rd.code);
+}
+
+// SIMD (128-bit vectors)
+void ARMAssembler::and_(const VReg& vd, const VReg& vn, const VReg& vm) {
+    emit32(0x4E201C00 | (vm.code << 16) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::orr(const VReg& vd, const VReg& vn, const VReg& vm) {
+    emit32(0x4EA01C00 | (vm.code << 16) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::eor(const VReg& vd, const VReg& vn, const VReg& vm) {
+    emit32(0x6E201C00 | (vm.code << 16) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::not_(const VReg& vd, const VReg& vn) {
+    emit32(0x6E205800 | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::mov(const VReg& vd, const VReg& vn) {
+    orr(vd, vn, vn);
+}
+void ARMAssembler::add(const VReg& vd, const VReg& vn, const VReg& vm, Arrangement arr) {
+    emit32(0x4E208400 | (arr << 22) | (vm.code << 16) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::sub(const VReg& vd, const VReg& vn, const VReg& vm, Arrangement arr) {
+    emit32(0x6E208400 | (arr << 22) | (vm.code << 16) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::sqadd(const VReg& vd, const VReg& vn, const VReg& vm, Arrangement arr) {
+    emit32(0x4E200C00 | (arr << 22) | (vm.code << 16) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::uqadd(const VReg& vd, const VReg& vn, const VReg& vm, Arrangement arr) {
+    emit32(0x6E200C00 | (arr << 22) | (vm.code << 16) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::sqsub(const VReg& vd, const VReg& vn, const VReg& vm, Arrangement arr) {
+    emit32(0x4E202C00 | (arr << 22) | (vm.code << 16) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::uqsub(const VReg& vd, const VReg& vn, const VReg& vm, Arrangement arr) {
+    emit32(0x6E202C00 | (arr << 22) | (vm.code << 16) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::fadd(const VReg& vd, const VReg& vn, const VReg& vm, Arrangement arr) {
+    assert_true(arr == ARR_4S || arr == ARR_2D);
+    emit32(0x4E20D400 | ((arr == ARR_2D) << 22) | (vm.code << 16) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::fsub(const VReg& vd, const VReg& vn, const VReg& vm, Arrangement arr) {
+    assert_true(arr == ARR_4S || arr == ARR_2D);
+    emit32(0x4EA0D400 | ((arr == ARR_2D) << 22) | (vm.code << 16) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::rev16(const VReg& vd, const VReg& vn) {
+    emit32(0x4E201800 | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::rev32(const VReg& vd, const VReg& vn, Arrangement arr) {
+    assert_true(arr == ARR_16B || arr == ARR_8H);
+    emit32(0x6E200800 | (arr << 22) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::rev64(const VReg& vd, const VReg& vn, Arrangement arr) {
+    assert_true(arr != ARR_2D);
+    emit32(0x4E200800 | (arr << 22) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::ext(const VReg& vd, const VReg& vn, const VReg& vm, unsigned index) {
+    assert_true(index < 16);
+    emit32(0x6E000000 | (vm.code << 16) | (index << 11) | (vn.code << 5) | vd.code);
+}
+void ARMAssembler::umov(const Reg& rd, const VReg& vn, Arrangement arr, unsigned index) {
+    assert_true(index < (16U >> arr));
+    const U32 imm5 = ((index << 1) | 1) << arr;
+    const U32 q = (arr == ARR_2D) ? (1 << 30) : 0;
+    emit32(0x0E003C00 | q | (imm5 << 16) | (vn.code << 5) | rd.code);
+}
+void ARMAssembler::ins(const VReg& vd, Arrangement arr, unsigned index, const Reg& rn) {
+    assert_true(index < (16U >> arr));
+    const U32 imm5 = ((index << 1) | 1) << arr;
+    emit32(0x4E001C00 | (imm5 << 16) | (rn.code << 5) | vd.code);
+}
+
+// Instruction set architecture (pending)
 /*void ARMAssembler::abs(const VReg& vd, const VReg& vn) {
 }
 void ARMAssembler::adc(const Reg& rd, const Reg& rn, const Operand& operand) {
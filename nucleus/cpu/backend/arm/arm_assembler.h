@@ -66,24 +66,242 @@ enum StatusFlags {
     FLAG_NZCV  = FLAG_N | FLAG_Z | FLAG_C | FLAG_V,
 };
 
+// Register index aliases
+enum : unsigned {
+    REG_FP = 29,  // Frame pointer
+    REG_LR = 30,  // Link register
+    REG_SP = 31,  // Stack pointer (only as base or in add/sub immediate)
+    REG_ZR = 31,  // Zero register
+};
+
 class Reg : public Register {
 public:
+    Reg() {}
     Reg(unsigned code, unsigned size) :
         Register(code, size, TYPE_INTEGER) {}
 
-    Reg getWReg();
-    Reg getXReg();
+    Reg getWReg() const;
+    Reg getXReg() const;
+};
+
+class WReg : public Reg {
+public:
+    WReg(unsigned code = 0) : Reg(code, 32) {}
+};
+
+class XReg : public Reg {
+public:
+    XReg(unsigned code = 0) : Reg(code, 64) {}
 };
 
 class VReg : public Register {
 public:
+    VReg() {}
     VReg(unsigned code, unsigned size) :
         Register(code, size, TYPE_VECTOR) {}
+
+    VReg getSReg() const;
+    VReg getDReg() const;
+    VReg getQReg() const;
+};
+
+class SReg : public VReg {
+public:
+    SReg(unsigned code = 0) : VReg(code, 32) {}
+};
+
+class DReg : public VReg {
+public:
+    DReg(unsigned code = 0) : VReg(code, 64) {}
+};
+
+class QReg : public VReg {
+public:
+    QReg(unsigned code = 0) : VReg(code, 128) {}
+};
+
+// Vector arrangement of 128-bit SIMD registers
+enum Arrangement {
+    ARR_16B = 0,  // 16 x 8-bit
+    ARR_8H  = 1,  // 8 x 16-bit
+    ARR_4S  = 2,  // 4 x 32-bit
+    ARR_2D  = 3,  // 2 x 64-bit
+};
+
+// Data memory barrier options
+enum BarrierOption {
+    BARRIER_OSHLD = 0b0001,
+    BARRIER_OSHST = 0b0010,
+    BARRIER_OSH   = 0b0011,
+    BARRIER_NSHLD = 0b0101,
+    BARRIER_NSHST = 0b0110,
+    BARRIER_NSH   = 0b0111,
+    BARRIER_ISHLD = 0b1001,
+    BARRIER_ISHST = 0b1010,
+    BARRIER_ISH   = 0b1011,
+    BARRIER_LD    = 0b1101,
+    BARRIER_ST    = 0b1110,
+    BARRIER_SY    = 0b1111,
+};
+
+// System registers accessible from EL0, encoded as o0:op1:CRn:CRm:op2
+enum SystemRegister {
+    SYSREG_CNTVCT_EL0 = 0x5F02,  // Virtual counter-timer count
 };
 
 class ARMAssembler : public Assembler {
+    // Resolve the branch at the given offset to point to the given target offset
+    void patchBranch(Size offset, Size target);
+
+    // Emit a branch to a label, registering a reference if it is not bound yet
+    void emitBranch(U32 instr, Label& label);
+
 public:
-    // Instruction Set Architecture
+    ARMAssembler(Size codeSize = 4096, void* codeAddr = nullptr);
+
+    // Bind a label to the current position
+    void L(Label& label);
+
+    // Data processing (register)
+    void add(const Reg& rd, const Reg& rn, const Reg& rm);
+    void adds(const Reg& rd, const Reg& rn, const Reg& rm);
+    void sub(const Reg& rd, const Reg& rn, const Reg& rm);
+    void subs(const Reg& rd, const Reg& rn, const Reg& rm);
+    void cmp(const Reg& rn, const Reg& rm); // Alias (subs)
+    void neg(const Reg& rd, const Reg& rm); // Alias (sub)
+    void and_(const Reg& rd, const Reg& rn, const Reg& rm);
+    void ands(const Reg& rd, const Reg& rn, const Reg& rm);
+    void bic(const Reg& rd, const Reg& rn, const Reg& rm);
+    void orr(const Reg& rd, const Reg& rn, const Reg& rm);
+    void orn(const Reg& rd, const Reg& rn, const Reg& rm);
+    void eor(const Reg& rd, const Reg& rn, const Reg& rm);
+    void tst(const Reg& rn, const Reg& rm); // Alias (ands)
+    void mov(const Reg& rd, const Reg& rm); // Alias (orr)
+    void mvn(const Reg& rd, const Reg& rm); // Alias (orn)
+    void madd(const Reg& rd, const Reg& rn, const Reg& rm, const Reg& ra);
+    void msub(const Reg& rd, const Reg& rn, const Reg& rm, const Reg& ra);
+    void mul(const Reg& rd, const Reg& rn, const Reg& rm); // Alias (madd)
+    void smulh(const Reg& rd, const Reg& rn, const Reg& rm);
+    void umulh(const Reg& rd, const Reg& rn, const Reg& rm);
+    void smull(const Reg& rd, const Reg& rn, const Reg& rm);
+    void umull(const Reg& rd, const Reg& rn, const Reg& rm);
+    void sdiv(const Reg& rd, const Reg& rn, const Reg& rm);
+    void udiv(const Reg& rd, const Reg& rn, const Reg& rm);
+    void lslv(const Reg& rd, const Reg& rn, const Reg& rm);
+    void lsrv(const Reg& rd, const Reg& rn, const Reg& rm);
+    void asrv(const Reg& rd, const Reg& rn, const Reg& rm);
+    void rorv(const Reg& rd, const Reg& rn, const Reg& rm);
+    void clz(const Reg& rd, const Reg& rn);
+    void rev16(const Reg& rd, const Reg& rn);
+    void rev32(const Reg& rd, const Reg& rn);
+    void rev(const Reg& rd, const Reg& rn);
+    void csel(const Reg& rd, const Reg& rn, const Reg& rm, Condition cond);
+    void csinc(const Reg& rd, const Reg& rn, const Reg& rm, Condition cond);
+    void csinv(const Reg& rd, const Reg& rn, const Reg& rm, Condition cond);
+    void cset(const Reg& rd, Condition cond); // Alias (csinc)
+    void csetm(const Reg& rd, Condition cond); // Alias (csinv)
+
+    // Data processing (immediate)
+    void add(const Reg& rd, const Reg& rn, U32 imm12, bool shift12 = false);
+    void adds(const Reg& rd, const Reg& rn, U32 imm12, bool shift12 = false);
+    void sub(const Reg& rd, const Reg& rn, U32 imm12, bool shift12 = false);
+    void subs(const Reg& rd, const Reg& rn, U32 imm12, bool shift12 = false);
+    void cmp(const Reg& rn, U32 imm12); // Alias (subs)
+    void movz(const Reg& rd, U32 imm16, unsigned shift = 0);
+    void movk(const Reg& rd, U32 imm16, unsigned shift = 0);
+    void movn(const Reg& rd, U32 imm16, unsigned shift = 0);
+    void ubfm(const Reg& rd, const Reg& rn, unsigned immr, unsigned imms);
+    void sbfm(const Reg& rd, const Reg& rn, unsigned immr, unsigned imms);
+    void extr(const Reg& rd, const Reg& rn, const Reg& rm, unsigned lsb);
+    void lsl(const Reg& rd, const Reg& rn, unsigned shift); // Alias (ubfm)
+    void lsr(const Reg& rd, const Reg& rn, unsigned shift); // Alias (ubfm)
+    void asr(const Reg& rd, const Reg& rn, unsigned shift); // Alias (sbfm)
+    void ror(const Reg& rd, const Reg& rn, unsigned shift); // Alias (extr)
+    void uxtb(const Reg& rd, const Reg& rn); // Alias (ubfm)
+    void uxth(const Reg& rd, const Reg& rn); // Alias (ubfm)
+    void sxtb(const Reg& rd, const Reg& rn); // Alias (sbfm)
+    void sxth(const Reg& rd, const Reg& rn); // Alias (sbfm)
+    void sxtw(const Reg& rd, const Reg& rn); // Alias (sbfm)
+
+    // Loads and stores (unsigned offset, scaled by the access size)
+    void ldrb(const Reg& rt, const Reg& xn, U32 offset = 0);
+    void ldrh(const Reg& rt, const Reg& xn, U32 offset = 0);
+    void ldr(const Reg& rt, const Reg& xn, U32 offset = 0);
+    void ldr(const VReg& vt, const Reg& xn, U32 offset = 0);
+    void strb(const Reg& rt, const Reg& xn, U32 offset = 0);
+    void strh(const Reg& rt, const Reg& xn, U32 offset = 0);
+    void str(const Reg& rt, const Reg& xn, U32 offset = 0);
+    void str(const VReg& vt, const Reg& xn, U32 offset = 0);
+
+    // Loads and stores (register offset)
+    void ldrb(const Reg& rt, const Reg& xn, const Reg& xm);
+    void ldrh(const Reg& rt, const Reg& xn, const Reg& xm);
+    void ldr(const Reg& rt, const Reg& xn, const Reg& xm);
+    void strb(const Reg& rt, const Reg& xn, const Reg& xm);
+    void strh(const Reg& rt, const Reg& xn, const Reg& xm);
+    void str(const Reg& rt, const Reg& xn, const Reg& xm);
+
+    // Load and store pairs (64-bit, pre-indexed and post-indexed)
+    void stpPre(const Reg& rt1, const Reg& rt2, const Reg& xn, S32 offset);
+    void ldpPost(const Reg& rt1, const Reg& rt2, const Reg& xn, S32 offset);
+    void stpPre(const VReg& vt1, const VReg& vt2, const Reg& xn, S32 offset);
+    void ldpPost(const VReg& vt1, const VReg& vt2, const Reg& xn, S32 offset);
+
+    // Branches
+    void b(Label& label);
+    void b(Label& label, Condition cond);
+    void bl(Label& label);
+    void cbz(const Reg& rt, Label& label);
+    void cbnz(const Reg& rt, Label& label);
+    void blr(const Reg& xn);
+    void br(const Reg& xn);
+    void ret(const Reg& xn = XReg(REG_LR));
+
+    // System
+    void dmb(BarrierOption option);
+    void mrs(const Reg& xt, SystemRegister sysreg);
+    void brk(U32 imm16);
+    void nop();
+
+    // Floating-point (scalar)
+    void fadd(const VReg& vd, const VReg& vn, const VReg& vm);
+    void fsub(const VReg& vd, const VReg& vn, const VReg& vm);
+    void fmul(const VReg& vd, const VReg& vn, const VReg& vm);
+    void fdiv(const VReg& vd, const VReg& vn, const VReg& vm);
+    void fneg(const VReg& vd, const VReg& vn);
+    void fabs(const VReg& vd, const VReg& vn);
+    void fsqrt(const VReg& vd, const VReg& vn);
+    void fmov(const VReg& vd, const VReg& vn);
+    void fmov(const Reg& rd, const VReg& vn);
+    void fmov(const VReg& vd, const Reg& rn);
+    void fcmp(const VReg& vn, const VReg& vm);
+    void fcsel(const VReg& vd, const VReg& vn, const VReg& vm, Condition cond);
+    void fcvt(const VReg& vd, const VReg& vn);
+    void scvtf(const VReg& vd, const Reg& rn);
+    void fcvtzs(const Reg& rd, const VReg& vn);
+
+    // SIMD (128-bit vectors)
+    void and_(const VReg& vd, const VReg& vn, const VReg& vm);
+    void orr(const VReg& vd, const VReg& vn, const VReg& vm);
+    void eor(const VReg& vd, const VReg& vn, const VReg& vm);
+    void not_(const VReg& vd, const VReg& vn);
+    void mov(const VReg& vd, const VReg& vn); // Alias (orr)
+    void add(const VReg& vd, const VReg& vn, const VReg& vm, Arrangement arr);
+    void sub(const VReg& vd, const VReg& vn, const VReg& vm, Arrangement arr);
+    void sqadd(const VReg& vd, const VReg& vn, const VReg& vm, Arrangement arr);
+    void uqadd(const VReg& vd, const VReg& vn, const VReg& vm, Arrangement arr);
+    void sqsub(const VReg& vd, const VReg& vn, const VReg& vm, Arrangement arr);
+    void uqsub(const VReg& vd, const VReg& vn, const VReg& vm, Arrangement arr);
+    void fadd(const VReg& vd, const VReg& vn, const VReg& vm, Arrangement arr);
+    void fsub(const VReg& vd, const VReg& vn, const VReg& vm, Arrangement arr);
+    void rev16(const VReg& vd, const VReg& vn);
+    void rev32(const VReg& vd, const VReg& vn, Arrangement arr);
+    void rev64(const VReg& vd, const VReg& vn, Arrangement arr);
+    void ext(const VReg& vd, const VReg& vn, const VReg& vm, unsigned index);
+    void umov(const Reg& rd, const VReg& vn, Arrangement arr, unsigned index);
+    void ins(const VReg& vd, Arrangement arr, unsigned index, const Reg& rn);
+
+    // Instruction Set Architecture (pending)
 /*    void abs(const VReg& vd, const VReg& vn);
     void adc(const Reg& rd, const Reg& rn, const Operand& operand);
     void adcs(const Reg& rd, const Reg& rn, const Operand& operand);
@@ -0,0 +1,213 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "arm_compiler.h"
+#include "nucleus/logger/logger.h"
+#include "nucleus/core/config.h"
+#include "nucleus/cpu/backend/perf_map.h"
+#include "nucleus/cpu/backend/profiler.h"
+#include "nucleus/cpu/backend/arm/arm_emitter.h"
+#include "nucleus/cpu/backend/arm/arm_sequences.h"
+
+#include <cstring>
+
+namespace cpu {
+namespace backend {
+namespace arm {
+
+using namespace cpu::hir;
+
+ARMCompiler::ARMCompiler() : Compiler() {
+    init();
+}
+
+ARMCompiler::ARMCompiler(const Settings& settings) : Compiler(settings) {
+    init();
+}
+
+void ARMCompiler::init() {
+    // Initialize sequences
+    ARMSequences::init();
+
+    // Set target information (AAPCS64)
+    targetInfo.regSets.resize(2);
+    targetInfo.regSets[0].types = RegisterSet::TYPE_INT;
+    targetInfo.regSets[0].valueIndex = {20, 21, 22, 23, 24, 25, 26, 27, 28}; // {x20, ..., x28}
+    targetInfo.regSets[0].argIndex = {0, 1, 2, 3, 4, 5, 6, 7}; // {x0, ..., x7}
+    targetInfo.regSets[0].retIndex = 0; // x0
+    targetInfo.regSets[1].types = RegisterSet::TYPE_FLOAT | RegisterSet::TYPE_VECTOR;
+    targetInfo.regSets[1].valueIndex = {8, 9, 10, 11, 12, 13, 14, 15}; // {v8, ..., v15}
+    targetInfo.regSets[1].argIndex = {0, 1, 2, 3, 4, 5, 6, 7}; // {v0, ..., v7}
+    targetInfo.regSets[1].retIndex = 0; // v0
+}
+
+/**
+ * Save the callee-saved registers used as HIR values: x20-x28 and v8-v15.
+ * AAPCS64 only preserves the lower 64 bits of v8-v15, so save them as Q registers.
+ */
+static void emitSaveRegisters(ARMEmitter& e) {
+    e.stpPre(XReg(REG_FP), XReg(REG_LR), XReg(REG_SP), -16);
+    e.add(XReg(REG_FP), XReg(REG_SP), 0);
+    for (unsigned r = 19; r < 29; r += 2) {
+        e.stpPre(XReg(r), XReg(r + 1), XReg(REG_SP), -16);
+    }
+    for (unsigned v = 8; v < 16; v += 2) {
+        e.stpPre(QReg(v), QReg(v + 1), XReg(REG_SP), -32);
+    }
+}
+
+static void emitRestoreRegisters(ARMEmitter& e) {
+    for (unsigned v = 14; v >= 8; v -= 2) {
+        e.ldpPost(QReg(v), QReg(v + 1), XReg(REG_SP), 32);
+    }
+    for (unsigned r = 27; r >= 19; r -= 2) {
+        e.ldpPost(XReg(r), XReg(r + 1), XReg(REG_SP), 16);
+    }
+    e.ldpPost(XReg(REG_FP), XReg(REG_LR), XReg(REG_SP), 16);
+}
+
+/**
+ * Count the call and, if requested, push the counter-timer value at function entry
+ */
+static void emitProfileEnter(ARMEmitter& e, FunctionProfile* profile) {
+    e.movImm(XReg(REG_TEMP0), reinterpret_cast<U64>(&profile->count));
+    e.ldr(XReg(REG_TEMP1), XReg(REG_TEMP0));
+    e.add(XReg(REG_TEMP1), XReg(REG_TEMP1), 1);
+    e.str(XReg(REG_TEMP1), XReg(REG_TEMP0));
+    if (config.profileCycles) {
+        e.mrs(XReg(REG_TEMP1), SYSREG_CNTVCT_EL0);
+        e.stpPre(XReg(REG_TEMP1), XReg(REG_ZR), XReg(REG_SP), -16);
+    }
+}
+
+/**
+ * Accumulate the ticks elapsed since function entry.
+ * Only uses scratch registers, leaving the return value and callee-saved registers intact.
+ */
+static void emitProfileLeave(ARMEmitter& e, FunctionProfile* profile) {
+    if (config.profileCycles) {
+        e.ldpPost(XReg(REG_TEMP0), XReg(REG_ZR), XReg(REG_SP), 16);
+        e.mrs(XReg(REG_TEMP1), SYSREG_CNTVCT_EL0);
+        e.sub(XReg(REG_TEMP1), XReg(REG_TEMP1), XReg(REG_TEMP0));
+        e.movImm(XReg(REG_TEMP0), reinterpret_cast<U64>(&profile->cycles));
+        e.ldr(XReg(REG_TEMP2), XReg(REG_TEMP0));
+        e.add(XReg(REG_TEMP2), XReg(REG_TEMP2), XReg(REG_TEMP1));
+        e.str(XReg(REG_TEMP2), XReg(REG_TEMP0));
+    }
+}
+
+bool ARMCompiler::compile(Function* function) {
+    // Set flags
+    function->flags |= FUNCTION_IS_COMPILING;
+
+    // Run compiler passes
+    optimize(function);
+
+    // Initialize emitter
+    ARMEmitter e(this);
+
+    // Profiling counters
+    FunctionProfile* profile = nullptr;
+    if (config.profile) {
+        profile = profiler.getProfile(function);
+    }
+
+    // Prolog block
+    e.L(e.labelProlog);
+    emitSaveRegisters(e);
+    if (profile) {
+        emitProfileEnter(e, profile);
+    }
+    if (!(function->blocks[0]->flags & BLOCK_IS_ENTRY)) {
+        e.b(e.labelEntry);
+    }
+
+    // Prepare labels
+    for (const auto& block : function->blocks) {
+        e.labels[block] = Label();
+    }
+
+    // Iterate over blocks
+    for (const auto& block : function->blocks) {
+        e.L(e.labels[block]);
+        if (block->flags & BLOCK_IS_ENTRY) {
+            e.L(e.labelEntry);
+        }
+        for (const auto& instr : block->instructions) {
+            if (!ARMSequences::select(e, instr)) {
+                logger.error(LOG_CPU, "Cannot compile block");
+                return false;
+            }
+        }
+    }
+
+    // Epilog block
+    e.L(e.labelEpilog);
+    if (profile) {
+        emitProfileLeave(e, profile);
+    }
+    emitRestoreRegisters(e);
+    e.ret();
+
+    // Copy emitted code
+    const auto codeSize = e.getSize();
+    void* nativeAddress = allocRWXMemory(codeSize);
+    if (!nativeAddress) {
+        return false;
+    }
+    memcpy(nativeAddress, e.getCode(), codeSize);
+    flushInstructionCache(nativeAddress, codeSize);
+    function->nativeSize = codeSize;
+    function->nativeAddress.store(nativeAddress, std::memory_order_release);
+    perfMap.registerCode(nativeAddress, codeSize, function->name);
+
+    function->flags |= FUNCTION_IS_COMPILED;
+    return true;
+}
+
+bool ARMCompiler::compile(Module* module) {
+    for (auto function : module->functions) {
+        if (!compile(function)) {
+            logger.error(LOG_CPU, "Cannot compile function");
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ARMCompiler::call(hir::Function* function, void* state, const std::vector<hir::Value*>& args) {
+    if (!(function->flags & FUNCTION_IS_COMPILED)) {
+        logger.error(LOG_CPU, "Function is not ready");
+        return false;
+    }
+
+    // Generate code for caller
+    ARMEmitter e(this, 4096);
+    e.stpPre(XReg(REG_FP), XReg(REG_LR), XReg(REG_SP), -16);
+    e.stpPre(XReg(REG_STATE), XReg(REG_ZR), XReg(REG_SP), -16);
+    e.movImm(XReg(REG_STATE), reinterpret_cast<U64>(state));
+    e.movImm(XReg(REG_TEMP0), reinterpret_cast<U64>(function->nativeAddress.load(std::memory_order_acquire)));
+    e.blr(XReg(REG_TEMP0));
+    e.ldpPost(XReg(REG_STATE), XReg(REG_ZR), XReg(REG_SP), 16);
+    e.ldpPost(XReg(REG_FP), XReg(REG_LR), XReg(REG_SP), 16);
+    e.ret();
+
+    // Execute caller
+    const auto codeSize = e.getSize();
+    void* callerAddr = allocRWXMemory(codeSize);
+    if (!callerAddr) {
+        return false;
+    }
+    memcpy(callerAddr, e.getCode(), codeSize);
+    flushInstructionCache(callerAddr, codeSize);
+    auto callerFunc = reinterpret_cast<void(*)()>(callerAddr);
+    callerFunc();
+    freeRWXMemory(callerAddr);
+    return true;
+}
+
+}  // namespace arm
+}  // namespace backend
+}  // namespace cpu
@@ -0,0 +1,35 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+#include "nucleus/cpu/backend/compiler.h"
+
+#include <memory>
+
+namespace cpu {
+namespace backend {
+namespace arm {
+
+class ARMCompiler : public Compiler {
+private:
+    // Initialize compiler
+    void init();
+
+public:
+    // Constructor
+    ARMCompiler();
+    ARMCompiler(const Settings& settings);
+
+    virtual bool compile(hir::Function* function) override;
+    virtual bool compile(hir::Module* module) override;
+
+    virtual bool call(hir::Function* function, void* state, const std::vector<hir::Value*>& args = {}) override;
+};
+
+}  // namespace arm
+}  // namespace backend
+}  // namespace cpu
@@ -0,0 +1,69 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "arm_emitter.h"
+#include "nucleus/cpu/backend/arm/arm_compiler.h"
+
+namespace cpu {
+namespace backend {
+namespace arm {
+
+ARMEmitter::ARMEmitter(const ARMCompiler* compiler, Size size) :
+    ARMAssembler(size),
+    compiler(compiler),
+    buffer(size) {
+    codeAddr = buffer.data();
+    curAddr = buffer.data();
+}
+
+void ARMEmitter::movImm(const Reg& rd, U64 imm) {
+    if (!rd.is64Bit()) {
+        imm &= 0xFFFFFFFFULL;
+    }
+
+    // Prefer MOVN if most halfwords are 0xFFFF
+    unsigned zeroes = 0;
+    unsigned ones = 0;
+    for (unsigned shift = 0; shift < rd.size; shift += 16) {
+        const U32 half = (imm >> shift) & 0xFFFF;
+        zeroes += (half == 0x0000);
+        ones += (half == 0xFFFF);
+    }
+    const bool inverted = (ones > zeroes);
+    const U32 skipped = inverted ? 0xFFFF : 0x0000;
+
+    bool first = true;
+    for (unsigned shift = 0; shift < rd.size; shift += 16) {
+        const U32 half = (imm >> shift) & 0xFFFF;
+        if (half == skipped) {
+            continue;
+        }
+        if (first) {
+            if (inverted) {
+                movn(rd, ~half & 0xFFFF, shift);
+            } else {
+                movz(rd, half, shift);
+            }
+            first = false;
+        } else {
+            movk(rd, half, shift);
+        }
+    }
+    if (first) {
+        if (inverted) {
+            movn(rd, 0);
+        } else {
+            movz(rd, 0);
+        }
+    }
+}
+
+const Settings& ARMEmitter::settings() const {
+    return compiler->settings;
+}
+
+}  // namespace arm
+}  // namespace backend
+}  // namespace cpu
@@ -0,0 +1,72 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+#include "nucleus/cpu/hir/block.h"
+#include "nucleus/cpu/backend/settings.h"
+#include "nucleus/cpu/backend/arm/arm_assembler.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace cpu {
+namespace backend {
+namespace arm {
+
+// Forward declarations
+class ARMCompiler;
+
+// Register roles
+enum : unsigned {
+    REG_STATE = 19,  // Pointer to the guest thread state (callee-saved)
+    REG_TEMP0 = 16,  // Scratch register (IP0)
+    REG_TEMP1 = 17,  // Scratch register (IP1)
+    REG_TEMP2 = 9,   // Scratch register (caller-saved, never allocated to HIR values)
+    VREG_TEMP0 = 31, // Scratch vector register
+    VREG_TEMP1 = 30, // Scratch vector register
+};
+
+class ARMEmitter : public ARMAssembler {
+private:
+    const ARMCompiler* compiler;
+
+    // Code buffer
+    std::vector<U08> buffer;
+
+public:
+    // Labels
+    std::unordered_map<const hir::Block*, Label> labels;
+    Label labelEntry;
+    Label labelProlog;
+    Label labelEpilog;
+
+    // Constructor
+    ARMEmitter(const ARMCompiler* compiler, Size size = 1 * 1024 * 1024);
+
+    /**
+     * Materialize an arbitrary immediate with the shortest MOVZ/MOVN/MOVK sequence
+     * @param[in]  rd   Destination register (W or X)
+     * @param[in]  imm  Immediate value (truncated to the register size)
+     */
+    void movImm(const Reg& rd, U64 imm);
+
+    /**
+     * Get a pointer to the emitted code and its size
+     */
+    const void* getCode() const { return codeAddr; }
+    Size getSize() const { return curSize; }
+
+    /**
+     * Return global generic compiler settings
+     * @return Compiler settings member
+     */
+    const Settings& settings() const;
+};
+
+}  // namespace arm
+}  // namespace backend
+}  // namespace cpu
@@ -0,0 +1,1146 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "arm_sequences.h"
+#include "nucleus/assert.h"
+#include "nucleus/cpu/hir/function.h"
+#include "nucleus/cpu/backend/arm/arm_compiler.h"
+#include "nucleus/cpu/backend/arm/arm_emitter.h"
+#include "nucleus/logger/logger.h"
+
+#include <cstddef>
+#include <unordered_map>
+
+// Helper
+#define COMPONENT_TYPE \
+    (i.instr->flags & (_COMPONENT_MASK << _COMPONENT_SHIFT))
+
+namespace cpu {
+namespace backend {
+namespace arm {
+
+using namespace cpu::hir;
+
+// Integer values narrower than 32 bits live in W registers with undefined upper bits
+using I8Op = I8OpBase<WReg>;
+using I16Op = I16OpBase<WReg>;
+using I32Op = I32OpBase<WReg>;
+using I64Op = I64OpBase<XReg>;
+using F32Op = F32OpBase<SReg>;
+using F64Op = F64OpBase<DReg>;
+using V128Op = V128OpBase<QReg>;
+using PtrOp = PtrOpBase<XReg>;
+
+/**
+ * Operand helpers
+ */
+// Get the register holding an integer operand, materializing constants into a scratch register
+template <typename OpType>
+static auto getReg(ARMEmitter& e, const OpType& op, unsigned temp) -> decltype(op.reg) {
+    using RegType = decltype(op.reg);
+    if (op.isConstant) {
+        RegType reg(temp);
+        e.movImm(reg, static_cast<U64>(op.constant()));
+        return reg;
+    }
+    return op.reg;
+}
+
+// Get the register holding a pointer operand
+static XReg getReg(ARMEmitter& e, const PtrOp& op, unsigned temp) {
+    if (op.isConstant) {
+        e.movImm(XReg(temp), reinterpret_cast<U64>(op.constant()));
+        return XReg(temp);
+    }
+    return op.reg;
+}
+
+// Get the register holding a floating-point or vector operand
+static SReg getReg(ARMEmitter& e, const F32Op& op, unsigned temp) {
+    if (op.isConstant) {
+        e.movImm(WReg(REG_TEMP0), static_cast<U32>(op.value->constant.i32));
+        e.fmov(SReg(temp), WReg(REG_TEMP0));
+        return SReg(temp);
+    }
+    return op.reg;
+}
+static DReg getReg(ARMEmitter& e, const F64Op& op, unsigned temp) {
+    if (op.isConstant) {
+        e.movImm(XReg(REG_TEMP0), static_cast<U64>(op.value->constant.i64));
+        e.fmov(DReg(temp), XReg(REG_TEMP0));
+        return DReg(temp);
+    }
+    return op.reg;
+}
+static QReg getReg(ARMEmitter& e, const V128Op& op, unsigned temp) {
+    if (op.isConstant) {
+        const V128 constant = op.constant();
+        e.movImm(XReg(REG_TEMP0), constant.u64[0]);
+        e.movImm(XReg(REG_TEMP1), constant.u64[1]);
+        e.fmov(DReg(temp), XReg(REG_TEMP0));
+        e.ins(QReg(temp), ARR_2D, 1, XReg(REG_TEMP1));
+        return QReg(temp);
+    }
+    return op.reg;
+}
+
+// Get an integer operand extended to at least 32 bits
+template <typename OpType>
+static auto getExtendedReg(ARMEmitter& e, const OpType& op, unsigned temp, bool isSigned) -> decltype(op.reg) {
+    using RegType = decltype(op.reg);
+    const auto bits = sizeof(op.constant()) * 8;
+    if (op.isConstant) {
+        U64 value = static_cast<U64>(op.constant());
+        if (!isSigned) {
+            // Shifting by bits-1 keeps the count in range for 64-bit operands, where the mask is all ones
+            value &= (2ULL << (bits - 1)) - 1;
+        }
+        RegType reg(temp);
+        e.movImm(reg, value);
+        return reg;
+    }
+    if (bits >= 32) {
+        return op.reg;
+    }
+    RegType reg(temp);
+    if (bits == 8) {
+        if (isSigned) {
+            e.sxtb(reg, op.reg);
+        } else {
+            e.uxtb(reg, op.reg);
+        }
+    } else {
+        if (isSigned) {
+            e.sxth(reg, op.reg);
+        } else {
+            e.uxth(reg, op.reg);
+        }
+    }
+    return reg;
+}
+
+// Compute base register and displacement of a guest context access
+static XReg getContextBase(ARMEmitter& e, U64 offset, unsigned accessSize, U32& displacement) {
+    if ((offset % accessSize) == 0 && (offset / accessSize) < 4096) {
+        displacement = static_cast<U32>(offset);
+        return XReg(REG_STATE);
+    }
+    e.movImm(XReg(REG_TEMP0), offset);
+    e.add(XReg(REG_TEMP0), XReg(REG_STATE), XReg(REG_TEMP0));
+    displacement = 0;
+    return XReg(REG_TEMP0);
+}
+
+// Byteswap a 128-bit vector
+static void emitByteSwap(ARMEmitter& e, const VReg& dest, const VReg& src) {
+    e.rev64(dest, src, ARR_16B);
+    e.ext(dest, dest, dest, 8);
+}
+
+// Sequences
+template <typename S, typename I>
+struct Sequence : SequenceBase<S, I> {
+    using InstrType = I;
+
+public:
+    static void select(ARMEmitter& emitter, const hir::Instruction* instr) {
+        InstrType i(instr);
+        S::emit(emitter, i);
+    }
+
+    template <typename FuncType>
+    static void emitUnaryOp(ARMEmitter& e, InstrType& i, FuncType func) {
+        auto src = getReg(e, i.src1, REG_TEMP0);
+        func(e, i.dest.reg, src);
+    }
+
+    template <typename FuncType>
+    static void emitBinaryOp(ARMEmitter& e, InstrType& i, FuncType func) {
+        auto src1 = getReg(e, i.src1, REG_TEMP0);
+        auto src2 = getReg(e, i.src2, REG_TEMP1);
+        func(e, i.dest.reg, src1, src2);
+    }
+
+    template <typename FuncType>
+    static void emitBinaryVecOp(ARMEmitter& e, InstrType& i, FuncType func) {
+        auto src1 = getReg(e, i.src1, VREG_TEMP0);
+        auto src2 = getReg(e, i.src2, VREG_TEMP1);
+        func(e, i.dest.reg, src1, src2);
+    }
+
+    template <typename FuncType>
+    static void emitExtendedBinaryOp(ARMEmitter& e, InstrType& i, bool isSigned, FuncType func) {
+        auto src1 = getExtendedReg(e, i.src1, REG_TEMP0, isSigned);
+        auto src2 = getExtendedReg(e, i.src2, REG_TEMP1, isSigned);
+        func(e, i.dest.reg, src1, src2);
+    }
+};
+
+/**
+ * Opcode: ADD
+ */
+#define EMIT_INTEGER_BINARY_OP(name, opcode, OpType, body) \
+    struct name : Sequence<name, I<opcode, OpType, OpType, OpType>> { \
+        static void emit(ARMEmitter& e, InstrType& i) { \
+            emitBinaryOp(e, i, [](ARMEmitter& e, auto dest, auto src1, auto src2) { \
+                body; \
+            }); \
+        } \
+    };
+
+EMIT_INTEGER_BINARY_OP(ADD_I8,  OPCODE_ADD, I8Op,  e.add(dest, src1, src2));
+EMIT_INTEGER_BINARY_OP(ADD_I16, OPCODE_ADD, I16Op, e.add(dest, src1, src2));
+EMIT_INTEGER_BINARY_OP(ADD_I32, OPCODE_ADD, I32Op, e.add(dest, src1, src2));
+EMIT_INTEGER_BINARY_OP(ADD_I64, OPCODE_ADD, I64Op, e.add(dest, src1, src2));
+
+/**
+ * Opcode: SUB
+ */
+EMIT_INTEGER_BINARY_OP(SUB_I8,  OPCODE_SUB, I8Op,  e.sub(dest, src1, src2));
+EMIT_INTEGER_BINARY_OP(SUB_I16, OPCODE_SUB, I16Op, e.sub(dest, src1, src2));
+EMIT_INTEGER_BINARY_OP(SUB_I32, OPCODE_SUB, I32Op, e.sub(dest, src1, src2));
+EMIT_INTEGER_BINARY_OP(SUB_I64, OPCODE_SUB, I64Op, e.sub(dest, src1, src2));
+
+/**
+ * Opcode: MUL
+ * Lower bits of the product are identical for signed and unsigned operands.
+ */
+EMIT_INTEGER_BINARY_OP(MUL_I8,  OPCODE_MUL, I8Op,  e.mul(dest, src1, src2));
+EMIT_INTEGER_BINARY_OP(MUL_I16, OPCODE_MUL, I16Op, e.mul(dest, src1, src2));
+EMIT_INTEGER_BINARY_OP(MUL_I32, OPCODE_MUL, I32Op, e.mul(dest, src1, src2));
+EMIT_INTEGER_BINARY_OP(MUL_I64, OPCODE_MUL, I64Op, e.mul(dest, src1, src2));
+
+/**
+ * Opcode: AND, OR, XOR
+ */
+EMIT_INTEGER_BINARY_OP(AND_I8,  OPCODE_AND, I8Op,  e.and_(dest, src1, src2));
+EMIT_INTEGER_BINARY_OP(AND_I16, OPCODE_AND, I16Op, e.and_(dest, src1, src2));
+EMIT_INTEGER_BINARY_OP(AND_I32, OPCODE_AND, I32Op, e.and_(dest, src1, src2));
+EMIT_INTEGER_BINARY_OP(AND_I64, OPCODE_AND, I64Op, e.and_(dest, src1, src2));
+EMIT_INTEGER_BINARY_OP(OR_I8,   OPCODE_OR,  I8Op,  e.orr(dest, src1, src2));
+EMIT_INTEGER_BINARY_OP(OR_I16,  OPCODE_OR,  I16Op, e.orr(dest, src1, src2));
+EMIT_INTEGER_BINARY_OP(OR_I32,  OPCODE_OR,  I32Op, e.orr(dest, src1, src2));
+EMIT_INTEGER_BINARY_OP(OR_I64,  OPCODE_OR,  I64Op, e.orr(dest, src1, src2));
+EMIT_INTEGER_BINARY_OP(XOR_I8,  OPCODE_XOR, I8Op,  e.eor(dest, src1, src2));
+EMIT_INTEGER_BINARY_OP(XOR_I16, OPCODE_XOR, I16Op, e.eor(dest, src1, src2));
+EMIT_INTEGER_BINARY_OP(XOR_I32, OPCODE_XOR, I32Op, e.eor(dest, src1, src2));
+EMIT_INTEGER_BINARY_OP(XOR_I64, OPCODE_XOR, I64Op, e.eor(dest, src1, src2));
+
+#undef EMIT_INTEGER_BINARY_OP
+
+/**
+ * Opcode: MULH
+ */
+#define EMIT_MULH_NARROW(bits) \
+    const bool isSigned = !(i.instr->flags & ARITHMETIC_UNSIGNED); \
+    emitExtendedBinaryOp(e, i, isSigned, [isSigned](ARMEmitter& e, auto dest, auto src1, auto src2) { \
+        e.mul(WReg(REG_TEMP0), src1, src2); \
+        if (isSigned) { \
+            e.asr(dest, WReg(REG_TEMP0), bits); \
+        } else { \
+            e.lsr(dest, WReg(REG_TEMP0), bits); \
+        } \
+    });
+
+struct MULH_I8 : Sequence<MULH_I8, I<OPCODE_MULH, I8Op, I8Op, I8Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        EMIT_MULH_NARROW(8);
+    }
+};
+struct MULH_I16 : Sequence<MULH_I16, I<OPCODE_MULH, I16Op, I16Op, I16Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        EMIT_MULH_NARROW(16);
+    }
+};
+struct MULH_I32 : Sequence<MULH_I32, I<OPCODE_MULH, I32Op, I32Op, I32Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        const bool isSigned = !(i.instr->flags & ARITHMETIC_UNSIGNED);
+        emitBinaryOp(e, i, [isSigned](ARMEmitter& e, auto dest, auto src1, auto src2) {
+            if (isSigned) {
+                e.smull(XReg(REG_TEMP0), src1, src2);
+            } else {
+                e.umull(XReg(REG_TEMP0), src1, src2);
+            }
+            e.lsr(XReg(REG_TEMP0), XReg(REG_TEMP0), 32);
+            e.mov(dest, WReg(REG_TEMP0));
+        });
+    }
+};
+struct MULH_I64 : Sequence<MULH_I64, I<OPCODE_MULH, I64Op, I64Op, I64Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        const bool isSigned = !(i.instr->flags & ARITHMETIC_UNSIGNED);
+        emitBinaryOp(e, i, [isSigned](ARMEmitter& e, auto dest, auto src1, auto src2) {
+            if (isSigned) {
+                e.smulh(dest, src1, src2);
+            } else {
+                e.umulh(dest, src1, src2);
+            }
+        });
+    }
+};
+
+#undef EMIT_MULH_NARROW
+
+/**
+ * Opcode: DIV
+ * Division by zero yields zero instead of trapping.
+ */
+#define EMIT_DIV() \
+    const bool isSigned = !(i.instr->flags & ARITHMETIC_UNSIGNED); \
+    emitExtendedBinaryOp(e, i, isSigned, [isSigned](ARMEmitter& e, auto dest, auto src1, auto src2) { \
+        if (isSigned) { \
+            e.sdiv(dest, src1, src2); \
+        } else { \
+            e.udiv(dest, src1, src2); \
+        } \
+    });
+
+struct DIV_I8 : Sequence<DIV_I8, I<OPCODE_DIV, I8Op, I8Op, I8Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        EMIT_DIV();
+    }
+};
+struct DIV_I16 : Sequence<DIV_I16, I<OPCODE_DIV, I16Op, I16Op, I16Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        EMIT_DIV();
+    }
+};
+struct DIV_I32 : Sequence<DIV_I32, I<OPCODE_DIV, I32Op, I32Op, I32Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        EMIT_DIV();
+    }
+};
+struct DIV_I64 : Sequence<DIV_I64, I<OPCODE_DIV, I64Op, I64Op, I64Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        EMIT_DIV();
+    }
+};
+
+#undef EMIT_DIV
+
+/**
+ * Opcode: SQRT, ABS
+ */
+struct SQRT_F32 : Sequence<SQRT_F32, I<OPCODE_SQRT, F32Op, F32Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        e.fsqrt(i.dest.reg, getReg(e, i.src1, VREG_TEMP0));
+    }
+};
+struct SQRT_F64 : Sequence<SQRT_F64, I<OPCODE_SQRT, F64Op, F64Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        e.fsqrt(i.dest.reg, getReg(e, i.src1, VREG_TEMP0));
+    }
+};
+struct ABS_F32 : Sequence<ABS_F32, I<OPCODE_ABS, F32Op, F32Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        e.fabs(i.dest.reg, getReg(e, i.src1, VREG_TEMP0));
+    }
+};
+struct ABS_F64 : Sequence<ABS_F64, I<OPCODE_ABS, F64Op, F64Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        e.fabs(i.dest.reg, getReg(e, i.src1, VREG_TEMP0));
+    }
+};
+
+/**
+ * Opcode: NEG, NOT
+ */
+#define EMIT_INTEGER_UNARY_OP(name, opcode, OpType, body) \
+    struct name : Sequence<name, I<opcode, OpType, OpType>> { \
+        static void emit(ARMEmitter& e, InstrType& i) { \
+            emitUnaryOp(e, i, [](ARMEmitter& e, auto dest, auto src) { \
+                body; \
+            }); \
+        } \
+    };
+
+EMIT_INTEGER_UNARY_OP(NEG_I8,  OPCODE_NEG, I8Op,  e.neg(dest, src));
+EMIT_INTEGER_UNARY_OP(NEG_I16, OPCODE_NEG, I16Op, e.neg(dest, src));
+EMIT_INTEGER_UNARY_OP(NEG_I32, OPCODE_NEG, I32Op, e.neg(dest, src));
+EMIT_INTEGER_UNARY_OP(NEG_I64, OPCODE_NEG, I64Op, e.neg(dest, src));
+EMIT_INTEGER_UNARY_OP(NOT_I8,  OPCODE_NOT, I8Op,  e.mvn(dest, src));
+EMIT_INTEGER_UNARY_OP(NOT_I16, OPCODE_NOT, I16Op, e.mvn(dest, src));
+EMIT_INTEGER_UNARY_OP(NOT_I32, OPCODE_NOT, I32Op, e.mvn(dest, src));
+EMIT_INTEGER_UNARY_OP(NOT_I64, OPCODE_NOT, I64Op, e.mvn(dest, src));
+
+#undef EMIT_INTEGER_UNARY_OP
+
+struct NOT_V128 : Sequence<NOT_V128, I<OPCODE_NOT, V128Op, V128Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        e.not_(i.dest.reg, getReg(e, i.src1, VREG_TEMP0));
+    }
+};
+struct AND_V128 : Sequence<AND_V128, I<OPCODE_AND, V128Op, V128Op, V128Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        emitBinaryVecOp(e, i, [](ARMEmitter& e, auto dest, auto src1, auto src2) {
+            e.and_(dest, src1, src2);
+        });
+    }
+};
+struct OR_V128 : Sequence<OR_V128, I<OPCODE_OR, V128Op, V128Op, V128Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        emitBinaryVecOp(e, i, [](ARMEmitter& e, auto dest, auto src1, auto src2) {
+            e.orr(dest, src1, src2);
+        });
+    }
+};
+struct XOR_V128 : Sequence<XOR_V128, I<OPCODE_XOR, V128Op, V128Op, V128Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        emitBinaryVecOp(e, i, [](ARMEmitter& e, auto dest, auto src1, auto src2) {
+            e.eor(dest, src1, src2);
+        });
+    }
+};
+
+/**
+ * Opcode: SHL, SHR, SHRA
+ * Shift amounts are I8 values, extended before being used as register operands.
+ */
+#define EMIT_SHIFT(name, opcode, OpType, bits, isSigned, shiftImm, shiftReg) \
+    struct name : Sequence<name, I<opcode, OpType, OpType, I8Op>> { \
+        static void emit(ARMEmitter& e, InstrType& i) { \
+            auto src = getExtendedReg(e, i.src1, REG_TEMP0, isSigned); \
+            if (i.src2.isConstant) { \
+                const unsigned amount = static_cast<U08>(i.src2.constant()); \
+                assert_true(amount < bits, "Shift amount out of range"); \
+                e.shiftImm(i.dest.reg, src, amount); \
+            } else { \
+                e.uxtb(WReg(REG_TEMP1), i.src2.reg); \
+                e.shiftReg(i.dest.reg, src, decltype(i.dest.reg)(REG_TEMP1)); \
+            } \
+        } \
+    };
+
+EMIT_SHIFT(SHL_I8,   OPCODE_SHL,  I8Op,  8,  false, lsl, lslv);
+EMIT_SHIFT(SHL_I16,  OPCODE_SHL,  I16Op, 16, false, lsl, lslv);
+EMIT_SHIFT(SHL_I32,  OPCODE_SHL,  I32Op, 32, false, lsl, lslv);
+EMIT_SHIFT(SHL_I64,  OPCODE_SHL,  I64Op, 64, false, lsl, lslv);
+EMIT_SHIFT(SHR_I8,   OPCODE_SHR,  I8Op,  8,  false, lsr, lsrv);
+EMIT_SHIFT(SHR_I16,  OPCODE_SHR,  I16Op, 16, false, lsr, lsrv);
+EMIT_SHIFT(SHR_I32,  OPCODE_SHR,  I32Op, 32, false, lsr, lsrv);
+EMIT_SHIFT(SHR_I64,  OPCODE_SHR,  I64Op, 64, false, lsr, lsrv);
+EMIT_SHIFT(SHRA_I8,  OPCODE_SHRA, I8Op,  8,  true,  asr, asrv);
+EMIT_SHIFT(SHRA_I16, OPCODE_SHRA, I16Op, 16, true,  asr, asrv);
+EMIT_SHIFT(SHRA_I32, OPCODE_SHRA, I32Op, 32, true,  asr, asrv);
+EMIT_SHIFT(SHRA_I64, OPCODE_SHRA, I64Op, 64, true,  asr, asrv);
+
+#undef EMIT_SHIFT
+
+/**
+ * Opcode: ZEXT, SEXT, TRUNC
+ */
+#define EMIT_CONVERSION(name, opcode, DestType, SrcType, body) \
+    struct name : Sequence<name, I<opcode, DestType, SrcType>> { \
+        static void emit(ARMEmitter& e, InstrType& i) { \
+            auto dest = i.dest.reg; \
+            auto src = getReg(e, i.src1, REG_TEMP0); \
+            body; \
+        } \
+    };
+
+EMIT_CONVERSION(ZEXT_I16_I8,  OPCODE_ZEXT, I16Op, I8Op,  e.uxtb(dest, src));
+EMIT_CONVERSION(ZEXT_I32_I8,  OPCODE_ZEXT, I32Op, I8Op,  e.uxtb(dest, src));
+EMIT_CONVERSION(ZEXT_I64_I8,  OPCODE_ZEXT, I64Op, I8Op,  e.uxtb(dest, src));
+EMIT_CONVERSION(ZEXT_I32_I16, OPCODE_ZEXT, I32Op, I16Op, e.uxth(dest, src));
+EMIT_CONVERSION(ZEXT_I64_I16, OPCODE_ZEXT, I64Op, I16Op, e.uxth(dest, src));
+EMIT_CONVERSION(ZEXT_I64_I32, OPCODE_ZEXT, I64Op, I32Op, e.mov(dest.getWReg(), src));
+EMIT_CONVERSION(SEXT_I16_I8,  OPCODE_SEXT, I16Op, I8Op,  e.sxtb(dest, src));
+EMIT_CONVERSION(SEXT_I32_I8,  OPCODE_SEXT, I32Op, I8Op,  e.sxtb(dest, src));
+EMIT_CONVERSION(SEXT_I64_I8,  OPCODE_SEXT, I64Op, I8Op,  e.sxtb(dest, src));
+EMIT_CONVERSION(SEXT_I32_I16, OPCODE_SEXT, I32Op, I16Op, e.sxth(dest, src));
+EMIT_CONVERSION(SEXT_I64_I16, OPCODE_SEXT, I64Op, I16Op, e.sxth(dest, src));
+EMIT_CONVERSION(SEXT_I64_I32, OPCODE_SEXT, I64Op, I32Op, e.sxtw(dest, src));
+EMIT_CONVERSION(TRUNC_I8_I16,  OPCODE_TRUNC, I8Op,  I16Op, if (dest != src) e.mov(dest, src));
+EMIT_CONVERSION(TRUNC_I8_I32,  OPCODE_TRUNC, I8Op,  I32Op, if (dest != src) e.mov(dest, src));
+EMIT_CONVERSION(TRUNC_I8_I64,  OPCODE_TRUNC, I8Op,  I64Op, e.mov(dest, src.getWReg()));
+EMIT_CONVERSION(TRUNC_I16_I32, OPCODE_TRUNC, I16Op, I32Op, if (dest != src) e.mov(dest, src));
+EMIT_CONVERSION(TRUNC_I16_I64, OPCODE_TRUNC, I16Op, I64Op, e.mov(dest, src.getWReg()));
+EMIT_CONVERSION(TRUNC_I32_I64, OPCODE_TRUNC, I32Op, I64Op, e.mov(dest, src.getWReg()));
+
+/**
+ * Opcode: CAST
+ */
+EMIT_CONVERSION(CAST_I32_F32, OPCODE_CAST, I32Op, F32Op, e.fmov(dest, src));
+EMIT_CONVERSION(CAST_F32_I32, OPCODE_CAST, F32Op, I32Op, e.fmov(dest, src));
+EMIT_CONVERSION(CAST_I64_F64, OPCODE_CAST, I64Op, F64Op, e.fmov(dest, src));
+EMIT_CONVERSION(CAST_F64_I64, OPCODE_CAST, F64Op, I64Op, e.fmov(dest, src));
+
+/**
+ * Opcode: CONVERT
+ */
+EMIT_CONVERSION(CONVERT_I32_F32, OPCODE_CONVERT, I32Op, F32Op, e.fcvtzs(dest, src));
+EMIT_CONVERSION(CONVERT_I32_F64, OPCODE_CONVERT, I32Op, F64Op, e.fcvtzs(dest, src));
+EMIT_CONVERSION(CONVERT_I64_F64, OPCODE_CONVERT, I64Op, F64Op, e.fcvtzs(dest, src));
+EMIT_CONVERSION(CONVERT_F32_F64, OPCODE_CONVERT, F32Op, F64Op, e.fcvt(dest, src));
+EMIT_CONVERSION(CONVERT_F64_I64, OPCODE_CONVERT, F64Op, I64Op, e.scvtf(dest, src));
+EMIT_CONVERSION(CONVERT_F64_F32, OPCODE_CONVERT, F64Op, F32Op, e.fcvt(dest, src));
+
+#undef EMIT_CONVERSION
+
+/**
+ * Opcode: CTLZ
+ */
+struct CTLZ_I8 : Sequence<CTLZ_I8, I<OPCODE_CTLZ, I8Op, I8Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        auto src = getExtendedReg(e, i.src1, REG_TEMP0, false);
+        e.clz(i.dest.reg, src);
+        e.sub(i.dest.reg, i.dest.reg, 24);
+    }
+};
+struct CTLZ_I16 : Sequence<CTLZ_I16, I<OPCODE_CTLZ, I8Op, I16Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        auto src = getExtendedReg(e, i.src1, REG_TEMP0, false);
+        e.clz(i.dest.reg, src);
+        e.sub(i.dest.reg, i.dest.reg, 16);
+    }
+};
+struct CTLZ_I32 : Sequence<CTLZ_I32, I<OPCODE_CTLZ, I8Op, I32Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        e.clz(i.dest.reg, getReg(e, i.src1, REG_TEMP0));
+    }
+};
+struct CTLZ_I64 : Sequence<CTLZ_I64, I<OPCODE_CTLZ, I8Op, I64Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        e.clz(i.dest.reg.getXReg(), getReg(e, i.src1, REG_TEMP0));
+    }
+};
+
+/**
+ * Opcode: LOAD
+ */
+struct LOAD_I8 : Sequence<LOAD_I8, I<OPCODE_LOAD, I8Op, PtrOp>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        e.ldrb(i.dest.reg, getReg(e, i.src1, REG_TEMP0));
+    }
+};
+struct LOAD_I16 : Sequence<LOAD_I16, I<OPCODE_LOAD, I16Op, PtrOp>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        e.ldrh(i.dest.reg, getReg(e, i.src1, REG_TEMP0));
+        if (i.instr->flags & ENDIAN_BIG) {
+            e.rev16(i.dest.reg, i.dest.reg);
+        }
+    }
+};
+struct LOAD_I32 : Sequence<LOAD_I32, I<OPCODE_LOAD, I32Op, PtrOp>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        e.ldr(i.dest.reg, getReg(e, i.src1, REG_TEMP0));
+        if (i.instr->flags & ENDIAN_BIG) {
+            e.rev(i.dest.reg, i.dest.reg);
+        }
+    }
+};
+struct LOAD_I64 : Sequence<LOAD_I64, I<OPCODE_LOAD, I64Op, PtrOp>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        e.ldr(i.dest.reg, getReg(e, i.src1, REG_TEMP0));
+        if (i.instr->flags & ENDIAN_BIG) {
+            e.rev(i.dest.reg, i.dest.reg);
+        }
+    }
+};
+struct LOAD_F32 : Sequence<LOAD_F32, I<OPCODE_LOAD, F32Op, PtrOp>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        auto addr = getReg(e, i.src1, REG_TEMP0);
+        if (i.instr->flags & ENDIAN_BIG) {
+            e.ldr(WReg(REG_TEMP1), addr);
+            e.rev(WReg(REG_TEMP1), WReg(REG_TEMP1));
+            e.fmov(i.dest.reg, WReg(REG_TEMP1));
+        } else {
+            e.ldr(i.dest.reg, addr);
+        }
+    }
+};
+struct LOAD_F64 : Sequence<LOAD_F64, I<OPCODE_LOAD, F64Op, PtrOp>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        auto addr = getReg(e, i.src1, REG_TEMP0);
+        if (i.instr->flags & ENDIAN_BIG) {
+            e.ldr(XReg(REG_TEMP1), addr);
+            e.rev(XReg(REG_TEMP1), XReg(REG_TEMP1));
+            e.fmov(i.dest.reg, XReg(REG_TEMP1));
+        } else {
+            e.ldr(i.dest.reg, addr);
+        }
+    }
+};
+struct LOAD_V128 : Sequence<LOAD_V128, I<OPCODE_LOAD, V128Op, PtrOp>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        e.ldr(i.dest.reg, getReg(e, i.src1, REG_TEMP0));
+        if (i.instr->flags & ENDIAN_BIG) {
+            emitByteSwap(e, i.dest.reg, i.dest.reg);
+        }
+    }
+};
+
+/**
+ * Opcode: STORE
+ */
+struct STORE_I8 : Sequence<STORE_I8, I<OPCODE_STORE, VoidOp, PtrOp, I8Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        auto addr = getReg(e, i.src1, REG_TEMP0);
+        e.strb(getReg(e, i.src2, REG_TEMP1), addr);
+    }
+};
+struct STORE_I16 : Sequence<STORE_I16, I<OPCODE_STORE, VoidOp, PtrOp, I16Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        auto addr = getReg(e, i.src1, REG_TEMP0);
+        auto value = getReg(e, i.src2, REG_TEMP1);
+        if (i.instr->flags & ENDIAN_BIG) {
+            e.rev16(WReg(REG_TEMP1), value);
+            value = WReg(REG_TEMP1);
+        }
+        e.strh(value, addr);
+    }
+};
+struct STORE_I32 : Sequence<STORE_I32, I<OPCODE_STORE, VoidOp, PtrOp, I32Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        auto addr = getReg(e, i.src1, REG_TEMP0);
+        auto value = getReg(e, i.src2, REG_TEMP1);
+        if (i.instr->flags & ENDIAN_BIG) {
+            e.rev(WReg(REG_TEMP1), value);
+            value = WReg(REG_TEMP1);
+        }
+        e.str(value, addr);
+    }
+};
+struct STORE_I64 : Sequence<STORE_I64, I<OPCODE_STORE, VoidOp, PtrOp, I64Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        auto addr = getReg(e, i.src1, REG_TEMP0);
+        auto value = getReg(e, i.src2, REG_TEMP1);
+        if (i.instr->flags & ENDIAN_BIG) {
+            e.rev(XReg(REG_TEMP1), value);
+            value = XReg(REG_TEMP1);
+        }
+        e.str(value, addr);
+    }
+};
+struct STORE_F32 : Sequence<STORE_F32, I<OPCODE_STORE, VoidOp, PtrOp, F32Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        auto value = getReg(e, i.src2, VREG_TEMP0);
+        auto addr = getReg(e, i.src1, REG_TEMP0);
+        if (i.instr->flags & ENDIAN_BIG) {
+            e.fmov(WReg(REG_TEMP1), value);
+            e.rev(WReg(REG_TEMP1), WReg(REG_TEMP1));
+            e.str(WReg(REG_TEMP1), addr);
+        } else {
+            e.str(value, addr);
+        }
+    }
+};
+struct STORE_F64 : Sequence<STORE_F64, I<OPCODE_STORE, VoidOp, PtrOp, F64Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        auto value = getReg(e, i.src2, VREG_TEMP0);
+        auto addr = getReg(e, i.src1, REG_TEMP0);
+        if (i.instr->flags & ENDIAN_BIG) {
+            e.fmov(XReg(REG_TEMP1), value);
+            e.rev(XReg(REG_TEMP1), XReg(REG_TEMP1));
+            e.str(XReg(REG_TEMP1), addr);
+        } else {
+            e.str(value, addr);
+        }
+    }
+};
+struct STORE_V128 : Sequence<STORE_V128, I<OPCODE_STORE, VoidOp, PtrOp, V128Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        auto value = getReg(e, i.src2, VREG_TEMP0);
+        auto addr = getReg(e, i.src1, REG_TEMP0);
+        if (i.instr->flags & ENDIAN_BIG) {
+            emitByteSwap(e, QReg(VREG_TEMP0), value);
+            value = QReg(VREG_TEMP0);
+        }
+        e.str(value, addr);
+    }
+};
+
+/**
+ * Opcode: CTXLOAD
+ */
+#define EMIT_CTXLOAD(name, OpType, size, load) \
+    struct name : Sequence<name, I<OPCODE_CTXLOAD, OpType, ImmediateOp>> { \
+        static void emit(ARMEmitter& e, InstrType& i) { \
+            U32 disp; \
+            auto base = getContextBase(e, i.src1.immediate, size, disp); \
+            e.load(i.dest.reg, base, disp); \
+        } \
+    };
+
+EMIT_CTXLOAD(CTXLOAD_I8,   I8Op,   1,  ldrb);
+EMIT_CTXLOAD(CTXLOAD_I16,  I16Op,  2,  ldrh);
+EMIT_CTXLOAD(CTXLOAD_I32,  I32Op,  4,  ldr);
+EMIT_CTXLOAD(CTXLOAD_I64,  I64Op,  8,  ldr);
+EMIT_CTXLOAD(CTXLOAD_F32,  F32Op,  4,  ldr);
+EMIT_CTXLOAD(CTXLOAD_F64,  F64Op,  8,  ldr);
+EMIT_CTXLOAD(CTXLOAD_V128, V128Op, 16, ldr);
+
+#undef EMIT_CTXLOAD
+
+/**
+ * Opcode: CTXSTORE
+ */
+#define EMIT_CTXSTORE(name, OpType, size, temp, store) \
+    struct name : Sequence<name, I<OPCODE_CTXSTORE, VoidOp, ImmediateOp, OpType>> { \
+        static void emit(ARMEmitter& e, InstrType& i) { \
+            U32 disp; \
+            auto value = getReg(e, i.src2, temp); \
+            auto base = getContextBase(e, i.src1.immediate, size, disp); \
+            e.store(value, base, disp); \
+        } \
+    };
+
+EMIT_CTXSTORE(CTXSTORE_I8,   I8Op,   1,  REG_TEMP1,  strb);
+EMIT_CTXSTORE(CTXSTORE_I16,  I16Op,  2,  REG_TEMP1,  strh);
+EMIT_CTXSTORE(CTXSTORE_I32,  I32Op,  4,  REG_TEMP1,  str);
+EMIT_CTXSTORE(CTXSTORE_I64,  I64Op,  8,  REG_TEMP1,  str);
+EMIT_CTXSTORE(CTXSTORE_F32,  F32Op,  4,  VREG_TEMP0, str);
+EMIT_CTXSTORE(CTXSTORE_F64,  F64Op,  8,  VREG_TEMP0, str);
+EMIT_CTXSTORE(CTXSTORE_V128, V128Op, 16, VREG_TEMP0, str);
+
+#undef EMIT_CTXSTORE
+
+/**
+ * Opcode: MEMFENCE
+ */
+struct MEMFENCE : Sequence<MEMFENCE, I<OPCODE_MEMFENCE>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        e.dmb(BARRIER_ISH);
+    }
+};
+
+/**
+ * Opcode: SELECT
+ */
+#define EMIT_SELECT(name, OpType, temp1, temp2, select) \
+    struct name : Sequence<name, I<OPCODE_SELECT, OpType, I8Op, OpType, OpType>> { \
+        static void emit(ARMEmitter& e, InstrType& i) { \
+            auto cond = getExtendedReg(e, i.src1, REG_TEMP0, false); \
+            e.cmp(cond, 0); \
+            auto src2 = getReg(e, i.src2, temp1); \
+            auto src3 = getReg(e, i.src3, temp2); \
+            e.select(i.dest.reg, src2, src3, NE); \
+        } \
+    };
+
+EMIT_SELECT(SELECT_I8,  I8Op,  REG_TEMP0,  REG_TEMP1,  csel);
+EMIT_SELECT(SELECT_I16, I16Op, REG_TEMP0,  REG_TEMP1,  csel);
+EMIT_SELECT(SELECT_I32, I32Op, REG_TEMP0,  REG_TEMP1,  csel);
+EMIT_SELECT(SELECT_I64, I64Op, REG_TEMP0,  REG_TEMP1,  csel);
+EMIT_SELECT(SELECT_F32, F32Op, VREG_TEMP0, VREG_TEMP1, fcsel);
+EMIT_SELECT(SELECT_F64, F64Op, VREG_TEMP0, VREG_TEMP1, fcsel);
+
+#undef EMIT_SELECT
+
+/**
+ * Opcode: CMP
+ */
+static Condition getIntegerCondition(U32 flags) {
+    switch (flags) {
+    case COMPARE_EQ:  return EQ;
+    case COMPARE_NE:  return NE;
+    case COMPARE_SLT: return LT;
+    case COMPARE_SLE: return LE;
+    case COMPARE_SGE: return GE;
+    case COMPARE_SGT: return GT;
+    case COMPARE_ULT: return LO;
+    case COMPARE_ULE: return LS;
+    case COMPARE_UGE: return HS;
+    case COMPARE_UGT: return HI;
+    default:
+        assert_always("Unimplemented case");
+        return AL;
+    }
+}
+
+// Unsigned conditions are true for unordered operands
+static Condition getFloatCondition(U32 flags) {
+    switch (flags) {
+    case COMPARE_EQ:  return EQ;
+    case COMPARE_NE:  return NE;
+    case COMPARE_SLT: return MI;
+    case COMPARE_SLE: return LS;
+    case COMPARE_SGE: return GE;
+    case COMPARE_SGT: return GT;
+    case COMPARE_ULT: return LT;
+    case COMPARE_ULE: return LE;
+    case COMPARE_UGE: return HS;
+    case COMPARE_UGT: return HI;
+    default:
+        assert_always("Unimplemented case");
+        return AL;
+    }
+}
+
+static bool isUnsignedCompare(U32 flags) {
+    return (flags & COMPARE_ULT & ~COMPARE_SLT) != 0;
+}
+
+#define EMIT_INTEGER_COMPARE(name, OpType) \
+    struct name : Sequence<name, I<OPCODE_CMP, I8Op, OpType, OpType>> { \
+        static void emit(ARMEmitter& e, InstrType& i) { \
+            const bool isSigned = !isUnsignedCompare(i.instr->flags); \
+            auto lhs = getExtendedReg(e, i.src1, REG_TEMP0, isSigned); \
+            if (i.src2.isConstant && i.src2.constant() >= 0 && i.src2.constant() < 4096) { \
+                e.cmp(lhs, static_cast<U32>(i.src2.constant())); \
+            } else { \
+                e.cmp(lhs, getExtendedReg(e, i.src2, REG_TEMP1, isSigned)); \
+            } \
+            e.cset(i.dest.reg, getIntegerCondition(i.instr->flags)); \
+        } \
+    };
+
+EMIT_INTEGER_COMPARE(CMP_I8,  I8Op);
+EMIT_INTEGER_COMPARE(CMP_I16, I16Op);
+EMIT_INTEGER_COMPARE(CMP_I32, I32Op);
+EMIT_INTEGER_COMPARE(CMP_I64, I64Op);
+
+#undef EMIT_INTEGER_COMPARE
+
+#define EMIT_FLOAT_COMPARE(name, OpType) \
+    struct name : Sequence<name, I<OPCODE_CMP, I8Op, OpType, OpType>> { \
+        static void emit(ARMEmitter& e, InstrType& i) { \
+            auto lhs = getReg(e, i.src1, VREG_TEMP0); \
+            auto rhs = getReg(e, i.src2, VREG_TEMP1); \
+            e.fcmp(lhs, rhs); \
+            e.cset(i.dest.reg, getFloatCondition(i.instr->flags)); \
+        } \
+    };
+
+EMIT_FLOAT_COMPARE(CMP_F32, F32Op);
+EMIT_FLOAT_COMPARE(CMP_F64, F64Op);
+
+#undef EMIT_FLOAT_COMPARE
+
+/**
+ * Opcode: BR
+ */
+struct BR : Sequence<BR, I<OPCODE_BR, VoidOp, BlockOp>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        e.b(e.labels[i.src1.block]);
+    }
+};
+
+/**
+ * Opcode: ARG
+ */
+#define EMIT_ARG(name, OpType) \
+    struct name : Sequence<name, I<OPCODE_ARG, OpType, ImmediateOp, OpType>> { \
+        static void emit(ARMEmitter& e, InstrType& i) { \
+            if (i.src2.isConstant) { \
+                e.movImm(i.dest.reg, static_cast<U64>(i.src2.constant())); \
+            } else if (i.dest.reg != i.src2.reg) { \
+                e.mov(i.dest.reg, i.src2.reg); \
+            } \
+        } \
+    };
+
+EMIT_ARG(ARG_I8,  I8Op);
+EMIT_ARG(ARG_I16, I16Op);
+EMIT_ARG(ARG_I32, I32Op);
+EMIT_ARG(ARG_I64, I64Op);
+
+#undef EMIT_ARG
+
+/**
+ * Opcode: CALL
+ */
+static void emitCall(ARMEmitter& e, const Instruction* instr, const Function* target) {
+    if ((instr->flags & CALL_EXTERN) || !e.settings().isJIT) {
+        e.movImm(XReg(REG_TEMP0), reinterpret_cast<U64>(target->nativeAddress.load(std::memory_order_acquire)));
+    } else {
+        // Call through the function to pick up recompiled or invalidated code
+        e.movImm(XReg(REG_TEMP0), reinterpret_cast<U64>(target));
+        e.ldr(XReg(REG_TEMP0), XReg(REG_TEMP0), offsetof(hir::Function, nativeAddress));
+    }
+    e.blr(XReg(REG_TEMP0));
+}
+
+struct CALL_VOID : Sequence<CALL_VOID, I<OPCODE_CALL, VoidOp, FunctionOp>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        emitCall(e, i.instr, i.src1.function);
+    }
+};
+
+#define EMIT_CALL(name, OpType, RetType) \
+    struct name : Sequence<name, I<OPCODE_CALL, OpType, FunctionOp>> { \
+        static void emit(ARMEmitter& e, InstrType& i) { \
+            emitCall(e, i.instr, i.src1.function); \
+            e.mov(i.dest.reg, RetType(0)); \
+        } \
+    };
+
+EMIT_CALL(CALL_I8,  I8Op,  WReg);
+EMIT_CALL(CALL_I16, I16Op, WReg);
+EMIT_CALL(CALL_I32, I32Op, WReg);
+EMIT_CALL(CALL_I64, I64Op, XReg);
+
+#undef EMIT_CALL
+
+/**
+ * Opcode: BRCOND
+ */
+#define EMIT_BRCOND(name, OpType) \
+    struct name : Sequence<name, I<OPCODE_BRCOND, VoidOp, OpType, BlockOp>> { \
+        static void emit(ARMEmitter& e, InstrType& i) { \
+            auto cond = getExtendedReg(e, i.src1, REG_TEMP0, false); \
+            e.cbnz(cond, e.labels[i.src2.block]); \
+        } \
+    };
+
+EMIT_BRCOND(BRCOND_I8,  I8Op);
+EMIT_BRCOND(BRCOND_I16, I16Op);
+EMIT_BRCOND(BRCOND_I32, I32Op);
+EMIT_BRCOND(BRCOND_I64, I64Op);
+
+#undef EMIT_BRCOND
+
+/**
+ * Opcode: RET
+ */
+struct RET_VOID : Sequence<RET_VOID, I<OPCODE_RET, VoidOp, VoidOp>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        e.b(e.labelEpilog);
+    }
+};
+
+#define EMIT_RET(name, OpType, RetType, move) \
+    struct name : Sequence<name, I<OPCODE_RET, VoidOp, OpType>> { \
+        static void emit(ARMEmitter& e, InstrType& i) { \
+            e.move(RetType(0), getReg(e, i.src1, REG_TEMP0)); \
+            e.b(e.labelEpilog); \
+        } \
+    };
+
+EMIT_RET(RET_I8,  I8Op,  WReg, mov);
+EMIT_RET(RET_I16, I16Op, WReg, mov);
+EMIT_RET(RET_I32, I32Op, WReg, mov);
+EMIT_RET(RET_I64, I64Op, XReg, mov);
+EMIT_RET(RET_F32, F32Op, SReg, fmov);
+EMIT_RET(RET_F64, F64Op, DReg, fmov);
+
+#undef EMIT_RET
+
+/**
+ * Opcode: FADD, FSUB, FMUL, FDIV, FNEG
+ */
+#define EMIT_FLOAT_BINARY_OP(name, opcode, OpType, op) \
+    struct name : Sequence<name, I<opcode, OpType, OpType, OpType>> { \
+        static void emit(ARMEmitter& e, InstrType& i) { \
+            emitBinaryVecOp(e, i, [](ARMEmitter& e, auto dest, auto src1, auto src2) { \
+                e.op(dest, src1, src2); \
+            }); \
+        } \
+    };
+
+EMIT_FLOAT_BINARY_OP(FADD_F32, OPCODE_FADD, F32Op, fadd);
+EMIT_FLOAT_BINARY_OP(FADD_F64, OPCODE_FADD, F64Op, fadd);
+EMIT_FLOAT_BINARY_OP(FSUB_F32, OPCODE_FSUB, F32Op, fsub);
+EMIT_FLOAT_BINARY_OP(FSUB_F64, OPCODE_FSUB, F64Op, fsub);
+EMIT_FLOAT_BINARY_OP(FMUL_F32, OPCODE_FMUL, F32Op, fmul);
+EMIT_FLOAT_BINARY_OP(FMUL_F64, OPCODE_FMUL, F64Op, fmul);
+EMIT_FLOAT_BINARY_OP(FDIV_F32, OPCODE_FDIV, F32Op, fdiv);
+EMIT_FLOAT_BINARY_OP(FDIV_F64, OPCODE_FDIV, F64Op, fdiv);
+
+#undef EMIT_FLOAT_BINARY_OP
+
+struct FNEG_F32 : Sequence<FNEG_F32, I<OPCODE_FNEG, F32Op, F32Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        e.fneg(i.dest.reg, getReg(e, i.src1, VREG_TEMP0));
+    }
+};
+struct FNEG_F64 : Sequence<FNEG_F64, I<OPCODE_FNEG, F64Op, F64Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        e.fneg(i.dest.reg, getReg(e, i.src1, VREG_TEMP0));
+    }
+};
+
+/**
+ * Opcode: VADD, VSUB
+ */
+static Arrangement getIntegerArrangement(U32 componentType) {
+    switch (componentType) {
+    case COMPONENT_I8:  return ARR_16B;
+    case COMPONENT_I16: return ARR_8H;
+    case COMPONENT_I32: return ARR_4S;
+    case COMPONENT_I64: return ARR_2D;
+    default:
+        assert_always("Unimplemented");
+        return ARR_16B;
+    }
+}
+
+struct VADD_V128 : Sequence<VADD_V128, I<OPCODE_VADD, V128Op, V128Op, V128Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        emitBinaryVecOp(e, i, [&i](ARMEmitter& e, auto dest, auto src1, auto src2) {
+            const bool isUnsigned = i.instr->flags & ARITHMETIC_UNSIGNED;
+            const bool isSaturate = i.instr->flags & ARITHMETIC_SATURATE;
+            switch (COMPONENT_TYPE) {
+            case COMPONENT_F32:
+                e.fadd(dest, src1, src2, ARR_4S);
+                break;
+            case COMPONENT_F64:
+                e.fadd(dest, src1, src2, ARR_2D);
+                break;
+            default:
+                const auto arr = getIntegerArrangement(COMPONENT_TYPE);
+                if (!isSaturate) {
+                    e.add(dest, src1, src2, arr);
+                } else if (isUnsigned) {
+                    e.uqadd(dest, src1, src2, arr);
+                } else {
+                    e.sqadd(dest, src1, src2, arr);
+                }
+            }
+        });
+    }
+};
+struct VSUB_V128 : Sequence<VSUB_V128, I<OPCODE_VSUB, V128Op, V128Op, V128Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        emitBinaryVecOp(e, i, [&i](ARMEmitter& e, auto dest, auto src1, auto src2) {
+            const bool isUnsigned = i.instr->flags & ARITHMETIC_UNSIGNED;
+            const bool isSaturate = i.instr->flags & ARITHMETIC_SATURATE;
+            switch (COMPONENT_TYPE) {
+            case COMPONENT_F32:
+                e.fsub(dest, src1, src2, ARR_4S);
+                break;
+            case COMPONENT_F64:
+                e.fsub(dest, src1, src2, ARR_2D);
+                break;
+            default:
+                const auto arr = getIntegerArrangement(COMPONENT_TYPE);
+                if (!isSaturate) {
+                    e.sub(dest, src1, src2, arr);
+                } else if (isUnsigned) {
+                    e.uqsub(dest, src1, src2, arr);
+                } else {
+                    e.sqsub(dest, src1, src2, arr);
+                }
+            }
+        });
+    }
+};
+
+/**
+ * Opcode: EXTRACT
+ */
+#define EMIT_EXTRACT(name, OpType, arr) \
+    struct name : Sequence<name, I<OPCODE_EXTRACT, OpType, V128Op, I8Op>> { \
+        static void emit(ARMEmitter& e, InstrType& i) { \
+            assert_true(i.src2.isConstant); \
+            auto src = getReg(e, i.src1, VREG_TEMP0); \
+            e.umov(i.dest.reg, src, arr, static_cast<U08>(i.src2.constant())); \
+        } \
+    };
+
+EMIT_EXTRACT(EXTRACT_I8_V128,  I8Op,  ARR_16B);
+EMIT_EXTRACT(EXTRACT_I16_V128, I16Op, ARR_8H);
+EMIT_EXTRACT(EXTRACT_I32_V128, I32Op, ARR_4S);
+
+#undef EMIT_EXTRACT
+
+/**
+ * Opcode: INSERT
+ */
+#define EMIT_INSERT(name, OpType, arr) \
+    struct name : Sequence<name, I<OPCODE_INSERT, V128Op, V128Op, I8Op, OpType>> { \
+        static void emit(ARMEmitter& e, InstrType& i) { \
+            assert_true(i.src2.isConstant); \
+            if (i.src1.isConstant) { \
+                getReg(e, i.src1, i.dest.reg.code); \
+            } else if (i.dest.reg != i.src1.reg) { \
+                e.mov(i.dest.reg, i.src1.reg); \
+            } \
+            auto value = getReg(e, i.src3, REG_TEMP0); \
+            e.ins(i.dest.reg, arr, static_cast<U08>(i.src2.constant()), value); \
+        } \
+    };
+
+EMIT_INSERT(INSERT_V128_I8,  I8Op,  ARR_16B);
+EMIT_INSERT(INSERT_V128_I16, I16Op, ARR_8H);
+EMIT_INSERT(INSERT_V128_I32, I32Op, ARR_4S);
+
+#undef EMIT_INSERT
+
+struct INSERT_V128_I64 : Sequence<INSERT_V128_I64, I<OPCODE_INSERT, V128Op, V128Op, I8Op, I64Op>> {
+    static void emit(ARMEmitter& e, InstrType& i) {
+        assert_true(i.src2.isConstant);
+        if (i.src1.isConstant) {
+            getReg(e, i.src1, i.dest.reg.code);
+        } else if (i.dest.reg != i.src1.reg) {
+            e.mov(i.dest.reg, i.src1.reg);
+        }
+        auto value = getReg(e, i.src3, REG_TEMP0);
+        e.ins(i.dest.reg, ARR_2D, static_cast<U08>(i.src2.constant()), value);
+    }
+};
+
+/**
+ * ARM Sequences
+ */
+std::unordered_map<InstrKey::Value, ARMSequences::SelectFunction> ARMSequences::sequences;
+
+void ARMSequences::init() {
+    // Initialize sequences if necessary
+    if (sequences.empty()) {
+        registerSequence<ADD_I8, ADD_I16, ADD_I32, ADD_I64>();
+        registerSequence<SUB_I8, SUB_I16, SUB_I32, SUB_I64>();
+        registerSequence<MUL_I8, MUL_I16, MUL_I32, MUL_I64>();
+        registerSequence<MULH_I8, MULH_I16, MULH_I32, MULH_I64>();
+        registerSequence<DIV_I8, DIV_I16, DIV_I32, DIV_I64>();
+        registerSequence<SQRT_F32, SQRT_F64>();
+        registerSequence<ABS_F32, ABS_F64>();
+        registerSequence<NEG_I8, NEG_I16, NEG_I32, NEG_I64>();
+        registerSequence<NOT_I8, NOT_I16, NOT_I32, NOT_I64, NOT_V128>();
+        registerSequence<AND_I8, AND_I16, AND_I32, AND_I64, AND_V128>();
+        registerSequence<OR_I8, OR_I16, OR_I32, OR_I64, OR_V128>();
+        registerSequence<XOR_I8, XOR_I16, XOR_I32, XOR_I64, XOR_V128>();
+        registerSequence<SHL_I8, SHL_I16, SHL_I32, SHL_I64>();
+        registerSequence<SHR_I8, SHR_I16, SHR_I32, SHR_I64>();
+        registerSequence<SHRA_I8, SHRA_I16, SHRA_I32, SHRA_I64>();
+        registerSequence<ZEXT_I16_I8, ZEXT_I32_I8, ZEXT_I64_I8, ZEXT_I32_I16, ZEXT_I64_I16, ZEXT_I64_I32>();
+        registerSequence<SEXT_I16_I8, SEXT_I32_I8, SEXT_I64_I8, SEXT_I32_I16, SEXT_I64_I16, SEXT_I64_I32>();
+        registerSequence<TRUNC_I8_I16, TRUNC_I8_I32, TRUNC_I8_I64, TRUNC_I16_I32, TRUNC_I16_I64, TRUNC_I32_I64>();
+        registerSequence<CAST_I32_F32, CAST_F32_I32, CAST_I64_F64, CAST_F64_I64>();
+        registerSequence<CONVERT_I32_F32, CONVERT_I32_F64, CONVERT_I64_F64, CONVERT_F32_F64, CONVERT_F64_I64, CONVERT_F64_F32>();
+        registerSequence<CTLZ_I8, CTLZ_I16, CTLZ_I32, CTLZ_I64>();
+        registerSequence<LOAD_I8, LOAD_I16, LOAD_I32, LOAD_I64, LOAD_F32, LOAD_F64, LOAD_V128>();
+        registerSequence<STORE_I8, STORE_I16, STORE_I32, STORE_I64, STORE_F32, STORE_F64, STORE_V128>();
+        registerSequence<CTXLOAD_I8, CTXLOAD_I16, CTXLOAD_I32, CTXLOAD_I64, CTXLOAD_F32, CTXLOAD_F64, CTXLOAD_V128>();
+        registerSequence<CTXSTORE_I8, CTXSTORE_I16, CTXSTORE_I32, CTXSTORE_I64, CTXSTORE_F32, CTXSTORE_F64, CTXSTORE_V128>();
+        registerSequence<MEMFENCE>();
+        registerSequence<SELECT_I8, SELECT_I16, SELECT_I32, SELECT_I64, SELECT_F32, SELECT_F64>();
+        registerSequence<CMP_I8, CMP_I16, CMP_I32, CMP_I64, CMP_F32, CMP_F64>();
+        registerSequence<ARG_I8, ARG_I16, ARG_I32, ARG_I64>();
+        registerSequence<BR>();
+        registerSequence<CALL_VOID, CALL_I8, CALL_I16, CALL_I32, CALL_I64>();
+        registerSequence<BRCOND_I8, BRCOND_I16, BRCOND_I32, BRCOND_I64>();
+        registerSequence<RET_VOID, RET_I8, RET_I16, RET_I32, RET_I64, RET_F32, RET_F64>();
+
+        // Floating-point operations
+        registerSequence<FADD_F32, FADD_F64>();
+        registerSequence<FSUB_F32, FSUB_F64>();
+        registerSequence<FMUL_F32, FMUL_F64>();
+        registerSequence<FDIV_F32, FDIV_F64>();
+        registerSequence<FNEG_F32, FNEG_F64>();
+
+        // Vector operations
+        registerSequence<VADD_V128>();
+        registerSequence<VSUB_V128>();
+        registerSequence<EXTRACT_I8_V128, EXTRACT_I16_V128, EXTRACT_I32_V128>();
+        registerSequence<INSERT_V128_I8, INSERT_V128_I16, INSERT_V128_I32, INSERT_V128_I64>();
+    }
+}
+
+bool ARMSequences::select(ARMEmitter& emitter, const hir::Instruction* instr) {
+    auto key = InstrKey(instr).value;
+    auto it = sequences.find(key);
+    if (it != sequences.end()) {
+        it->second(emitter, instr);
+        return true;
+    }
+
+    logger.error(LOG_CPU, "No sequence found");
+    return false;
+}
+
+}  // namespace arm
+}  // namespace backend
+}  // namespace cpu
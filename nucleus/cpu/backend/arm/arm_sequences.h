@@ -0,0 +1,53 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+#include "nucleus/cpu/backend/sequences.h"
+#include "nucleus/cpu/backend/arm/arm_emitter.h"
+
+#include <unordered_map>
+
+namespace cpu {
+namespace backend {
+namespace arm {
+
+class ARMSequences {
+    // Sequence selection function type
+    using SelectFunction = void(*)(ARMEmitter&, const hir::Instruction*);
+
+    // Registered sequences
+    static std::unordered_map<InstrKey::Value, SelectFunction> sequences;
+
+    // Sequence registration
+    template <typename T>
+    static void registerSequence() {
+        sequences.insert({ T::key, T::select });
+    }
+    template <typename T0, typename T1, typename... Ts>
+    static void registerSequence() {
+        registerSequence<T0>();
+        registerSequence<T1, Ts...>();
+    }
+
+public:
+    /**
+     * Initialize the table of sequences
+     */
+    static void init();
+
+    /**
+     * Emit the corresponding ARM instructions for a given IR instruction sequence
+     * @param[in]  emitter  Emitter of ARM machine code
+     * @param[in]  instr    Instruction pointer
+     * @return              True on success
+     */
+    static bool select(ARMEmitter& emitter, const hir::Instruction* instr);
+};
+
+}  // namespace arm
+}  // namespace backend
+}  // namespace cpu
@@ -6,8 +6,10 @@
 #pragma once
 
 #include "nucleus/common.h"
+#include "nucleus/assert.h"
 
 #include <cstdint>
+#include <vector>
 
 namespace cpu {
 namespace backend {
@@ -33,6 +35,13 @@ public:
     bool is16Bit() const { return size == 16; }
     bool is32Bit() const { return size == 32; }
     bool is64Bit() const { return size == 64; }
+
+    bool operator==(const Register& other) const {
+        return code == other.code && type == other.type;
+    }
+    bool operator!=(const Register& other) const {
+        return !(*this == other);
+    }
 };
 
 class Assembler {
@@ -47,6 +56,7 @@ public:
 
     template <typename T>
     void emit(T data) {
+        assert_true(curSize + sizeof(T) <= codeSize, "Assembler buffer overflow");
         *reinterpret_cast<T*>(curAddr) = data;
         curAddr = reinterpret_cast<void*>(reinterpret_cast<intptr_t>(curAddr) + sizeof(T));
         curSize += sizeof(T);
@@ -59,6 +69,13 @@ public:
 
 class Label {
 public:
+    // Offset of the label in the code buffer, or -1 if it is not bound yet
+    S64 offset = -1;
+
+    // Offsets of the instructions referencing this label before it was bound
+    std::vector<Size> references;
+
+    bool isBound() const { return offset >= 0; }
 };
 
 }  // namespace backend
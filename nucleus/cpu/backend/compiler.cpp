@@ -64,7 +64,7 @@ void* Compiler::allocRWXMemory(Size size) {
     size_t pageSize = sysconf(_SC_PAGESIZE);
     size_t iaddr = reinterpret_cast<size_t>(addr);
     size_t roundedAddr = iaddr & ~(pageSize - 1);
-    if (!mprotect(reinterpret_cast<void*>(roundedAddr), size + (iaddr - roundedAddr), PROT_READ | PROT_WRITE | PROT_EXEC)) {
+    if (mprotect(reinterpret_cast<void*>(roundedAddr), size + (iaddr - roundedAddr), PROT_READ | PROT_WRITE | PROT_EXEC) != 0) {
         logger.error(LOG_CPU, "Could not allocate %d bytes of RWX memory", size);
         return nullptr;
     }
@@ -76,5 +76,16 @@ void Compiler::freeRWXMemory(void* addr) {
     free(addr);
 }
 
+void Compiler::flushInstructionCache(void* addr, Size size) {
+#if defined(NUCLEUS_ARCH_ARM)
+#if defined(NUCLEUS_TARGET_WINDOWS)
+    FlushInstructionCache(GetCurrentProcess(), addr, size);
+#else
+    char* begin = reinterpret_cast<char*>(addr);
+    __builtin___clear_cache(begin, begin + size);
+#endif
+#endif
+}
+
 }  // namespace backend
 }  // namespace cpu
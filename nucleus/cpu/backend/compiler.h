@@ -18,6 +18,9 @@
 #include <mutex>
 #include <vector>
 
+// Forward declarations
+namespace mem { class GuestVirtualMemory; }
+
 namespace cpu {
 namespace backend {
 
@@ -37,6 +40,10 @@ public:
     // Generic target information
     TargetInfo targetInfo;
 
+    // Guest memory accessed by loads and stores flagged with ACCESS_GUEST, only set if fastmem
+    // is enabled and the backend supports it. Frontends must not emit ACCESS_GUEST otherwise.
+    mem::GuestVirtualMemory* guestMemory = nullptr;
+
     // Constructor
     Compiler();
     Compiler(const Settings& settings);
@@ -45,7 +52,6 @@ public:
     virtual void addPass(std::unique_ptr<hir::Pass> pass);
 
     // Compile HIR
-    virtual bool compile(hir::Block* block) = 0;
     virtual bool compile(hir::Function* function) = 0;
     virtual bool compile(hir::Module* module) = 0;
 
@@ -60,6 +66,14 @@ public:
     // Manage RWX memory
     void* allocRWXMemory(Size size);
     void freeRWXMemory(void* addr);
+
+    /**
+     * Make freshly written code visible to the instruction fetch unit.
+     * Required on hosts without coherent instruction caches (e.g. ARM).
+     * @param[in]  addr  Start address of the code
+     * @param[in]  size  Size of the code in bytes
+     */
+    static void flushInstructionCache(void* addr, Size size);
 };
 
 }  // namespace backend
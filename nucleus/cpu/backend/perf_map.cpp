@@ -0,0 +1,197 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "perf_map.h"
+#include "nucleus/format.h"
+#include "nucleus/core/config.h"
+#include "nucleus/logger/logger.h"
+
+#if defined(NUCLEUS_TARGET_LINUX)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include <string>
+
+// Global perf map object
+cpu::backend::PerfMap perfMap;
+
+namespace cpu {
+namespace backend {
+
+#if defined(NUCLEUS_TARGET_LINUX)
+// Jitdump format, as specified in tools/perf/Documentation/jitdump-specification.txt
+#define JITDUMP_MAGIC    0x4A695444
+#define JITDUMP_VERSION  1
+
+#if defined(NUCLEUS_ARCH_X86_64BITS)
+#define JITDUMP_ELF_MACH  62   // EM_X86_64
+#elif defined(NUCLEUS_ARCH_ARM_64BITS)
+#define JITDUMP_ELF_MACH  183  // EM_AARCH64
+#else
+#define JITDUMP_ELF_MACH  0    // EM_NONE
+#endif
+
+enum JitdumpRecordType {
+    JIT_CODE_LOAD = 0,
+};
+
+struct JitdumpHeader {
+    U32 magic;
+    U32 version;
+    U32 totalSize;
+    U32 elfMach;
+    U32 pad1;
+    U32 pid;
+    U64 timestamp;
+    U64 flags;
+};
+
+struct JitdumpRecordHeader {
+    U32 id;
+    U32 totalSize;
+    U64 timestamp;
+};
+
+struct JitdumpCodeLoad {
+    JitdumpRecordHeader header;
+    U32 pid;
+    U32 tid;
+    U64 vma;
+    U64 codeAddr;
+    U64 codeSize;
+    U64 codeIndex;
+    // Followed by: null-terminated function name and the native code
+};
+
+/**
+ * Timestamps must match the clock used by `perf record -k mono`
+ */
+static U64 getTimestamp() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<U64>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+PerfMap::~PerfMap() {
+    close();
+}
+
+bool PerfMap::open() {
+#if defined(NUCLEUS_TARGET_LINUX)
+    const auto pid = getpid();
+
+    std::string mapPath = "/tmp/perf-" + std::to_string(pid) + ".map";
+    mapFile = fopen(mapPath.c_str(), "w");
+    if (!mapFile) {
+        logger.warning(LOG_CPU, "Could not create %s", mapPath.c_str());
+    }
+
+    std::string dumpPath = "/tmp/jit-" + std::to_string(pid) + ".dump";
+    dumpFile = fopen(dumpPath.c_str(), "w+");
+    if (!dumpFile) {
+        logger.warning(LOG_CPU, "Could not create %s", dumpPath.c_str());
+        return mapFile != nullptr;
+    }
+
+    // Perf locates the jitdump file by recording an executable mapping of it
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    dumpMarker = mmap(nullptr, pageSize, PROT_READ | PROT_EXEC, MAP_PRIVATE, fileno(dumpFile), 0);
+    if (dumpMarker == MAP_FAILED) {
+        logger.warning(LOG_CPU, "Could not map %s", dumpPath.c_str());
+        dumpMarker = nullptr;
+    }
+
+    JitdumpHeader header = {};
+    header.magic = JITDUMP_MAGIC;
+    header.version = JITDUMP_VERSION;
+    header.totalSize = sizeof(JitdumpHeader);
+    header.elfMach = JITDUMP_ELF_MACH;
+    header.pid = pid;
+    header.timestamp = getTimestamp();
+    fwrite(&header, sizeof(header), 1, dumpFile);
+    fflush(dumpFile);
+    return true;
+#else
+    logger.warning(LOG_CPU, "Perf maps are not supported on this platform");
+    return false;
+#endif
+}
+
+void PerfMap::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+#if defined(NUCLEUS_TARGET_LINUX)
+    if (dumpMarker) {
+        munmap(dumpMarker, sysconf(_SC_PAGESIZE));
+        dumpMarker = nullptr;
+    }
+#endif
+    if (dumpFile) {
+        fclose(dumpFile);
+        dumpFile = nullptr;
+    }
+    if (mapFile) {
+        fclose(mapFile);
+        mapFile = nullptr;
+    }
+}
+
+void PerfMap::writeMapEntry(const void* addr, Size size, const std::string& name) {
+    fprintf(mapFile, "%llx %llx %s\n",
+        static_cast<unsigned long long>(reinterpret_cast<uintptr_t>(addr)),
+        static_cast<unsigned long long>(size), name.c_str());
+    fflush(mapFile);
+}
+
+void PerfMap::writeDumpEntry(const void* addr, Size size, const std::string& name) {
+#if defined(NUCLEUS_TARGET_LINUX)
+    const U64 address = reinterpret_cast<uintptr_t>(addr);
+
+    JitdumpCodeLoad record = {};
+    record.header.id = JIT_CODE_LOAD;
+    record.header.totalSize = sizeof(JitdumpCodeLoad) + name.size() + 1 + size;
+    record.header.timestamp = getTimestamp();
+    record.pid = getpid();
+    record.tid = syscall(SYS_gettid);
+    record.vma = address;
+    record.codeAddr = address;
+    record.codeSize = size;
+    record.codeIndex = codeIndex++;
+    fwrite(&record, sizeof(record), 1, dumpFile);
+    fwrite(name.c_str(), name.size() + 1, 1, dumpFile);
+    fwrite(addr, size, 1, dumpFile);
+    fflush(dumpFile);
+#endif
+}
+
+void PerfMap::registerCode(const void* addr, Size size, const std::string& name) {
+    if (!config.perfMap || !addr || !size) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!initialized) {
+        initialized = true;
+        if (!open()) {
+            return;
+        }
+    }
+
+    // Anonymous functions are named after their host address
+    const std::string symbol = name.empty() ? format("jit_%p", addr) : name;
+    if (mapFile) {
+        writeMapEntry(addr, size, symbol);
+    }
+    if (dumpFile) {
+        writeDumpEntry(addr, size, symbol);
+    }
+}
+
+}  // namespace backend
+}  // namespace cpu
@@ -0,0 +1,58 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+namespace cpu {
+namespace backend {
+
+/**
+ * Describes JIT-compiled code to host profilers.
+ * On Linux, this writes the /tmp/perf-<pid>.map symbol file and the /tmp/jit-<pid>.dump
+ * jitdump file, which perf merges into its samples via `perf inject --jit`.
+ */
+class PerfMap {
+    std::mutex mutex;
+    bool initialized = false;
+
+    // Symbol map (perf-<pid>.map)
+    FILE* mapFile = nullptr;
+
+    // Jitdump (jit-<pid>.dump) and its executable mapping marker
+    FILE* dumpFile = nullptr;
+    void* dumpMarker = nullptr;
+    U64 codeIndex = 0;
+
+    bool open();
+    void writeMapEntry(const void* addr, Size size, const std::string& name);
+    void writeDumpEntry(const void* addr, Size size, const std::string& name);
+
+public:
+    ~PerfMap();
+
+    /**
+     * Register a range of native code. Does nothing unless enabled with --perf-map.
+     * @param[in]  addr  Host address of the code
+     * @param[in]  size  Size of the code in bytes
+     * @param[in]  name  Symbol name that profilers will show for this range
+     */
+    void registerCode(const void* addr, Size size, const std::string& name);
+
+    /**
+     * Flush and close the output files
+     */
+    void close();
+};
+
+}  // namespace backend
+}  // namespace cpu
+
+extern cpu::backend::PerfMap perfMap;
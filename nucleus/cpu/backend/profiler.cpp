@@ -0,0 +1,80 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "profiler.h"
+#include "nucleus/format.h"
+#include "nucleus/logger/logger.h"
+#include "nucleus/cpu/hir/module.h"
+
+#include <algorithm>
+#include <vector>
+
+// Global profiler object
+cpu::backend::Profiler profiler;
+
+namespace cpu {
+namespace backend {
+
+FunctionProfile* Profiler::getProfile(const hir::Function* function) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto& profile = profiles[function];
+    profile.name = function->name.empty() ? format("hir_%p", function) : function->name;
+    if (function->parent) {
+        profile.module = function->parent->name;
+    }
+    return &profile;
+}
+
+std::string Profiler::report(Size maxEntries) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Sort by time if cycles were sampled, otherwise by call count
+    U64 totalCount = 0;
+    U64 totalCycles = 0;
+    std::vector<const FunctionProfile*> sorted;
+    for (const auto& entry : profiles) {
+        const auto& profile = entry.second;
+        totalCount += profile.count;
+        totalCycles += profile.cycles;
+        if (profile.count) {
+            sorted.push_back(&profile);
+        }
+    }
+    std::sort(sorted.begin(), sorted.end(), [=](const FunctionProfile* a, const FunctionProfile* b) {
+        return totalCycles ? (a->cycles > b->cycles) : (a->count > b->count);
+    });
+
+    std::string output;
+    output += format("Profile: %llu calls to %llu functions\n",
+        static_cast<unsigned long long>(totalCount), static_cast<unsigned long long>(sorted.size()));
+    output += format("  %-20s %-24s %16s %16s %12s\n", "Function", "Module", "Calls", "Ticks (incl.)", "Ticks/call");
+    for (Size i = 0; i < sorted.size() && i < maxEntries; i++) {
+        const auto* profile = sorted[i];
+        output += format("  %-20s %-24s %16llu %16llu %12llu\n",
+            profile->name.c_str(),
+            profile->module.empty() ? "?" : profile->module.c_str(),
+            static_cast<unsigned long long>(profile->count),
+            static_cast<unsigned long long>(profile->cycles),
+            static_cast<unsigned long long>(profile->cycles / profile->count));
+    }
+    return output;
+}
+
+void Profiler::dump() {
+    logger.notice(LOG_CPU, "%s", report().c_str());
+}
+
+void Profiler::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (auto& entry : profiles) {
+        entry.second.count = 0;
+        entry.second.cycles = 0;
+    }
+}
+
+}  // namespace backend
+}  // namespace cpu
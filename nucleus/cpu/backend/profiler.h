@@ -0,0 +1,64 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+#include "nucleus/cpu/hir/function.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace cpu {
+namespace backend {
+
+/**
+ * Execution statistics of a compiled function.
+ * The counters are updated by the emitted code without synchronization,
+ * so concurrent calls might occasionally get lost.
+ */
+struct FunctionProfile {
+    std::string name;    // Function symbol, including its guest address
+    std::string module;  // Owning guest module
+    U64 count = 0;       // Number of calls
+    U64 cycles = 0;      // Host ticks spent in the function and its callees
+};
+
+class Profiler {
+    std::mutex mutex;
+    std::map<const hir::Function*, FunctionProfile> profiles;
+
+public:
+    /**
+     * Get the counters that the compiled code of a function should update.
+     * Recompiling a function keeps accumulating into the same counters.
+     * @param[in]  function  Function being compiled
+     * @return               Counters with a stable address
+     */
+    FunctionProfile* getProfile(const hir::Function* function);
+
+    /**
+     * Generate a human-readable report of the most executed functions
+     * @param[in]  maxEntries  Maximum number of functions to list
+     * @return                 String containing the report
+     */
+    std::string report(Size maxEntries = 50);
+
+    /**
+     * Print the report to the logger. Called at exit, or on demand
+     */
+    void dump();
+
+    /**
+     * Clear all counters, e.g. before profiling a specific scene
+     */
+    void reset();
+};
+
+}  // namespace backend
+}  // namespace cpu
+
+extern cpu::backend::Profiler profiler;
@@ -5,8 +5,20 @@
 
 #include "x86_compiler.h"
 #include "nucleus/emulator.h"
+#include "nucleus/core/config.h"
 #include "nucleus/logger/logger.h"
+#include "nucleus/cpu/backend/perf_map.h"
+#include "nucleus/cpu/backend/profiler.h"
+#include "nucleus/cpu/backend/x86/x86_emitter.h"
 #include "nucleus/cpu/backend/x86/x86_sequences.h"
+#include "nucleus/memory/memory.h"
+#include "nucleus/memory/guest_virtual/guest_virtual_memory.h"
+
+#if defined(NUCLEUS_TARGET_WINDOWS)
+#include <Windows.h>
+#elif defined(NUCLEUS_TARGET_LINUX) || defined(NUCLEUS_TARGET_OSX)
+#include <ucontext.h>
+#endif
 
 #ifdef NUCLEUS_ARCH_X86
 #ifdef NUCLEUS_COMPILER_MSVC
@@ -16,6 +28,7 @@
 #endif
 #endif
 
+#include <algorithm>
 #include <cstring>
 #include <queue>
 
@@ -33,6 +46,16 @@ X86Compiler::X86Compiler(const Settings& settings) : Compiler(settings) {
     init();
 }
 
+X86Compiler::~X86Compiler() {
+    mem::removeFaultHandler(handleFault, this);
+    FastmemTable* table = fastmemTables.exchange(nullptr);
+    while (table) {
+        FastmemTable* next = table->next;
+        delete table;
+        table = next;
+    }
+}
+
 void X86Compiler::setExtensionsHost() {
 #ifdef NUCLEUS_ARCH_X86
     extensions = 0;
@@ -71,10 +94,43 @@ void X86Compiler::init() {
 #endif
 }
 
-bool X86Compiler::compile(Block* block) {
-    // TODO
-    logger.warning(LOG_CPU, "Unimplemented compiler method");
-    return false;
+// Stack frame: shadow space plus slots used by the profiling code
+#define FRAME_SIZE          0x28
+#define FRAME_SIZE_PROFILE  0x38
+#define FRAME_PROFILE_TICKS 0x28
+#define FRAME_PROFILE_SAVE  0x30
+
+/**
+ * Count the call and, if requested, record the timestamp at function entry.
+ * Only RAX is clobbered, since the remaining volatile registers hold arguments.
+ */
+static void emitProfileEnter(X86Emitter& e, FunctionProfile* profile) {
+    e.mov(e.rax, reinterpret_cast<size_t>(&profile->count));
+    e.inc(e.qword[e.rax]);
+    if (config.profileCycles) {
+        e.mov(e.qword[e.rsp + FRAME_PROFILE_SAVE], e.rdx);
+        e.rdtsc();
+        e.shl(e.rdx, 32);
+        e.or_(e.rax, e.rdx);
+        e.mov(e.qword[e.rsp + FRAME_PROFILE_TICKS], e.rax);
+        e.mov(e.rdx, e.qword[e.rsp + FRAME_PROFILE_SAVE]);
+    }
+}
+
+/**
+ * Accumulate the ticks elapsed since function entry, preserving the return value
+ */
+static void emitProfileLeave(X86Emitter& e, FunctionProfile* profile) {
+    if (config.profileCycles) {
+        e.mov(e.qword[e.rsp + FRAME_PROFILE_SAVE], e.rax);
+        e.rdtsc();
+        e.shl(e.rdx, 32);
+        e.or_(e.rax, e.rdx);
+        e.sub(e.rax, e.qword[e.rsp + FRAME_PROFILE_TICKS]);
+        e.mov(e.rdx, reinterpret_cast<size_t>(&profile->cycles));
+        e.add(e.qword[e.rdx], e.rax);
+        e.mov(e.rax, e.qword[e.rsp + FRAME_PROFILE_SAVE]);
+    }
 }
 
 bool X86Compiler::compile(Function* function) {
@@ -94,9 +150,19 @@ bool X86Compiler::compile(Function* function) {
     logger.error(LOG_CPU, "Unsupported variant of the x86 architecture");
 #endif
 
+    // Profiling counters
+    FunctionProfile* profile = nullptr;
+    if (config.profile) {
+        profile = profiler.getProfile(function);
+    }
+    const U32 frameSize = (profile && config.profileCycles) ? FRAME_SIZE_PROFILE : FRAME_SIZE;
+
     // Prolog block
     e.L(e.labelProlog);
-    e.sub(e.rsp, 0x28);
+    e.sub(e.rsp, frameSize);
+    if (profile) {
+        emitProfileEnter(e, profile);
+    }
     if (!(function->blocks[0]->flags & BLOCK_IS_ENTRY)) {
         e.jmp(e.labelEntry, e.T_NEAR);
     }
@@ -122,14 +188,34 @@ bool X86Compiler::compile(Function* function) {
 
     // Epilog block
     e.L(e.labelEpilog);
-    e.add(e.rsp, 0x28);
+    if (profile) {
+        emitProfileLeave(e, profile);
+    }
+    e.add(e.rsp, frameSize);
     e.ret();
 
+    // Slow paths of guest memory accesses, resuming right after their fast path
+    std::vector<FastmemTable::Entry> fastmemEntries;
+    for (const auto& site : e.fastmemSites) {
+        FastmemTable::Entry entry;
+        entry.start = static_cast<U32>(site.start);
+        entry.end = static_cast<U32>(site.end);
+        entry.stub = static_cast<U32>(e.getSize());
+        site.slowPath(e);
+        e.jmp(e.getCode() + site.end, e.T_NEAR);
+        fastmemEntries.push_back(entry);
+    }
+
     // Copy emitted code
     const auto codeSize = e.getSize();
+    void* nativeAddress = allocRWXMemory(codeSize);
+    memcpy(nativeAddress, e.getCode(), codeSize);
+    if (!fastmemEntries.empty()) {
+        addFastmemTable(nativeAddress, codeSize, std::move(fastmemEntries));
+    }
     function->nativeSize = codeSize;
-    function->nativeAddress = allocRWXMemory(codeSize);
-    memcpy(function->nativeAddress, e.getCode(), codeSize);
+    function->nativeAddress.store(nativeAddress, std::memory_order_release);
+    perfMap.registerCode(nativeAddress, codeSize, function->name);
 
     function->flags |= FUNCTION_IS_COMPILED;
     return true;
@@ -154,21 +240,28 @@ bool X86Compiler::call(hir::Function* function, void* state, const std::vector<h
     // Generate code for caller
     X86Emitter e(this);
     e.push(e.rbx);
+    e.push(e.rbp);
     e.push(e.r10);
     e.push(e.r11);
     e.push(e.r12);
     e.push(e.r13);
     e.push(e.r14);
     e.push(e.r15);
+    e.sub(e.rsp, 8);
     e.mov(e.rbx, reinterpret_cast<size_t>(state));
-    e.mov(e.rax, reinterpret_cast<size_t>(function->nativeAddress));
+    if (guestMemory) {
+        e.mov(e.rbp, reinterpret_cast<size_t>(guestMemory->getBaseAddr()));
+    }
+    e.mov(e.rax, reinterpret_cast<size_t>(function->nativeAddress.load(std::memory_order_acquire)));
     e.call(e.rax);
+    e.add(e.rsp, 8);
     e.pop(e.r15);
     e.pop(e.r14);
     e.pop(e.r13);
     e.pop(e.r12);
     e.pop(e.r11);
     e.pop(e.r10);
+    e.pop(e.rbp);
     e.pop(e.rbx);
     e.ret();
 
@@ -178,6 +271,85 @@ bool X86Compiler::call(hir::Function* function, void* state, const std::vector<h
     return true;
 }
 
+/**
+ * Fastmem
+ */
+void X86Compiler::addFastmemTable(const void* code, Size codeSize, std::vector<FastmemTable::Entry> entries) {
+    std::call_once(fastmemHandlerFlag, [this] {
+        mem::addFaultHandler(handleFault, this);
+    });
+
+    auto* table = new FastmemTable();
+    table->code = static_cast<const U08*>(code);
+    table->codeSize = codeSize;
+    table->entries = std::move(entries);
+    table->next = fastmemTables.load(std::memory_order_relaxed);
+    while (!fastmemTables.compare_exchange_weak(table->next, table, std::memory_order_release)) {
+    }
+}
+
+// Pointer to the saved instruction pointer in the context of a fault
+static U64* getInstructionPointer(void* context) {
+#if defined(NUCLEUS_TARGET_WINDOWS) && defined(NUCLEUS_ARCH_X86_64BITS)
+    return reinterpret_cast<U64*>(&static_cast<PCONTEXT>(context)->Rip);
+#elif defined(NUCLEUS_TARGET_LINUX) && defined(NUCLEUS_ARCH_X86_64BITS)
+    return reinterpret_cast<U64*>(&static_cast<ucontext_t*>(context)->uc_mcontext.gregs[REG_RIP]);
+#elif defined(NUCLEUS_TARGET_OSX) && defined(NUCLEUS_ARCH_X86_64BITS)
+    return reinterpret_cast<U64*>(&static_cast<ucontext_t*>(context)->uc_mcontext->__ss.__rip);
+#else
+    return nullptr;
+#endif
+}
+
+bool X86Compiler::handleFault(mem::FaultInfo& info, void* userdata) {
+    auto* compiler = static_cast<X86Compiler*>(userdata);
+    U64* pc = getInstructionPointer(info.context);
+    if (!pc || !compiler->guestMemory) {
+        return false;
+    }
+
+    // Only unmapped pages within reach of a fastmem access, i.e. [base, base + 4 GB + 16)
+    const auto base = reinterpret_cast<U64>(compiler->guestMemory->getBaseAddr());
+    const auto address = reinterpret_cast<U64>(info.address);
+    if (address < base || address - base >= 0x100000010ULL) {
+        return false;
+    }
+    if (compiler->guestMemory->check(static_cast<U32>(address - base))) {
+        return false;
+    }
+
+    for (auto* table = compiler->fastmemTables.load(std::memory_order_acquire); table; table = table->next) {
+        if (*pc < reinterpret_cast<U64>(table->code) || *pc >= reinterpret_cast<U64>(table->code) + table->codeSize) {
+            continue;
+        }
+        const auto offset = static_cast<U32>(*pc - reinterpret_cast<U64>(table->code));
+        auto entry = std::upper_bound(table->entries.begin(), table->entries.end(), offset,
+            [](U32 offset, const FastmemTable::Entry& entry) { return offset < entry.start; });
+        if (entry == table->entries.begin() || offset >= (--entry)->end) {
+            return false;
+        }
+
+        // Replace the 5-byte NOP of the patch point with a jump to the slow path.
+        // The NOP never crosses a qword, so the patch is visible atomically to other threads.
+        U08* patch = const_cast<U08*>(table->code) + entry->start;
+        auto* qword = reinterpret_cast<volatile U64*>(reinterpret_cast<U64>(patch) & ~7ULL);
+        const Size shift = reinterpret_cast<U64>(patch) & 7;
+        const S32 rel32 = static_cast<S32>(entry->stub - (entry->start + 5));
+        U08 bytes[8];
+        U64 value = *qword;
+        std::memcpy(bytes, &value, sizeof(bytes));
+        bytes[shift] = 0xE9;
+        std::memcpy(&bytes[shift + 1], &rel32, sizeof(rel32));
+        std::memcpy(&value, bytes, sizeof(bytes));
+        *qword = value;
+
+        // Resume the faulting access in the slow path
+        *pc = reinterpret_cast<U64>(table->code) + entry->stub;
+        return true;
+    }
+    return false;
+}
+
 }  // namespace x86
 }  // namespace backend
 }  // namespace cpu
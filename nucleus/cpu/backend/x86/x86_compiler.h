@@ -8,8 +8,12 @@
 #include "nucleus/common.h"
 #include "nucleus/core/host.h"
 #include "nucleus/cpu/backend/compiler.h"
+#include "nucleus/memory/fault.h"
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 namespace cpu {
 namespace backend {
@@ -30,6 +34,36 @@ private:
     // Initialize compiler
     void init();
 
+    /**
+     * Fastmem accesses of a compiled function, sorted by offset.
+     * Tables are never modified after being published, nor released before the compiler,
+     * so that the fault handler can walk them without locking.
+     */
+    struct FastmemTable {
+        struct Entry {
+            U32 start;  // Offset of the patch point
+            U32 end;    // Offset right after the fast path
+            U32 stub;   // Offset of the slow path
+        };
+        const U08* code;
+        Size codeSize;
+        std::vector<Entry> entries;
+        FastmemTable* next;
+    };
+    std::atomic<FastmemTable*> fastmemTables{nullptr};
+    std::once_flag fastmemHandlerFlag;
+
+    /**
+     * Publish the fastmem accesses of freshly compiled code
+     * @param[in]  code      Address of the compiled code
+     * @param[in]  codeSize  Size of the compiled code in bytes
+     * @param[in]  entries   Accesses with their slow paths
+     */
+    void addFastmemTable(const void* code, Size codeSize, std::vector<FastmemTable::Entry> entries);
+
+    // Redirect faulting fastmem accesses to their slow paths
+    static bool handleFault(mem::FaultInfo& info, void* userdata);
+
 public:
     // Available x86 extensions
     U32 extensions = 0;
@@ -38,8 +72,8 @@ public:
     // Constructor
     X86Compiler();
     X86Compiler(const Settings& settings);
+    ~X86Compiler();
 
-    virtual bool compile(hir::Block* block) override;
     virtual bool compile(hir::Function* function) override;
     virtual bool compile(hir::Module* module) override;
 
@@ -28,6 +28,10 @@ const Settings& X86Emitter::settings() const {
     return compiler->settings;
 }
 
+mem::GuestVirtualMemory* X86Emitter::guestMemory() const {
+    return compiler->guestMemory;
+}
+
 }  // namespace x86
 }  // namespace backend
 }  // namespace cpu
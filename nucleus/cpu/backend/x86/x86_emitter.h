@@ -10,7 +10,12 @@
 #include "nucleus/cpu/backend/settings.h"
 #include "nucleus/cpu/backend/x86/x86_assembler.h"
 
+#include <functional>
 #include <unordered_map>
+#include <vector>
+
+// Forward declarations
+namespace mem { class GuestVirtualMemory; }
 
 namespace cpu {
 namespace backend {
@@ -18,6 +23,18 @@ namespace x86 {
 
 // Forward declarations
 class X86Compiler;
+class X86Emitter;
+
+/**
+ * Guest memory access emitted as a single host access relative to the guest memory
+ * base, which is pinned to RBP. Its slow path is emitted out of line and is only
+ * reached once the fast path faults.
+ */
+struct FastmemSite {
+    Size start;  // Offset of the patch point at the beginning of the fast path
+    Size end;    // Offset right after the fast path
+    std::function<void(X86Emitter&)> slowPath;
+};
 
 enum X86Mode {
     X86_MODE_32BITS = (1 << 0),
@@ -39,6 +56,9 @@ public:
     Xbyak::Label labelProlog;
     Xbyak::Label labelEpilog;
 
+    // Guest memory accesses emitted in fastmem mode
+    std::vector<FastmemSite> fastmemSites;
+
     // Constructor
     X86Emitter(const X86Compiler* compiler);
     X86Emitter(const X86Compiler* compiler, void* address, U64 size);
@@ -54,6 +74,12 @@ public:
      * @return Compiler settings member
      */
     const Settings& settings() const;
+
+    /**
+     * Return the guest memory accessed by ACCESS_GUEST loads and stores
+     * @return Guest memory, or nullptr if fastmem is disabled
+     */
+    mem::GuestVirtualMemory* guestMemory() const;
 };
 
 }  // namespace x86
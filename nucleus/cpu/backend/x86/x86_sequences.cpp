@@ -10,7 +10,12 @@
 #include "nucleus/cpu/backend/x86/x86_constants.h"
 #include "nucleus/cpu/backend/x86/x86_emitter.h"
 #include "nucleus/logger/logger.h"
+#include "nucleus/memory/memory.h"
+#include "nucleus/memory/guest_virtual/guest_virtual_memory.h"
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
 #include <unordered_map>
 
 // Helper
@@ -1130,18 +1135,232 @@ struct CTLZ_I64 : Sequence<CTLZ_I64, I<OPCODE_CTLZ, I8Op, I64Op>> {
     }
 };
 
+/**
+ * Guest memory accesses
+ * =====================
+ * Loads and stores flagged with ACCESS_GUEST take a 32-bit guest address rather than
+ * a host pointer, and are emitted as a single host access to [RBP + addr32], with RBP
+ * pinned to the guest memory base by X86Compiler::call. Each one is preceded by a 5-byte
+ * NOP, placed so that it doesn't straddle a qword boundary: Once the access faults on
+ * an unmapped page, X86Compiler::handleFault atomically replaces it by a jump into a
+ * slow path emitted out of line, which calls into the guest memory object instead.
+ */
+
+// Slow paths preserve the following volatile registers, besides the scratch RAX and RCX
+#if defined(NUCLEUS_TARGET_WINDOWS)
+static const int slowPathGprs[] = { 2, 8, 9, 10, 11 };  // {rdx, r8, r9, r10, r11}
+static const int slowPathXmms[] = { 1, 2, 3, 4, 5 };    // {xmm1, ..., xmm5}
+static const int slowPathArgs[] = { 1, 2, 8, 9 };       // {rcx, rdx, r8, r9}
+#else
+static const int slowPathGprs[] = { 2, 6, 7, 8, 9, 10, 11 };  // {rdx, rsi, rdi, r8, ..., r11}
+static const int slowPathXmms[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };  // {xmm1, ..., xmm15}
+static const int slowPathArgs[] = { 7, 6, 2, 1 };  // {rdi, rsi, rdx, rcx}
+#endif
+
+// Slow path frame: shadow space, saved XMM registers and a buffer for the accessed value
+#define SLOW_PATH_GPR_COUNT  (sizeof(slowPathGprs) / sizeof(slowPathGprs[0]))
+#define SLOW_PATH_XMM_COUNT  (sizeof(slowPathXmms) / sizeof(slowPathXmms[0]))
+#define SLOW_PATH_XMM_SAVE   0x20
+#define SLOW_PATH_BUFFER     (SLOW_PATH_XMM_SAVE + 0x10 * SLOW_PATH_XMM_COUNT)
+#define SLOW_PATH_FRAME      (SLOW_PATH_BUFFER + 0x10 + ((SLOW_PATH_GPR_COUNT & 1) ? 8 : 0))
+
+using SlowPathFunc = void(*)(mem::GuestVirtualMemory* memory, U32 addr, U08* value, U32 flags);
+
+template <Size size>
+static void slowLoad(mem::GuestVirtualMemory* memory, U32 addr, U08* value, U32 flags) {
+    if (!memory->check(addr)) {
+        logger.warning(LOG_CPU, "Read of %d bytes from unmapped address 0x%08X", U32(size), addr);
+        std::memset(value, 0, size);
+        return;
+    }
+    std::memcpy(value, memory->ptr<U08>(addr), size);
+    if (flags & ENDIAN_BIG) {
+        std::reverse(value, value + size);
+    }
+}
+
+template <Size size>
+static void slowStore(mem::GuestVirtualMemory* memory, U32 addr, U08* value, U32 flags) {
+    if (!memory->check(addr)) {
+        logger.warning(LOG_CPU, "Write of %d bytes to unmapped address 0x%08X", U32(size), addr);
+        return;
+    }
+    if (flags & ENDIAN_BIG) {
+        std::reverse(value, value + size);
+    }
+    std::memcpy(memory->ptr<U08>(addr), value, size);
+}
+
+static SlowPathFunc getSlowLoad(Size size) {
+    switch (size) {
+    case 1:  return slowLoad<1>;
+    case 2:  return slowLoad<2>;
+    case 4:  return slowLoad<4>;
+    case 8:  return slowLoad<8>;
+    default: return slowLoad<16>;
+    }
+}
+
+static SlowPathFunc getSlowStore(Size size) {
+    switch (size) {
+    case 1:  return slowStore<1>;
+    case 2:  return slowStore<2>;
+    case 4:  return slowStore<4>;
+    case 8:  return slowStore<8>;
+    default: return slowStore<16>;
+    }
+}
+
+/**
+ * Address of a guest memory access, as originally given to the LOAD/STORE instruction
+ */
+struct GuestAddress {
+    bool isConstant;
+    U32 constant;
+    Xbyak::Reg64 reg;
+
+    void load(X86Emitter& e, const Xbyak::Reg32& dest) const {
+        if (isConstant) {
+            e.mov(dest, constant);
+        } else {
+            e.mov(dest, reg.cvt32());
+        }
+    }
+};
+
+static void emitSlowPathEnter(X86Emitter& e) {
+    for (int index : slowPathGprs) {
+        e.push(Xbyak::Reg64(index));
+    }
+    e.sub(e.rsp, SLOW_PATH_FRAME);
+    for (Size k = 0; k < SLOW_PATH_XMM_COUNT; k++) {
+        e.vmovups(e.ptr[e.rsp + SLOW_PATH_XMM_SAVE + 0x10 * k], Xbyak::Xmm(slowPathXmms[k]));
+    }
+}
+
+static void emitSlowPathCall(X86Emitter& e, const GuestAddress& addr, SlowPathFunc func, U32 flags) {
+    // The address goes first, since its register might be used for other arguments
+    addr.load(e, Xbyak::Reg64(slowPathArgs[1]).cvt32());
+    e.mov(Xbyak::Reg64(slowPathArgs[0]), reinterpret_cast<size_t>(e.guestMemory()));
+    e.lea(Xbyak::Reg64(slowPathArgs[2]), e.ptr[e.rsp + SLOW_PATH_BUFFER]);
+    e.mov(Xbyak::Reg64(slowPathArgs[3]).cvt32(), flags);
+    e.mov(e.rax, reinterpret_cast<size_t>(func));
+    e.call(e.rax);
+}
+
+static void emitSlowPathLeave(X86Emitter& e) {
+    for (Size k = 0; k < SLOW_PATH_XMM_COUNT; k++) {
+        e.vmovups(Xbyak::Xmm(slowPathXmms[k]), e.ptr[e.rsp + SLOW_PATH_XMM_SAVE + 0x10 * k]);
+    }
+    e.add(e.rsp, SLOW_PATH_FRAME);
+    for (Size k = SLOW_PATH_GPR_COUNT; k > 0; k--) {
+        e.pop(Xbyak::Reg64(slowPathGprs[k - 1]));
+    }
+}
+
+/**
+ * Memory access through a host pointer or, if flagged with ACCESS_GUEST, a guest address.
+ * Sequences emit the access itself with the operand returned by `address`, and then
+ * describe the slow path with either `finishLoad` or `finishStore`.
+ */
+class MemoryAccess {
+    X86Emitter& e;
+    const Instruction* instr;
+    GuestAddress guest;
+    bool isGuest;
+    Size start;
+
+public:
+    MemoryAccess(X86Emitter& e, const Instruction* instr, const PtrOp& ptr)
+        : e(e), instr(instr), isGuest(instr->flags & ACCESS_GUEST) {
+        guest.isConstant = ptr.isConstant;
+        guest.constant = ptr.isConstant ? U32(ptr.value->constant.i64) : 0;
+        guest.reg = ptr.isConstant ? e.rcx : ptr.reg;
+        if (!isGuest) {
+            if (ptr.isConstant) {
+                e.mov(e.rcx, ptr.value->constant.i64);
+            }
+            return;
+        }
+        assert_true(e.guestMemory(), "Guest memory access emitted without fastmem support");
+
+        // Patch point: 5-byte NOP contained within a qword
+        while ((e.getSize() & 7) > 3) {
+            e.nop();
+        }
+        start = e.getSize();
+        e.db(0x0F); e.db(0x1F); e.db(0x44); e.db(0x00); e.db(0x00);
+        guest.load(e, e.ecx);
+    }
+
+    Xbyak::RegExp address() const {
+        if (isGuest) {
+            return e.rbp + e.rcx;
+        }
+        return Xbyak::RegExp(guest.reg);
+    }
+
+    /**
+     * Register the slow path of a load
+     * @param[in]  size    Size of the accessed value in bytes
+     * @param[in]  result  Emits the move of the loaded value from RAX or XMM0 to the destination
+     */
+    void finishLoad(Size size, std::function<void(X86Emitter&)> result) {
+        if (!isGuest) {
+            return;
+        }
+        const GuestAddress addr = guest;
+        const U32 flags = instr->flags;
+        e.fastmemSites.push_back({ start, e.getSize(), [=](X86Emitter& e) {
+            emitSlowPathEnter(e);
+            emitSlowPathCall(e, addr, getSlowLoad(size), flags);
+            if (size == 16) {
+                e.vmovups(e.xmm0, e.ptr[e.rsp + SLOW_PATH_BUFFER]);
+            } else {
+                e.mov(e.rax, e.qword[e.rsp + SLOW_PATH_BUFFER]);
+            }
+            emitSlowPathLeave(e);
+            result(e);
+        }});
+    }
+
+    /**
+     * Register the slow path of a store
+     * @param[in]  size   Size of the accessed value in bytes
+     * @param[in]  spill  Emits the move of the stored value into the given buffer
+     */
+    void finishStore(Size size, std::function<void(X86Emitter&, const Xbyak::RegExp&)> spill) {
+        if (!isGuest) {
+            return;
+        }
+        const GuestAddress addr = guest;
+        const U32 flags = instr->flags;
+        e.fastmemSites.push_back({ start, e.getSize(), [=](X86Emitter& e) {
+            emitSlowPathEnter(e);
+            spill(e, e.rsp + SLOW_PATH_BUFFER);
+            emitSlowPathCall(e, addr, getSlowStore(size), flags);
+            emitSlowPathLeave(e);
+        }});
+    }
+};
+
 /**
  * Opcode: LOAD
  */
 struct LOAD_I8 : Sequence<LOAD_I8, I<OPCODE_LOAD, I8Op, PtrOp>> {
     static void emit(X86Emitter& e, InstrType& i) {
-        auto addr = i.src1.reg;
+        MemoryAccess access(e, i.instr, i.src1);
+        auto addr = access.address();
         e.mov(i.dest, e.byte[addr]);
+
+        auto dest = i.dest.reg;
+        access.finishLoad(1, [=](X86Emitter& e) { e.mov(dest, e.al); });
     }
 };
 struct LOAD_I16 : Sequence<LOAD_I16, I<OPCODE_LOAD, I16Op, PtrOp>> {
     static void emit(X86Emitter& e, InstrType& i) {
-        auto addr = i.src1.reg;
+        MemoryAccess access(e, i.instr, i.src1);
+        auto addr = access.address();
         if (i.instr->flags & ENDIAN_BIG) {
             if (e.isExtensionAvailable(X86Extension::MOVBE)) {
                 e.movbe(i.dest, e.word[addr]);
@@ -1152,11 +1371,15 @@ struct LOAD_I16 : Sequence<LOAD_I16, I<OPCODE_LOAD, I16Op, PtrOp>> {
         } else {
             e.mov(i.dest, e.word[addr]);
         }
+
+        auto dest = i.dest.reg;
+        access.finishLoad(2, [=](X86Emitter& e) { e.mov(dest, e.ax); });
     }
 };
 struct LOAD_I32 : Sequence<LOAD_I32, I<OPCODE_LOAD, I32Op, PtrOp>> {
     static void emit(X86Emitter& e, InstrType& i) {
-        auto addr = i.src1.reg;
+        MemoryAccess access(e, i.instr, i.src1);
+        auto addr = access.address();
         if (i.instr->flags & ENDIAN_BIG) {
             if (e.isExtensionAvailable(X86Extension::MOVBE)) {
                 e.movbe(i.dest, e.dword[addr]);
@@ -1167,11 +1390,15 @@ struct LOAD_I32 : Sequence<LOAD_I32, I<OPCODE_LOAD, I32Op, PtrOp>> {
         } else {
             e.mov(i.dest, e.dword[addr]);
         }
+
+        auto dest = i.dest.reg;
+        access.finishLoad(4, [=](X86Emitter& e) { e.mov(dest, e.eax); });
     }
 };
 struct LOAD_I64 : Sequence<LOAD_I64, I<OPCODE_LOAD, I64Op, PtrOp>> {
     static void emit(X86Emitter& e, InstrType& i) {
-        auto addr = i.src1.reg;
+        MemoryAccess access(e, i.instr, i.src1);
+        auto addr = access.address();
         if (i.instr->flags & ENDIAN_BIG) {
             if (e.isExtensionAvailable(X86Extension::MOVBE)) {
                 e.movbe(i.dest, e.qword[addr]);
@@ -1182,11 +1409,15 @@ struct LOAD_I64 : Sequence<LOAD_I64, I<OPCODE_LOAD, I64Op, PtrOp>> {
         } else {
             e.mov(i.dest, e.qword[addr]);
         }
+
+        auto dest = i.dest.reg;
+        access.finishLoad(8, [=](X86Emitter& e) { e.mov(dest, e.rax); });
     }
 };
 struct LOAD_F32 : Sequence<LOAD_F32, I<OPCODE_LOAD, F32Op, PtrOp>> {
     static void emit(X86Emitter& e, InstrType& i) {
-        auto addr = i.src1.reg;
+        MemoryAccess access(e, i.instr, i.src1);
+        auto addr = access.address();
         if (i.instr->flags & ENDIAN_BIG) {
             if (e.isExtensionAvailable(X86Extension::MOVBE)) {
                 assert_always("Unimplemented");
@@ -1198,11 +1429,15 @@ struct LOAD_F32 : Sequence<LOAD_F32, I<OPCODE_LOAD, F32Op, PtrOp>> {
         } else {
             e.vmovss(i.dest, e.dword[addr]);
         }
+
+        auto dest = i.dest.reg;
+        access.finishLoad(4, [=](X86Emitter& e) { e.vmovd(dest, e.eax); });
     }
 };
 struct LOAD_F64 : Sequence<LOAD_F64, I<OPCODE_LOAD, F64Op, PtrOp>> {
     static void emit(X86Emitter& e, InstrType& i) {
-        auto addr = i.src1.reg;
+        MemoryAccess access(e, i.instr, i.src1);
+        auto addr = access.address();
         if (i.instr->flags & ENDIAN_BIG) {
             if (e.isExtensionAvailable(X86Extension::MOVBE)) {
                 assert_always("Unimplemented");
@@ -1214,15 +1449,19 @@ struct LOAD_F64 : Sequence<LOAD_F64, I<OPCODE_LOAD, F64Op, PtrOp>> {
         } else {
             e.vmovsd(i.dest, e.qword[addr]);
         }
+
+        auto dest = i.dest.reg;
+        access.finishLoad(8, [=](X86Emitter& e) { e.vmovq(dest, e.rax); });
     }
 };
 struct LOAD_V128 : Sequence<LOAD_V128, I<OPCODE_LOAD, V128Op, PtrOp>> {
     static void emit(X86Emitter& e, InstrType& i) {
-        if (i.src1.isConstant) {
-            e.mov(e.rax, reinterpret_cast<U64>(i.src1.constant()));
-            e.vmovups(i.dest, e.ptr[e.rax]);
+        MemoryAccess access(e, i.instr, i.src1);
+        auto addr = access.address();
+        if (i.instr->flags & ACCESS_ALIGNED) {
+            e.vmovaps(i.dest, e.ptr[addr]);
         } else {
-            e.vmovups(i.dest, e.ptr[i.src1.reg]);
+            e.vmovups(i.dest, e.ptr[addr]);
         }
         if (i.instr->flags & ENDIAN_BIG) {
             V128 byteSwapMask;
@@ -1231,6 +1470,9 @@ struct LOAD_V128 : Sequence<LOAD_V128, I<OPCODE_LOAD, V128Op, PtrOp>> {
             getXmmConstant(e, e.xmm0, byteSwapMask);
             e.vpshufb(i.dest, i.dest, e.xmm0);
         }
+
+        auto dest = i.dest.reg;
+        access.finishLoad(16, [=](X86Emitter& e) { e.vmovaps(dest, e.xmm0); });
     }
 };
 
@@ -1239,17 +1481,30 @@ struct LOAD_V128 : Sequence<LOAD_V128, I<OPCODE_LOAD, V128Op, PtrOp>> {
  */
 struct STORE_I8 : Sequence<STORE_I8, I<OPCODE_STORE, VoidOp, PtrOp, I8Op>> {
     static void emit(X86Emitter& e, InstrType& i) {
-        auto addr = i.src1.reg;
+        MemoryAccess access(e, i.instr, i.src1);
+        auto addr = access.address();
         if (i.src2.isConstant) {
             e.mov(e.byte[addr], i.src2.constant());
         } else {
             e.mov(e.byte[addr], i.src2);
         }
+
+        const bool isConstant = i.src2.isConstant;
+        const U08 constant = isConstant ? i.src2.constant() : 0;
+        auto src = i.src2.reg;
+        access.finishStore(1, [=](X86Emitter& e, const Xbyak::RegExp& buffer) {
+            if (isConstant) {
+                e.mov(e.byte[buffer], constant);
+            } else {
+                e.mov(e.byte[buffer], src);
+            }
+        });
     }
 };
 struct STORE_I16 : Sequence<STORE_I16, I<OPCODE_STORE, VoidOp, PtrOp, I16Op>> {
     static void emit(X86Emitter& e, InstrType& i) {
-        auto addr = i.src1.reg;
+        MemoryAccess access(e, i.instr, i.src1);
+        auto addr = access.address();
         if (i.instr->flags & ENDIAN_BIG) {
             assert_false(i.src2.isConstant);
             if (e.isExtensionAvailable(X86Extension::MOVBE)) {
@@ -1266,11 +1521,23 @@ struct STORE_I16 : Sequence<STORE_I16, I<OPCODE_STORE, VoidOp, PtrOp, I16Op>> {
                 e.mov(e.word[addr], i.src2);
             }
         }
+
+        const bool isConstant = i.src2.isConstant;
+        const U16 constant = isConstant ? i.src2.constant() : 0;
+        auto src = i.src2.reg;
+        access.finishStore(2, [=](X86Emitter& e, const Xbyak::RegExp& buffer) {
+            if (isConstant) {
+                e.mov(e.word[buffer], constant);
+            } else {
+                e.mov(e.word[buffer], src);
+            }
+        });
     }
 };
 struct STORE_I32 : Sequence<STORE_I32, I<OPCODE_STORE, VoidOp, PtrOp, I32Op>> {
     static void emit(X86Emitter& e, InstrType& i) {
-        auto addr = i.src1.reg;
+        MemoryAccess access(e, i.instr, i.src1);
+        auto addr = access.address();
         if (i.instr->flags & ENDIAN_BIG) {
             assert_false(i.src2.isConstant);
             if (e.isExtensionAvailable(X86Extension::MOVBE)) {
@@ -1287,11 +1554,23 @@ struct STORE_I32 : Sequence<STORE_I32, I<OPCODE_STORE, VoidOp, PtrOp, I32Op>> {
                 e.mov(e.dword[addr], i.src2);
             }
         }
+
+        const bool isConstant = i.src2.isConstant;
+        const U32 constant = isConstant ? i.src2.constant() : 0;
+        auto src = i.src2.reg;
+        access.finishStore(4, [=](X86Emitter& e, const Xbyak::RegExp& buffer) {
+            if (isConstant) {
+                e.mov(e.dword[buffer], constant);
+            } else {
+                e.mov(e.dword[buffer], src);
+            }
+        });
     }
 };
 struct STORE_I64 : Sequence<STORE_I64, I<OPCODE_STORE, VoidOp, PtrOp, I64Op>> {
     static void emit(X86Emitter& e, InstrType& i) {
-        auto addr = i.src1.reg;
+        MemoryAccess access(e, i.instr, i.src1);
+        auto addr = access.address();
         if (i.instr->flags & ENDIAN_BIG) {
             assert_false(i.src2.isConstant);
             if (e.isExtensionAvailable(X86Extension::MOVBE)) {
@@ -1308,11 +1587,24 @@ struct STORE_I64 : Sequence<STORE_I64, I<OPCODE_STORE, VoidOp, PtrOp, I64Op>> {
                 e.mov(e.qword[addr], i.src2);
             }
         }
+
+        const bool isConstant = i.src2.isConstant;
+        const U64 constant = isConstant ? i.src2.constant() : 0;
+        auto src = i.src2.reg;
+        access.finishStore(8, [=](X86Emitter& e, const Xbyak::RegExp& buffer) {
+            if (isConstant) {
+                e.mov(e.rax, constant);
+                e.mov(e.qword[buffer], e.rax);
+            } else {
+                e.mov(e.qword[buffer], src);
+            }
+        });
     }
 };
 struct STORE_F32 : Sequence<STORE_F32, I<OPCODE_STORE, VoidOp, PtrOp, F32Op>> {
     static void emit(X86Emitter& e, InstrType& i) {
-        auto addr = i.src1.reg;
+        MemoryAccess access(e, i.instr, i.src1);
+        auto addr = access.address();
         if (i.instr->flags & ENDIAN_BIG) {
             assert_false(i.src2.isConstant);
             if (e.isExtensionAvailable(X86Extension::MOVBE)) {
@@ -1329,11 +1621,23 @@ struct STORE_F32 : Sequence<STORE_F32, I<OPCODE_STORE, VoidOp, PtrOp, F32Op>> {
                 e.vmovss(e.dword[addr], i.src2);
             }
         }
+
+        const bool isConstant = i.src2.isConstant;
+        const U32 constant = isConstant ? i.src2.value->constant.i32 : 0;
+        auto src = i.src2.reg;
+        access.finishStore(4, [=](X86Emitter& e, const Xbyak::RegExp& buffer) {
+            if (isConstant) {
+                e.mov(e.dword[buffer], constant);
+            } else {
+                e.vmovss(e.dword[buffer], src);
+            }
+        });
     }
 };
 struct STORE_F64 : Sequence<STORE_F64, I<OPCODE_STORE, VoidOp, PtrOp, F64Op>> {
     static void emit(X86Emitter& e, InstrType& i) {
-        auto addr = i.src1.reg;
+        MemoryAccess access(e, i.instr, i.src1);
+        auto addr = access.address();
         if (i.instr->flags & ENDIAN_BIG) {
             assert_false(i.src2.isConstant);
             if (e.isExtensionAvailable(X86Extension::MOVBE)) {
@@ -1350,17 +1654,24 @@ struct STORE_F64 : Sequence<STORE_F64, I<OPCODE_STORE, VoidOp, PtrOp, F64Op>> {
                 e.vmovsd(e.qword[addr], i.src2);
             }
         }
+
+        const bool isConstant = i.src2.isConstant;
+        const U64 constant = isConstant ? i.src2.value->constant.i64 : 0;
+        auto src = i.src2.reg;
+        access.finishStore(8, [=](X86Emitter& e, const Xbyak::RegExp& buffer) {
+            if (isConstant) {
+                e.mov(e.rax, constant);
+                e.mov(e.qword[buffer], e.rax);
+            } else {
+                e.vmovsd(e.qword[buffer], src);
+            }
+        });
     }
 };
 struct STORE_V128 : Sequence<STORE_V128, I<OPCODE_STORE, VoidOp, PtrOp, V128Op>> {
     static void emit(X86Emitter& e, InstrType& i) {
-        Xbyak::Reg64 addr;
-        if (i.src1.isConstant) {
-            addr = e.rdx;
-            e.mov(addr, reinterpret_cast<U64>(i.src1.constant()));
-        } else {
-            addr = i.src1.reg;
-        }
+        MemoryAccess access(e, i.instr, i.src1);
+        auto addr = access.address();
         if (i.instr->flags & ENDIAN_BIG) {
             assert_false(i.src2.isConstant);
             V128 byteSwapMask;
@@ -1379,7 +1690,20 @@ struct STORE_V128 : Sequence<STORE_V128, I<OPCODE_STORE, VoidOp, PtrOp, V128Op>>
                 e.vmovaps(e.ptr[addr], i.src2);
             }
         }
-        // TODO: Restore rdx
+
+        const bool isConstant = i.src2.isConstant;
+        const V128 constant = isConstant ? i.src2.constant() : V128();
+        auto src = i.src2.reg;
+        access.finishStore(16, [=](X86Emitter& e, const Xbyak::RegExp& buffer) {
+            if (isConstant) {
+                e.mov(e.rax, constant.u64[0]);
+                e.mov(e.qword[buffer + 0], e.rax);
+                e.mov(e.rax, constant.u64[1]);
+                e.mov(e.qword[buffer + 8], e.rax);
+            } else {
+                e.vmovups(e.ptr[buffer], src);
+            }
+        });
     }
 };
 
@@ -1829,7 +2153,7 @@ struct CALL_VOID : Sequence<CALL_VOID, I<OPCODE_CALL, VoidOp, FunctionOp>> {
     static void emit(X86Emitter& e, InstrType& i) {
         const Function* target = i.src1.function;
         if (i.instr->flags & CALL_EXTERN) {
-            e.mov(e.rax, reinterpret_cast<size_t>(target->nativeAddress));
+            e.mov(e.rax, reinterpret_cast<size_t>(target->nativeAddress.load(std::memory_order_acquire)));
             e.call(e.rax);
         } else {
             if (e.settings().isJIT) {
@@ -1837,7 +2161,7 @@ struct CALL_VOID : Sequence<CALL_VOID, I<OPCODE_CALL, VoidOp, FunctionOp>> {
                 e.mov(e.rax, e.qword[e.rax + offsetof(hir::Function, nativeAddress)]);
                 e.call(e.rax);
             } else {
-                e.mov(e.rax, reinterpret_cast<size_t>(target->nativeAddress));
+                e.mov(e.rax, reinterpret_cast<size_t>(target->nativeAddress.load(std::memory_order_acquire)));
                 e.call(e.rax);
             }
         }
@@ -1847,7 +2171,7 @@ struct CALL_I8 : Sequence<CALL_I8, I<OPCODE_CALL, I8Op, FunctionOp>> {
     static void emit(X86Emitter& e, InstrType& i) {
         const Function* target = i.src1.function;
         if (i.instr->flags & CALL_EXTERN) {
-            e.mov(e.rax, reinterpret_cast<size_t>(target->nativeAddress));
+            e.mov(e.rax, reinterpret_cast<size_t>(target->nativeAddress.load(std::memory_order_acquire)));
             e.call(e.rax);
         } else {
             if (e.settings().isJIT) {
@@ -1855,7 +2179,7 @@ struct CALL_I8 : Sequence<CALL_I8, I<OPCODE_CALL, I8Op, FunctionOp>> {
                 e.mov(e.rax, e.qword[e.rax + offsetof(hir::Function, nativeAddress)]);
                 e.call(e.rax);
             } else {
-                e.mov(e.rax, reinterpret_cast<size_t>(target->nativeAddress));
+                e.mov(e.rax, reinterpret_cast<size_t>(target->nativeAddress.load(std::memory_order_acquire)));
                 e.call(e.rax);
             }
         }
@@ -1867,7 +2191,7 @@ struct CALL_I16 : Sequence<CALL_I16, I<OPCODE_CALL, I16Op, FunctionOp>> {
     static void emit(X86Emitter& e, InstrType& i) {
         const Function* target = i.src1.function;
         if (i.instr->flags & CALL_EXTERN) {
-            e.mov(e.rax, reinterpret_cast<size_t>(target->nativeAddress));
+            e.mov(e.rax, reinterpret_cast<size_t>(target->nativeAddress.load(std::memory_order_acquire)));
             e.call(e.rax);
         } else {
             if (e.settings().isJIT) {
@@ -1875,7 +2199,7 @@ struct CALL_I16 : Sequence<CALL_I16, I<OPCODE_CALL, I16Op, FunctionOp>> {
                 e.mov(e.rax, e.qword[e.rax + offsetof(hir::Function, nativeAddress)]);
                 e.call(e.rax);
             } else {
-                e.mov(e.rax, reinterpret_cast<size_t>(target->nativeAddress));
+                e.mov(e.rax, reinterpret_cast<size_t>(target->nativeAddress.load(std::memory_order_acquire)));
                 e.call(e.rax);
             }
         }
@@ -1887,7 +2211,7 @@ struct CALL_I32 : Sequence<CALL_I32, I<OPCODE_CALL, I32Op, FunctionOp>> {
     static void emit(X86Emitter& e, InstrType& i) {
         const Function* target = i.src1.function;
         if (i.instr->flags & CALL_EXTERN) {
-            e.mov(e.rax, reinterpret_cast<size_t>(target->nativeAddress));
+            e.mov(e.rax, reinterpret_cast<size_t>(target->nativeAddress.load(std::memory_order_acquire)));
             e.call(e.rax);
         } else {
             if (e.settings().isJIT) {
@@ -1895,7 +2219,7 @@ struct CALL_I32 : Sequence<CALL_I32, I<OPCODE_CALL, I32Op, FunctionOp>> {
                 e.mov(e.rax, e.qword[e.rax + offsetof(hir::Function, nativeAddress)]);
                 e.call(e.rax);
             } else {
-                e.mov(e.rax, reinterpret_cast<size_t>(target->nativeAddress));
+                e.mov(e.rax, reinterpret_cast<size_t>(target->nativeAddress.load(std::memory_order_acquire)));
                 e.call(e.rax);
             }
         }
@@ -1907,7 +2231,7 @@ struct CALL_I64 : Sequence<CALL_I64, I<OPCODE_CALL, I64Op, FunctionOp>> {
     static void emit(X86Emitter& e, InstrType& i) {
         const Function* target = i.src1.function;
         if (i.instr->flags & CALL_EXTERN) {
-            e.mov(e.rax, reinterpret_cast<size_t>(target->nativeAddress));
+            e.mov(e.rax, reinterpret_cast<size_t>(target->nativeAddress.load(std::memory_order_acquire)));
             e.call(e.rax);
         } else {
             if (e.settings().isJIT) {
@@ -1915,7 +2239,7 @@ struct CALL_I64 : Sequence<CALL_I64, I<OPCODE_CALL, I64Op, FunctionOp>> {
                 e.mov(e.rax, e.qword[e.rax + offsetof(hir::Function, nativeAddress)]);
                 e.call(e.rax);
             } else {
-                e.mov(e.rax, reinterpret_cast<size_t>(target->nativeAddress));
+                e.mov(e.rax, reinterpret_cast<size_t>(target->nativeAddress.load(std::memory_order_acquire)));
                 e.call(e.rax);
             }
         }
@@ -5,13 +5,20 @@
 
 #include "cpu_guest.h"
 #include "nucleus/cpu/thread.h"
+#include "nucleus/core/config.h"
 #include "nucleus/cpu/hir/passes.h"
 #include "nucleus/logger/logger.h"
+#include "nucleus/memory/guest_virtual/guest_virtual_memory.h"
 
 // Backends
+#if defined(NUCLEUS_ARCH_X86)
 #include "nucleus/cpu/backend/x86/x86_compiler.h"
+#elif defined(NUCLEUS_ARCH_ARM)
+#include "nucleus/cpu/backend/arm/arm_compiler.h"
+#endif
 
 // Frontends
+#include "nucleus/cpu/frontend/ppu/ppu_state.h"
 #include "nucleus/cpu/frontend/ppu/ppu_thread.h"
 #include "nucleus/cpu/frontend/spu/spu_thread.h"
 
@@ -32,6 +39,30 @@ GuestCPU::GuestCPU(std::shared_ptr<mem::Memory> memory) : memory(std::move(memor
 
     // Compiler passes
     compiler->addPass(std::make_unique<hir::passes::RegisterAllocationPass>(compiler->targetInfo));
+
+    // Self-modifying code detection
+    auto* guestMemory = dynamic_cast<mem::GuestVirtualMemory*>(this->memory.get());
+    if (guestMemory) {
+        guestMemory->setCodeWriteCallback([this](U32 addr, U32 size) {
+            invalidateCode(addr, size);
+        });
+
+        // Attribute guest allocations to the code that called into the system
+        guestMemory->setCallerCallback([]() -> U32 {
+            auto* thread = dynamic_cast<frontend::ppu::PPUThread*>(getCurrentThread());
+            return thread ? static_cast<U32>(thread->state->lr) : 0;
+        });
+
+#if defined(NUCLEUS_ARCH_X86)
+        // Translated code accesses guest memory through a pinned base register
+        if (config.fastmem) {
+            compiler->guestMemory = guestMemory;
+        }
+#endif
+    }
+    if (config.fastmem && !compiler->guestMemory) {
+        logger.warning(LOG_CPU, "Fastmem is not supported by this backend or memory, ignoring --fastmem");
+    }
 }
 
 Thread* GuestCPU::addThread(ThreadType type) {
@@ -66,6 +97,50 @@ void GuestCPU::removeThread(Thread* thread) {
         threads.end());
 }
 
+void GuestCPU::registerCode(hir::Function* function, U32 addr, U32 size) {
+    auto* guestMemory = dynamic_cast<mem::GuestVirtualMemory*>(memory.get());
+    if (!guestMemory || size == 0) {
+        return;
+    }
+
+    // Stale translations of these pages must be dropped before tracking the new one
+    guestMemory->flushCodeWrites();
+
+    std::lock_guard<std::mutex> lock(codeMutex);
+    const U32 first = addr >> GUEST_PAGE_SHIFT;
+    const U32 last = (addr + size - 1) >> GUEST_PAGE_SHIFT;
+    for (U32 page = first; page <= last; page++) {
+        auto range = codePages.equal_range(page);
+        auto it = std::find_if(range.first, range.second, [&](const auto& item) {
+            return item.second == function;
+        });
+        if (it == range.second) {
+            codePages.emplace(page, function);
+        }
+    }
+    guestMemory->protectCode(addr, size);
+}
+
+void GuestCPU::invalidateCode(U32 addr, U32 size) {
+    std::lock_guard<std::mutex> lock(codeMutex);
+    const U32 first = addr >> GUEST_PAGE_SHIFT;
+    const U32 last = (addr + size - 1) >> GUEST_PAGE_SHIFT;
+    for (U32 page = first; page <= last; page++) {
+        auto range = codePages.equal_range(page);
+        for (auto it = range.first; it != range.second; it++) {
+            it->second->invalidate();
+        }
+        codePages.erase(range.first, range.second);
+    }
+}
+
+void GuestCPU::flushCodeWrites() {
+    auto* guestMemory = dynamic_cast<mem::GuestVirtualMemory*>(memory.get());
+    if (guestMemory) {
+        guestMemory->flushCodeWrites();
+    }
+}
+
 Thread* GuestCPU::getCurrentThread() {
     return gCurrentThread;
 }
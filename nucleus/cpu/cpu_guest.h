@@ -6,6 +6,9 @@
 #pragma once
 
 #include "cpu.h"
+#include "nucleus/cpu/hir/function.h"
+
+#include <unordered_map>
 
 namespace cpu {
 
@@ -19,6 +22,10 @@ public:
 
     std::vector<Thread*> threads;
 
+    // Translated functions indexed by the guest pages they were generated from
+    std::mutex codeMutex;
+    std::unordered_multimap<U32, hir::Function*> codePages;
+
     // Constructor
     GuestCPU(std::shared_ptr<mem::Memory> memory);
 
@@ -26,6 +33,30 @@ public:
     Thread* addThread(ThreadType type);
     void removeThread(Thread* thread);
 
+    /**
+     * Track the guest code a compiled function was generated from, write-protecting
+     * the pages that hold it so that any later modification invalidates the function
+     * @param[in]  function  Compiled function
+     * @param[in]  addr      Guest address of the code
+     * @param[in]  size      Number of bytes of guest code
+     */
+    void registerCode(hir::Function* function, U32 addr, U32 size);
+
+    /**
+     * Invalidate all functions generated from guest code in the given range.
+     * Called after a write to a protected page, once the memory flushes it.
+     * @param[in]  addr      Guest address of the modified range
+     * @param[in]  size      Number of bytes in the modified range
+     */
+    void invalidateCode(U32 addr, U32 size);
+
+    /**
+     * Invalidate the functions whose guest code was written since the last call.
+     * Writes are only recorded by the fault handler, so threads call this before
+     * looking up, translating or resuming guest code.
+     */
+    void flushCodeWrites();
+
     // Manage current thread
     static Thread* getCurrentThread();
     static void setCurrentThread(Thread* thread);
@@ -26,7 +26,7 @@ public:
     Module<TAddr>* parent;
 
     // HIR Function
-    hir::Function* hirFunction;
+    hir::Function* hirFunction = nullptr;
 
     // Starting address of the entry block
     TAddr address = 0;
@@ -50,6 +50,14 @@ public:
         }
         return false;
     }
+
+    // Release the CFG blocks, so that the function can be analyzed again
+    void clearBlocks() {
+        for (auto& item : blocks) {
+            delete item.second;
+        }
+        blocks.clear();
+    }
 };
 
 }  // namespace frontend
@@ -244,6 +244,7 @@ void Function::declare()
 
     // Declare function in module
     hirFunction = new hir::Function(hirModule, result, params);
+    hirFunction->name = format("ppu_%08X", address);
 }
 
 void Function::recompile()
@@ -331,6 +332,7 @@ Function* Module::addFunction(U32 addr)
     function->declare();
     function->createPlaceholder();
     parent->compiler->compile(function->hirFunction);
+    function->hirFunction->stubAddress = function->hirFunction->nativeAddress.load();
 
     // Save and return the function
     functions[addr] = function;
@@ -8,6 +8,7 @@
 #include "nucleus/cpu/cell.h"
 #include "nucleus/cpu/frontend/ppu/ppu_state.h"
 #include "nucleus/cpu/frontend/ppu/ppu_decoder.h"
+#include "nucleus/memory/reservation.h"
 
 namespace cpu {
 namespace frontend {
@@ -58,6 +59,7 @@ void PPUThread::task() {
         }
     }
     if (config.ppuTranslator & CPU_TRANSLATOR_FUNCTION) {
+        parent->flushCodeWrites();
         for (auto* ppu_segment : static_cast<Cell*>(parent)->ppu_modules) {
             if (!ppu_segment->contains(state->pc)) {
                 continue;
@@ -102,6 +104,53 @@ void PPUThread::stop()
     m_event = NUCLEUS_EVENT_STOP;
 }
 
+U64 PPUThread::loadReserved(U32 addr, U32 size) {
+    const auto& memory = parent->memory;
+    auto& reservations = memory->getReservations();
+
+    // Retry if a store completed while reading the value
+    U64 version;
+    U64 value;
+    do {
+        version = reservations.acquire(addr);
+        value = (size == 8) ? memory->read64(addr) : memory->read32(addr);
+    } while (!reservations.check(addr, version));
+
+    reservation.addr = addr;
+    reservation.version = version;
+    reservation.value = value;
+    reservation.valid = true;
+    return value;
+}
+
+bool PPUThread::storeConditional(U32 addr, U64 value, U32 size) {
+    const auto& memory = parent->memory;
+    auto& reservations = memory->getReservations();
+
+    if (!reservation.valid || reservation.addr != addr) {
+        reservation.valid = false;
+        return false;
+    }
+    reservation.valid = false;
+    if (!reservations.lock(addr, reservation.version)) {
+        return false;
+    }
+
+    // Plain stores do not update the line version, so compare the reserved value as well
+    const U64 current = (size == 8) ? memory->read64(addr) : memory->read32(addr);
+    if (current != reservation.value) {
+        reservations.unlock(addr, false);
+        return false;
+    }
+    if (size == 8) {
+        memory->write64(addr, value);
+    } else {
+        memory->write32(addr, static_cast<U32>(value));
+    }
+    reservations.unlock(addr);
+    return true;
+}
+
 }  // namespace ppu
 }  // namespace frontend
 }  // namespace cpu
@@ -29,6 +29,31 @@ public:
     virtual void run() override;
     virtual void pause() override;
     virtual void stop() override;
+
+    // Lock-line reservation taken by lwarx/ldarx
+    struct {
+        U32 addr;
+        U64 version;
+        U64 value;
+        bool valid = false;
+    } reservation;
+
+    /**
+     * Load a value and take a reservation on its lock line (lwarx/ldarx)
+     * @param[in]  addr  Guest address
+     * @param[in]  size  Size of the value in bytes (4 or 8)
+     * @return           Loaded value
+     */
+    U64 loadReserved(U32 addr, U32 size);
+
+    /**
+     * Store a value if the reservation taken at the same address still holds (stwcx./stdcx.)
+     * @param[in]  addr   Guest address
+     * @param[in]  value  Value to be stored
+     * @param[in]  size   Size of the value in bytes (4 or 8)
+     * @return            True if the value was stored
+     */
+    bool storeConditional(U32 addr, U64 value, U32 size);
 };
 
 }  // namespace ppu
@@ -4,6 +4,7 @@
  */
 
 #include "ppu_translator.h"
+#include "nucleus/cpu/backend/compiler.h"
 #include "nucleus/cpu/frontend/ppu/ppu_state.h"
 #include "nucleus/memory/memory.h"
 #include "nucleus/core/config.h"
@@ -370,27 +371,32 @@ void Translator::setFPSCR(Value* value) {
  * Memory access
  */
 Value* Translator::readMemory(hir::Value* addr, hir::Type type) {
+    const MemoryFlags flags = (type == TYPE_I8) ? ENDIAN_DEFAULT : ENDIAN_BIG;
+
+    // Fastmem: The backend accesses guest addresses relative to the pinned memory base, if it supports it
+    if (parent->compiler->guestMemory) {
+        return builder.createLoad(addr, type, MemoryFlags(flags | ACCESS_GUEST));
+    }
+
     // Get host address
     void* baseAddress = parent->memory->getBaseAddr();
     addr = builder.createAdd(addr, builder.getConstantPointer(baseAddress));
-
-    if (type == TYPE_I8) {
-        return builder.createLoad(addr, type);
-    } else {
-        return builder.createLoad(addr, type, ENDIAN_BIG);
-    }
+    return builder.createLoad(addr, type, flags);
 }
 
 void Translator::writeMemory(Value* addr, Value* value) {
+    const MemoryFlags flags = (value->type == TYPE_I8) ? ENDIAN_DEFAULT : ENDIAN_BIG;
+
+    // Fastmem: The backend accesses guest addresses relative to the pinned memory base, if it supports it
+    if (parent->compiler->guestMemory) {
+        builder.createStore(addr, value, MemoryFlags(flags | ACCESS_GUEST));
+        return;
+    }
+
     // Get host address
     void* baseAddress = parent->memory->getBaseAddr();
     addr = builder.createAdd(addr, builder.getConstantPointer(baseAddress));
-
-    if (value->type == TYPE_I8) {
-        builder.createStore(addr, value);
-    } else {
-        builder.createStore(addr, value, ENDIAN_BIG);
-    }
+    builder.createStore(addr, value, flags);
 }
 
 /**
@@ -4,6 +4,7 @@
  */
 
 #include "ppu_translator.h"
+#include "nucleus/cpu/frontend/ppu/ppu_thread.h"
 #include "nucleus/assert.h"
 
 namespace cpu {
@@ -12,6 +13,29 @@ namespace ppu {
 
 using namespace cpu::hir;
 
+/**
+ * Reservation helpers called from translated code
+ */
+static U32 loadReserved32(U64 addr) {
+    auto& thread = *static_cast<PPUThread*>(CPU::getCurrentThread());
+    return static_cast<U32>(thread.loadReserved(static_cast<U32>(addr), 4));
+}
+
+static U64 loadReserved64(U64 addr) {
+    auto& thread = *static_cast<PPUThread*>(CPU::getCurrentThread());
+    return thread.loadReserved(static_cast<U32>(addr), 8);
+}
+
+static U08 storeConditional32(U64 addr, U32 value) {
+    auto& thread = *static_cast<PPUThread*>(CPU::getCurrentThread());
+    return thread.storeConditional(static_cast<U32>(addr), value, 4) ? 1 : 0;
+}
+
+static U08 storeConditional64(U64 addr, U64 value) {
+    auto& thread = *static_cast<PPUThread*>(CPU::getCurrentThread());
+    return thread.storeConditional(static_cast<U32>(addr), value, 8) ? 1 : 0;
+}
+
 /**
  * PPC64 Instructions:
  *  - UISA: Load and Store Instructions (Section: 4.2.3)
@@ -101,9 +125,9 @@ void Translator::ldarx(Instruction code)
         addr = builder.createAdd(addr, ra);
     }
 
-    // TODO: Reservation
-
-    rd = readMemory(addr, TYPE_I64);
+    hir::Function* loadFunc = builder.getExternFunction(
+        reinterpret_cast<void*>(loadReserved64), TYPE_I64, { TYPE_I64 });
+    rd = builder.createCall(loadFunc, { addr }, CALL_EXTERN);
     setGPR(code.rd, rd);
 }
 
@@ -410,9 +434,9 @@ void Translator::lwarx(Instruction code)
         addr = builder.createAdd(addr, ra);
     }
 
-    // TODO: Reservation
-
-    rd = readMemory(addr, TYPE_I32);
+    hir::Function* loadFunc = builder.getExternFunction(
+        reinterpret_cast<void*>(loadReserved32), TYPE_I32, { TYPE_I64 });
+    rd = builder.createCall(loadFunc, { addr }, CALL_EXTERN);
     setGPR(code.rd, rd);
 }
 
@@ -570,12 +594,11 @@ void Translator::stdcx_(Instruction code)
         addr = builder.createAdd(addr, ra);
     }
 
-    // TODO: Reservation
-
-    // TODO: Is this correct?
-    setCRField(0, builder.getConstantI8(2));
-
-    writeMemory(addr, rs);
+    // CR0 gets the EQ bit set only if the store was performed
+    hir::Function* storeFunc = builder.getExternFunction(
+        reinterpret_cast<void*>(storeConditional64), TYPE_I8, { TYPE_I64, TYPE_I64 });
+    Value* success = builder.createCall(storeFunc, { addr, rs }, CALL_EXTERN);
+    setCRField(0, builder.createShl(success, U08(1)));
 }
 
 void Translator::stdu(Instruction code)
@@ -812,12 +835,11 @@ void Translator::stwcx_(Instruction code)
         addr = builder.createAdd(addr, ra);
     }
 
-    // TODO: Reservation
-
-    // TODO: Is this correct?
-    setCRField(0, builder.getConstantI8(2));
-
-    writeMemory(addr, rs);
+    // CR0 gets the EQ bit set only if the store was performed
+    hir::Function* storeFunc = builder.getExternFunction(
+        reinterpret_cast<void*>(storeConditional32), TYPE_I8, { TYPE_I64, TYPE_I32 });
+    Value* success = builder.createCall(storeFunc, { addr, rs }, CALL_EXTERN);
+    setCRField(0, builder.createShl(success, U08(1)));
 }
 
 void Translator::stwu(Instruction code)
@@ -22,7 +22,8 @@ namespace ppu {
         reinterpret_cast<void*>( \
         reinterpret_cast<uintptr_t>( \
         static_cast<void(*)(Instruction)>([](Instruction o) { \
-            auto& state = *static_cast<frontend::ppu::PPUThread*>(CPU::getCurrentThread())->state.get(); \
+            auto& thread = *static_cast<frontend::ppu::PPUThread*>(CPU::getCurrentThread()); \
+            auto& state = *thread.state.get(); \
             func \
         }))), \
     TYPE_VOID, { TYPE_I32 }), { builder.getConstantI32(code.value) });
@@ -35,6 +36,27 @@ inline U08 rotl8 (const U08 x, const U08 n) { return (x << n) | (x >> (8 - n));
 
 using namespace cpu::hir;
 
+/**
+ * Generate the byte shuffle moving the bytes that lvlx/lvrx load from an aligned 16-byte line
+ * to their position in the register, given the offset of the address within the line.
+ * Byte i of the host register selects byte `first + i - offset` of the line, and indices
+ * outside [0, 15] select zero, since SHUFFLE only keeps their lower 5 bits and bit 4 picks
+ * the zero operand. Indices are XORed with 3, as SHUFFLE takes them in big-endian word order.
+ */
+static Value* createPartialLoadMask(Builder& builder, Value* offset, U08 first)
+{
+    V128 indices;
+    for (U32 i = 0; i < 16; i++) {
+        indices.u8[i] = U08(first + i);
+    }
+    Value* offsets = builder.createMul(offset, builder.getConstantI64(0x0101010101010101ULL));
+    Value* splat = builder.getConstantV128(V128::from_u8(0x00));
+    splat = builder.createInsert(splat, builder.getConstantI8(0), offsets);
+    splat = builder.createInsert(splat, builder.getConstantI8(1), offsets);
+    Value* mask = builder.createVSub(builder.getConstantV128(indices), splat, COMPONENT_I8);
+    return builder.createXor(mask, builder.getConstantV128(V128::from_u8(0x03)));
+}
+
 /**
  * PPC64 Vector/SIMD Instructions (aka AltiVec):
  *  - Vector UISA Instructions (Section: 4.2.x)
@@ -76,26 +98,52 @@ void Translator::lvewx(Instruction code)
 
 void Translator::lvlx(Instruction code)
 {
-    INTERPRET({
-    });
+    Value* ra = getGPR(code.ra);
+    Value* rb = getGPR(code.rb);
+    Value* vd;
+
+    Value* addr = rb;
+    if (code.ra) {
+        addr = builder.createAdd(addr, ra);
+    }
+
+    // Load the line containing the address and shift its bytes to the left
+    Value* offset = builder.createAnd(addr, builder.getConstantI64(0xF));
+    Value* line = readMemory(builder.createAnd(addr, builder.getConstantI64(~0xFULL)), TYPE_V128);
+    Value* mask = createPartialLoadMask(builder, offset, 0);
+    vd = builder.createShuffle(mask, line, builder.getConstantV128(V128::from_u8(0x00)));
+    setVR(code.vd, vd);
 }
 
 void Translator::lvlxl(Instruction code)
 {
-    INTERPRET({
-    });
+    lvlx(code);
 }
 
 void Translator::lvrx(Instruction code)
 {
-    INTERPRET({
-    });
+    Value* ra = getGPR(code.ra);
+    Value* rb = getGPR(code.rb);
+    Value* vd;
+
+    Value* addr = rb;
+    if (code.ra) {
+        addr = builder.createAdd(addr, ra);
+    }
+
+    // Load the line preceding the address and shift its bytes to the right.
+    // Aligned addresses load nothing, so the previous line is read to avoid touching the next page.
+    Value* offset = builder.createAnd(addr, builder.getConstantI64(0xF));
+    Value* lineAddr = builder.createSub(addr, builder.getConstantI64(1));
+    Value* line = readMemory(builder.createAnd(lineAddr, builder.getConstantI64(~0xFULL)), TYPE_V128);
+    Value* mask = createPartialLoadMask(builder, offset, 16);
+    vd = builder.createShuffle(mask, line, builder.getConstantV128(V128::from_u8(0x00)));
+    setVR(code.vd, vd);
 }
 
 void Translator::lvrxl(Instruction code)
 {
-    INTERPRET({
-    });
+    lvrx(code);
 }
 
 void Translator::lvsl(Instruction code)
@@ -163,26 +211,31 @@ void Translator::stvewx(Instruction code)
 
 void Translator::stvlx(Instruction code)
 {
+    // Partial stores must not write the rest of the line, which might be modified concurrently
     INTERPRET({
+        const U32 addr = o.ra ? state.r[o.ra] + state.r[o.rb] : state.r[o.rb];
+        const U32 offset = addr & 0xF;
+        thread.parent->memory->writeLeft(addr, &state.v[o.vs].u8[offset], 16 - offset);
     });
 }
 
 void Translator::stvlxl(Instruction code)
 {
-    INTERPRET({
-    });
+    stvlx(code);
 }
 
 void Translator::stvrx(Instruction code)
 {
     INTERPRET({
+        const U32 addr = o.ra ? state.r[o.ra] + state.r[o.rb] : state.r[o.rb];
+        const U32 offset = addr & 0xF;
+        thread.parent->memory->writeRight(addr - offset, &state.v[o.vs].u8[0], offset);
     });
 }
 
 void Translator::stvrxl(Instruction code)
 {
-    INTERPRET({
-    });
+    stvrx(code);
 }
 
 void Translator::stvx(Instruction code)
@@ -0,0 +1,108 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "spu_analyzer.h"
+#include "nucleus/memory/memory.h"
+#include "nucleus/cpu/frontend/spu/spu_decoder.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace cpu {
+namespace frontend {
+namespace spu {
+
+Instruction Analyzer::read(U32 addr) const {
+    Instruction instr;
+    instr.value = module->parent->memory->read32(addr);
+    return instr;
+}
+
+void Analyzer::analyze() {
+    hints.clear();
+    labelBlocks.clear();
+    labelCalls.clear();
+    labelJumps.clear();
+
+    // Branch hints need to be known before any branch is classified
+    for (U32 i = module->address; i < (module->address + module->size); i += 4) {
+        const Instruction instr = read(i);
+        if (!instr.is_hint()) {
+            continue;
+        }
+        const U32 branch = instr.get_hint_branch(i);
+        const U32 target = instr.get_hint_target(i);
+        if (target && module->contains(branch) && module->contains(target) && read(branch).is_branch()) {
+            hints[branch] = target;
+        }
+    }
+
+    // Basic Block Slicing
+    U32 currentBlock = 0;
+    for (U32 i = module->address; i < (module->address + module->size); i += 4) {
+        const Instruction instr = read(i);
+
+        // New block appeared
+        if (currentBlock == 0 && instr.is_valid()) {
+            currentBlock = i;
+        }
+
+        // Block is corrupt
+        if (currentBlock != 0 && !instr.is_valid()) {
+            currentBlock = 0;
+        }
+
+        // Function call detected
+        if (currentBlock != 0 && instr.is_call()) {
+            const U32 target = getTarget(i);
+            if (target) {
+                labelCalls.insert(target);
+            }
+        }
+
+        // Block finished
+        if (currentBlock != 0 && instr.is_branch() && !instr.is_call()) {
+            const U32 target = getTarget(i);
+            if (target) {
+                labelJumps.insert(target);
+            }
+            if (instr.is_branch_conditional()) {
+                labelJumps.insert(i + 4);
+            }
+            labelBlocks.insert(currentBlock);
+            currentBlock = 0;
+        }
+    }
+}
+
+U32 Analyzer::getTarget(U32 addr) const {
+    const Instruction instr = read(addr);
+    if (instr.is_call_known() || instr.is_jump_known()) {
+        return instr.get_target(addr);
+    }
+    if (instr.is_return()) {
+        return 0;
+    }
+    const auto it = hints.find(addr);
+    if (it != hints.end()) {
+        return it->second;
+    }
+    return 0;
+}
+
+std::set<U32> Analyzer::getFunctions() const {
+    // Functions := ((Blocks \ Jumps) U Calls)
+    std::set<U32> labelFunctions = labelCalls;
+    std::set_difference(labelBlocks.begin(), labelBlocks.end(), labelJumps.begin(), labelJumps.end(), std::inserter(labelFunctions, labelFunctions.end()));
+
+    for (auto it = labelFunctions.begin(); it != labelFunctions.end();) {
+        it = module->contains(*it) ? std::next(it) : labelFunctions.erase(it);
+    }
+    return labelFunctions;
+}
+
+}  // namespace spu
+}  // namespace frontend
+}  // namespace cpu
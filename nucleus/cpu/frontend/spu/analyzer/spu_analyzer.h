@@ -0,0 +1,70 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+#include "nucleus/cpu/frontend/spu/spu_instruction.h"
+
+#include <map>
+#include <set>
+
+namespace cpu {
+namespace frontend {
+namespace spu {
+
+// Forward declarations
+class Module;
+
+/**
+ * SPU local-store analyzer.
+ * SPU programs are small and self-contained, so the whole segment is swept once,
+ * collecting the branch hints left by the compiler, which are the only static
+ * source of information about the targets of indirect branches (bi, bisl, ...).
+ */
+class Analyzer {
+    Module* module;
+
+    // Read an instruction from the local storage
+    Instruction read(U32 addr) const;
+
+public:
+    // Branch hints: Address of the branch instruction -> Predicted target
+    std::map<U32, U32> hints;
+
+    // Detected immediately after a branch or an invalid instruction
+    std::set<U32> labelBlocks;
+
+    // Direct target of a {brsl, brasl} or hinted target of a {bisl, bisled} instruction (call)
+    std::set<U32> labelCalls;
+
+    // Direct or hinted target of any other branch instruction (jump)
+    std::set<U32> labelJumps;
+
+    Analyzer(Module* module) : module(module) {}
+
+    /**
+     * Sweep the segment gathering branch hints and labels
+     */
+    void analyze();
+
+    /**
+     * Get the statically known target of a branch instruction, using branch hints if needed
+     * @param[in]  addr  Address of the branch instruction
+     * @return           Target address, or 0 if it can only be determined at runtime
+     */
+    U32 getTarget(U32 addr) const;
+
+    /**
+     * Get the entry points of the functions found in the segment,
+     * i.e. ((Blocks \ Jumps) U Calls) restricted to the segment
+     * @return  Sorted set of function addresses
+     */
+    std::set<U32> getFunctions() const;
+};
+
+}  // namespace spu
+}  // namespace frontend
+}  // namespace cpu
@@ -0,0 +1,155 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "spu_interpreter.h"
+#include "nucleus/core/config.h"
+#include "nucleus/cpu/cpu.h"
+#include "nucleus/cpu/frontend/spu/spu_decoder.h"
+#include "nucleus/cpu/frontend/spu/spu_state.h"
+#include "nucleus/cpu/frontend/spu/spu_tables.h"
+#include "nucleus/cpu/frontend/spu/spu_thread.h"
+#include "nucleus/cpu/hir/function.h"
+#include "nucleus/logger/logger.h"
+#include "nucleus/assert.h"
+
+namespace cpu {
+namespace frontend {
+namespace spu {
+
+// Local storage
+#define SPU_LS_SIZE   0x40000
+#define SPU_LS_MASK   (SPU_LS_SIZE - 1)
+#define SPU_LS_WORDS  (SPU_LS_SIZE / 4)
+
+Interpreter::Interpreter(CPU* parent, SPUThread* thread)
+    : parent(parent), thread(thread), state(*thread->state.get()) {
+    memoryBase = static_cast<U08*>(parent->memory->getBaseAddr());
+
+    cache = std::make_unique<DecodedInstruction[]>(SPU_LS_WORDS);
+    invalidate(0, SPU_LS_SIZE);
+}
+
+Interpreter::~Interpreter() {
+}
+
+void Interpreter::invalidate(U32 lsAddr, U32 size) {
+    const U32 first = (lsAddr & SPU_LS_MASK) / 4;
+    const U32 count = (size + (lsAddr & 3) + 3) / 4;
+    for (U32 i = 0; i < count && i < SPU_LS_WORDS; i++) {
+        auto& entry = cache[(first + i) % SPU_LS_WORDS];
+        entry.handler = &Interpreter::decode;
+        entry.code.value = 0;
+    }
+}
+
+void Interpreter::decode(Instruction) {
+    Instruction code;
+    code.value = SE32(*reinterpret_cast<U32*>(&memoryBase[currentAddress]));
+
+    const auto& entry = get_entry(code);
+    if (entry.type != ENTRY_INSTRUCTION || !entry.interpret) {
+        logger.error(LOG_CPU, "SPU: Invalid instruction 0x%08X at 0x%08X", code.value, currentAddress);
+        halt();
+        return;
+    }
+
+    auto& decoded = cache[(currentAddress & SPU_LS_MASK) / 4];
+    decoded.handler = entry.interpret;
+    decoded.code = code;
+    (this->*decoded.handler)(code);
+}
+
+/**
+ * Memory access
+ */
+V128 Interpreter::readMemory(U32 lsAddr) {
+    const U32 addr = (currentAddress & ~SPU_LS_MASK) | (lsAddr & (SPU_LS_MASK & ~0xF));
+    const U64* data = reinterpret_cast<const U64*>(&memoryBase[addr]);
+
+    V128 value;
+    value.u64[1] = SE64(data[0]);
+    value.u64[0] = SE64(data[1]);
+    return value;
+}
+
+void Interpreter::writeMemory(U32 lsAddr, const V128& value) {
+    const U32 addr = (currentAddress & ~SPU_LS_MASK) | (lsAddr & (SPU_LS_MASK & ~0xF));
+    U64* data = reinterpret_cast<U64*>(&memoryBase[addr]);
+
+    data[0] = SE64(value.u64[1]);
+    data[1] = SE64(value.u64[0]);
+    invalidate(addr, 16);
+}
+
+/**
+ * Branching
+ */
+U32 Interpreter::getBranchTarget(int index) const {
+    return (currentAddress & ~SPU_LS_MASK) | (state.r[index].u32[3] & 0x3FFFC);
+}
+
+V128 Interpreter::getLinkValue() const {
+    V128 value = {};
+    value.u32[3] = (currentAddress + 4) & SPU_LS_MASK;
+    return value;
+}
+
+void Interpreter::call(U32 target) {
+    state.pc = target;
+    if (!(config.spuTranslator & CPU_TRANSLATOR_FUNCTION)) {
+        return;
+    }
+
+    // Hand over hot functions to the translator
+    if (++callCounts[target] < SPU_INTERPRETER_HOT_CALLS) {
+        return;
+    }
+    for (auto* module : thread->modules) {
+        if (!module->contains(target)) {
+            continue;
+        }
+        if (!module->analyzed) {
+            module->analyze();
+        }
+
+        auto* hirFunction = module->addFunction(target)->hirFunction;
+        if (!(hirFunction->flags & hir::FUNCTION_IS_COMPILED)) {
+            parent->compiler->compile(hirFunction);
+        }
+
+        // Translated functions return to their caller, so resume right after the call
+        native = true;
+        parent->compiler->call(hirFunction, &state);
+        native = false;
+        state.pc = (currentAddress & ~SPU_LS_MASK) | ((currentAddress + 4) & SPU_LS_MASK);
+        return;
+    }
+}
+
+void Interpreter::halt() {
+    state.pc = currentAddress;
+    halted = true;
+}
+
+/**
+ * Execution
+ */
+void Interpreter::step() {
+    currentAddress = state.pc;
+    state.pc = (currentAddress & ~SPU_LS_MASK) | ((currentAddress + 4) & SPU_LS_MASK);
+
+    const auto& decoded = cache[(currentAddress & SPU_LS_MASK) / 4];
+    (this->*decoded.handler)(decoded.code);
+}
+
+void Interpreter::run(Size count) {
+    for (Size i = 0; i < count && !halted; i++) {
+        step();
+    }
+}
+
+}  // namespace spu
+}  // namespace frontend
+}  // namespace cpu
@@ -0,0 +1,274 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "spu_interpreter.h"
+#include "spu_interpreter_utils.h"
+#include "nucleus/cpu/frontend/spu/spu_state.h"
+#include "nucleus/logger/logger.h"
+
+namespace cpu {
+namespace frontend {
+namespace spu {
+
+/**
+ * SPU Instructions:
+ *  - Compare, Branch and Halt Instructions (Chapter 7)
+ *  - Hint-for-Branch Instructions (Chapter 8)
+ */
+
+// Compare, Branch and Halt Instructions (Chapter 7)
+void Interpreter::bi(Instruction code)
+{
+    state.pc = getBranchTarget(code.ra);
+}
+
+void Interpreter::bihnz(Instruction code)
+{
+    if (state.r[code.rt].u16[6] != 0) {
+        state.pc = getBranchTarget(code.ra);
+    }
+}
+
+void Interpreter::bihz(Instruction code)
+{
+    if (state.r[code.rt].u16[6] == 0) {
+        state.pc = getBranchTarget(code.ra);
+    }
+}
+
+void Interpreter::binz(Instruction code)
+{
+    if (state.r[code.rt].u32[3] != 0) {
+        state.pc = getBranchTarget(code.ra);
+    }
+}
+
+void Interpreter::bisl(Instruction code)
+{
+    const U32 target = getBranchTarget(code.ra);
+    state.r[code.rt] = getLinkValue();
+    call(target);
+}
+
+void Interpreter::bisled(Instruction code)
+{
+    logger.error(LOG_CPU, "SPU: Unimplemented instruction bisled at 0x%08X", currentAddress);
+    halt();
+}
+
+void Interpreter::biz(Instruction code)
+{
+    if (state.r[code.rt].u32[3] == 0) {
+        state.pc = getBranchTarget(code.ra);
+    }
+}
+
+void Interpreter::br(Instruction code)
+{
+    state.pc = code.get_target(currentAddress);
+}
+
+void Interpreter::bra(Instruction code)
+{
+    state.pc = code.get_target(currentAddress);
+}
+
+void Interpreter::brasl(Instruction code)
+{
+    state.r[code.rt] = getLinkValue();
+    call(code.get_target(currentAddress));
+}
+
+void Interpreter::brhnz(Instruction code)
+{
+    if (state.r[code.rt].u16[6] != 0) {
+        state.pc = code.get_target(currentAddress);
+    }
+}
+
+void Interpreter::brhz(Instruction code)
+{
+    if (state.r[code.rt].u16[6] == 0) {
+        state.pc = code.get_target(currentAddress);
+    }
+}
+
+void Interpreter::brnz(Instruction code)
+{
+    if (state.r[code.rt].u32[3] != 0) {
+        state.pc = code.get_target(currentAddress);
+    }
+}
+
+void Interpreter::brsl(Instruction code)
+{
+    state.r[code.rt] = getLinkValue();
+    call(code.get_target(currentAddress));
+}
+
+void Interpreter::brz(Instruction code)
+{
+    if (state.r[code.rt].u32[3] == 0) {
+        state.pc = code.get_target(currentAddress);
+    }
+}
+
+void Interpreter::ceq(Instruction code)
+{
+    state.r[code.rt] = vec::cmpeq32(state.r[code.ra], state.r[code.rb]);
+}
+
+void Interpreter::ceqb(Instruction code)
+{
+    state.r[code.rt] = vec::cmpeq8(state.r[code.ra], state.r[code.rb]);
+}
+
+void Interpreter::ceqbi(Instruction code)
+{
+    state.r[code.rt] = vec::cmpeq8(state.r[code.ra], vec::splat8(code.i10));
+}
+
+void Interpreter::ceqh(Instruction code)
+{
+    state.r[code.rt] = vec::cmpeq16(state.r[code.ra], state.r[code.rb]);
+}
+
+void Interpreter::ceqhi(Instruction code)
+{
+    state.r[code.rt] = vec::cmpeq16(state.r[code.ra], vec::splat16(code.i10));
+}
+
+void Interpreter::ceqi(Instruction code)
+{
+    state.r[code.rt] = vec::cmpeq32(state.r[code.ra], vec::splat32(code.i10));
+}
+
+void Interpreter::cgt(Instruction code)
+{
+    state.r[code.rt] = vec::cmpgt32(state.r[code.ra], state.r[code.rb]);
+}
+
+void Interpreter::cgtb(Instruction code)
+{
+    state.r[code.rt] = vec::cmpgt8(state.r[code.ra], state.r[code.rb]);
+}
+
+void Interpreter::cgtbi(Instruction code)
+{
+    state.r[code.rt] = vec::cmpgt8(state.r[code.ra], vec::splat8(code.i10));
+}
+
+void Interpreter::cgth(Instruction code)
+{
+    state.r[code.rt] = vec::cmpgt16(state.r[code.ra], state.r[code.rb]);
+}
+
+void Interpreter::cgthi(Instruction code)
+{
+    state.r[code.rt] = vec::cmpgt16(state.r[code.ra], vec::splat16(code.i10));
+}
+
+void Interpreter::cgti(Instruction code)
+{
+    state.r[code.rt] = vec::cmpgt32(state.r[code.ra], vec::splat32(code.i10));
+}
+
+void Interpreter::clgt(Instruction code)
+{
+    state.r[code.rt] = vec::cmpgtu32(state.r[code.ra], state.r[code.rb]);
+}
+
+void Interpreter::clgtb(Instruction code)
+{
+    state.r[code.rt] = vec::cmpgtu8(state.r[code.ra], state.r[code.rb]);
+}
+
+void Interpreter::clgtbi(Instruction code)
+{
+    state.r[code.rt] = vec::cmpgtu8(state.r[code.ra], vec::splat8(code.i10));
+}
+
+void Interpreter::clgth(Instruction code)
+{
+    state.r[code.rt] = vec::cmpgtu16(state.r[code.ra], state.r[code.rb]);
+}
+
+void Interpreter::clgthi(Instruction code)
+{
+    state.r[code.rt] = vec::cmpgtu16(state.r[code.ra], vec::splat16(code.i10));
+}
+
+void Interpreter::clgti(Instruction code)
+{
+    state.r[code.rt] = vec::cmpgtu32(state.r[code.ra], vec::splat32(code.i10));
+}
+
+void Interpreter::heq(Instruction code)
+{
+    if (state.r[code.ra].u32[3] == state.r[code.rb].u32[3]) {
+        halt();
+    }
+}
+
+void Interpreter::heqi(Instruction code)
+{
+    if (state.r[code.ra].s32[3] == code.i10) {
+        halt();
+    }
+}
+
+void Interpreter::hgt(Instruction code)
+{
+    if (state.r[code.ra].s32[3] > state.r[code.rb].s32[3]) {
+        halt();
+    }
+}
+
+void Interpreter::hgti(Instruction code)
+{
+    if (state.r[code.ra].s32[3] > code.i10) {
+        halt();
+    }
+}
+
+void Interpreter::hlgt(Instruction code)
+{
+    if (state.r[code.ra].u32[3] > state.r[code.rb].u32[3]) {
+        halt();
+    }
+}
+
+void Interpreter::hlgti(Instruction code)
+{
+    if (state.r[code.ra].u32[3] > U32(code.i10)) {
+        halt();
+    }
+}
+
+void Interpreter::iret(Instruction code)
+{
+    logger.error(LOG_CPU, "SPU: Unimplemented instruction iret at 0x%08X", currentAddress);
+    halt();
+}
+
+// Hint-for-Branch Instructions (Chapter 8)
+void Interpreter::hbr(Instruction code)
+{
+    // NOTE: Branch hints have no architectural effects.
+}
+
+void Interpreter::hbra(Instruction code)
+{
+    // NOTE: Branch hints have no architectural effects.
+}
+
+void Interpreter::hbrr(Instruction code)
+{
+    // NOTE: Branch hints have no architectural effects.
+}
+
+}  // namespace spu
+}  // namespace frontend
+}  // namespace cpu
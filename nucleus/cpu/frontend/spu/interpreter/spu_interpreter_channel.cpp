@@ -0,0 +1,41 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "spu_interpreter.h"
+#include "nucleus/cpu/frontend/spu/spu_state.h"
+#include "nucleus/cpu/frontend/spu/spu_thread.h"
+
+namespace cpu {
+namespace frontend {
+namespace spu {
+
+/**
+ * SPU Instructions:
+ *  - Channel Instructions (Chapter 11)
+ */
+
+// Channel Instructions (Chapter 11)
+void Interpreter::rchcnt(Instruction code)
+{
+    V128 rt = {};
+    rt.u32[3] = thread->getChannelCount(code.ca);
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::rdch(Instruction code)
+{
+    V128 rt = {};
+    rt.u32[3] = thread->readChannel(code.ca);
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::wrch(Instruction code)
+{
+    thread->writeChannel(code.ca, state.r[code.rt].u32[3]);
+}
+
+}  // namespace spu
+}  // namespace frontend
+}  // namespace cpu
@@ -0,0 +1,78 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "spu_interpreter.h"
+#include "nucleus/cpu/frontend/spu/spu_state.h"
+#include "nucleus/logger/logger.h"
+
+#ifdef NUCLEUS_ARCH_X86
+#ifdef NUCLEUS_COMPILER_MSVC
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+#include <atomic>
+
+namespace cpu {
+namespace frontend {
+namespace spu {
+
+/**
+ * SPU Instructions:
+ *  - Control Instructions (Chapter 10)
+ */
+
+// Control Instructions (Chapter 10)
+void Interpreter::dsync(Instruction code)
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void Interpreter::lnop(Instruction code)
+{
+    // NOTE: No need to implement this instruction.
+}
+
+void Interpreter::mfspr(Instruction code)
+{
+    state.r[code.rt] = state.s[code.ra];
+}
+
+void Interpreter::mtspr(Instruction code)
+{
+    state.s[code.ra] = state.r[code.rt];
+}
+
+void Interpreter::nop(Instruction code)
+{
+    // NOTE: No need to implement this instruction.
+}
+
+void Interpreter::stop(Instruction code)
+{
+    stopCode = code.value & 0x3FFF;
+    halt();
+}
+
+void Interpreter::stopd(Instruction code)
+{
+    stopCode = 0x3FFF;
+    halt();
+}
+
+void Interpreter::sync(Instruction code)
+{
+#ifdef NUCLEUS_ARCH_X86
+    _mm_mfence();
+#else
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+}
+
+}  // namespace spu
+}  // namespace frontend
+}  // namespace cpu
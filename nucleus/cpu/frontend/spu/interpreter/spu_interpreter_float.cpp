@@ -0,0 +1,438 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "spu_interpreter.h"
+#include "spu_interpreter_utils.h"
+#include "nucleus/cpu/frontend/spu/spu_state.h"
+
+#include <cmath>
+
+namespace cpu {
+namespace frontend {
+namespace spu {
+
+/**
+ * SPU Instructions:
+ *  - Floating-Point Instructions (Chapter 9)
+ *
+ * NOTE: Single-precision operations rely on the host IEEE 754 semantics. The SPU extended
+ * range, flush-to-zero of denormals and the FPSCR exception flags are not modeled.
+ */
+
+// Floating-Point Instructions (Chapter 9)
+void Interpreter::cflts(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    V128 rt;
+    for (Size i = 0; i < 4; i++) {
+        const F64 value = std::ldexp(F64(ra.f32[i]), 173 - S32(code.i8));
+        if (value >= 2147483647.0) {
+            rt.s32[i] = 0x7FFFFFFF;
+        } else if (value <= -2147483648.0) {
+            rt.u32[i] = 0x80000000;
+        } else {
+            rt.s32[i] = S32(value);
+        }
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::cfltu(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    V128 rt;
+    for (Size i = 0; i < 4; i++) {
+        const F64 value = std::ldexp(F64(ra.f32[i]), 173 - S32(code.i8));
+        if (value >= 4294967295.0) {
+            rt.u32[i] = 0xFFFFFFFF;
+        } else if (value <= 0.0) {
+            rt.u32[i] = 0;
+        } else {
+            rt.u32[i] = U32(value);
+        }
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::csflt(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    V128 rt;
+    for (Size i = 0; i < 4; i++) {
+        rt.f32[i] = F32(std::ldexp(F64(ra.s32[i]), S32(code.i8) - 155));
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::cuflt(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    V128 rt;
+    for (Size i = 0; i < 4; i++) {
+        rt.f32[i] = F32(std::ldexp(F64(ra.u32[i]), S32(code.i8) - 155));
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::dfa(Instruction code)
+{
+#if defined(NUCLEUS_ARCH_X86)
+    state.r[code.rt] = vec::stored(_mm_add_pd(vec::loadd(state.r[code.ra]), vec::loadd(state.r[code.rb])));
+#else
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 2; i++) {
+        rt.f64[i] = ra.f64[i] + rb.f64[i];
+    }
+#endif
+}
+
+void Interpreter::dfceq(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    V128 rt;
+    for (Size i = 0; i < 2; i++) {
+        rt.u64[i] = (ra.f64[i] == rb.f64[i]) ? ~0ULL : 0;
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::dfcgt(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    V128 rt;
+    for (Size i = 0; i < 2; i++) {
+        rt.u64[i] = (ra.f64[i] > rb.f64[i]) ? ~0ULL : 0;
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::dfcmeq(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    V128 rt;
+    for (Size i = 0; i < 2; i++) {
+        rt.u64[i] = (std::fabs(ra.f64[i]) == std::fabs(rb.f64[i])) ? ~0ULL : 0;
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::dfcmgt(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    V128 rt;
+    for (Size i = 0; i < 2; i++) {
+        rt.u64[i] = (std::fabs(ra.f64[i]) > std::fabs(rb.f64[i])) ? ~0ULL : 0;
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::dfm(Instruction code)
+{
+#if defined(NUCLEUS_ARCH_X86)
+    state.r[code.rt] = vec::stored(_mm_mul_pd(vec::loadd(state.r[code.ra]), vec::loadd(state.r[code.rb])));
+#else
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 2; i++) {
+        rt.f64[i] = ra.f64[i] * rb.f64[i];
+    }
+#endif
+}
+
+void Interpreter::dfma(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 2; i++) {
+        rt.f64[i] = ra.f64[i] * rb.f64[i] + rt.f64[i];
+    }
+}
+
+void Interpreter::dfms(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 2; i++) {
+        rt.f64[i] = ra.f64[i] * rb.f64[i] - rt.f64[i];
+    }
+}
+
+void Interpreter::dfnma(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 2; i++) {
+        rt.f64[i] = -(ra.f64[i] * rb.f64[i] + rt.f64[i]);
+    }
+}
+
+void Interpreter::dfnms(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 2; i++) {
+        rt.f64[i] = rt.f64[i] - ra.f64[i] * rb.f64[i];
+    }
+}
+
+void Interpreter::dfs(Instruction code)
+{
+#if defined(NUCLEUS_ARCH_X86)
+    state.r[code.rt] = vec::stored(_mm_sub_pd(vec::loadd(state.r[code.ra]), vec::loadd(state.r[code.rb])));
+#else
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 2; i++) {
+        rt.f64[i] = ra.f64[i] - rb.f64[i];
+    }
+#endif
+}
+
+void Interpreter::dftsv(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    V128 rt;
+    for (Size i = 0; i < 2; i++) {
+        const F64 value = ra.f64[i];
+        const bool negative = std::signbit(value);
+        bool result = false;
+        switch (std::fpclassify(value)) {
+        case FP_NAN:       result = (code.i7 & 0x40) != 0; break;
+        case FP_INFINITE:  result = (code.i7 & (negative ? 0x10 : 0x20)) != 0; break;
+        case FP_ZERO:      result = (code.i7 & (negative ? 0x04 : 0x08)) != 0; break;
+        case FP_SUBNORMAL: result = (code.i7 & (negative ? 0x01 : 0x02)) != 0; break;
+        }
+        rt.u64[i] = result ? ~0ULL : 0;
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::fa(Instruction code)
+{
+#if defined(NUCLEUS_ARCH_X86)
+    state.r[code.rt] = vec::storef(_mm_add_ps(vec::loadf(state.r[code.ra]), vec::loadf(state.r[code.rb])));
+#else
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.f32[i] = ra.f32[i] + rb.f32[i];
+    }
+#endif
+}
+
+void Interpreter::fceq(Instruction code)
+{
+#if defined(NUCLEUS_ARCH_X86)
+    state.r[code.rt] = vec::storef(_mm_cmpeq_ps(vec::loadf(state.r[code.ra]), vec::loadf(state.r[code.rb])));
+#else
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.u32[i] = (ra.f32[i] == rb.f32[i]) ? 0xFFFFFFFF : 0;
+    }
+#endif
+}
+
+void Interpreter::fcgt(Instruction code)
+{
+#if defined(NUCLEUS_ARCH_X86)
+    state.r[code.rt] = vec::storef(_mm_cmpgt_ps(vec::loadf(state.r[code.ra]), vec::loadf(state.r[code.rb])));
+#else
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.u32[i] = (ra.f32[i] > rb.f32[i]) ? 0xFFFFFFFF : 0;
+    }
+#endif
+}
+
+void Interpreter::fcmeq(Instruction code)
+{
+    const V128 mask = vec::splat32(0x7FFFFFFF);
+    const V128 ra = vec::and_(state.r[code.ra], mask);
+    const V128 rb = vec::and_(state.r[code.rb], mask);
+#if defined(NUCLEUS_ARCH_X86)
+    state.r[code.rt] = vec::storef(_mm_cmpeq_ps(vec::loadf(ra), vec::loadf(rb)));
+#else
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.u32[i] = (ra.f32[i] == rb.f32[i]) ? 0xFFFFFFFF : 0;
+    }
+#endif
+}
+
+void Interpreter::fcmgt(Instruction code)
+{
+    const V128 mask = vec::splat32(0x7FFFFFFF);
+    const V128 ra = vec::and_(state.r[code.ra], mask);
+    const V128 rb = vec::and_(state.r[code.rb], mask);
+#if defined(NUCLEUS_ARCH_X86)
+    state.r[code.rt] = vec::storef(_mm_cmpgt_ps(vec::loadf(ra), vec::loadf(rb)));
+#else
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.u32[i] = (ra.f32[i] > rb.f32[i]) ? 0xFFFFFFFF : 0;
+    }
+#endif
+}
+
+void Interpreter::fesd(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    V128 rt;
+    rt.f64[1] = ra.f32[3];
+    rt.f64[0] = ra.f32[1];
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::fi(Instruction code)
+{
+    // NOTE: The estimates computed by frest and frsqest are already exact
+    state.r[code.rt] = state.r[code.rb];
+}
+
+void Interpreter::fm(Instruction code)
+{
+#if defined(NUCLEUS_ARCH_X86)
+    state.r[code.rt] = vec::storef(_mm_mul_ps(vec::loadf(state.r[code.ra]), vec::loadf(state.r[code.rb])));
+#else
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.f32[i] = ra.f32[i] * rb.f32[i];
+    }
+#endif
+}
+
+void Interpreter::fma(Instruction code)
+{
+#if defined(NUCLEUS_ARCH_X86)
+    const __m128 product = _mm_mul_ps(vec::loadf(state.r[code.ra]), vec::loadf(state.r[code.rb]));
+    state.r[code.rt_] = vec::storef(_mm_add_ps(product, vec::loadf(state.r[code.rc])));
+#else
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    const auto& rc = state.r[code.rc];
+    V128 rt;
+    for (Size i = 0; i < 4; i++) {
+        rt.f32[i] = ra.f32[i] * rb.f32[i] + rc.f32[i];
+    }
+    state.r[code.rt_] = rt;
+#endif
+}
+
+void Interpreter::fms(Instruction code)
+{
+#if defined(NUCLEUS_ARCH_X86)
+    const __m128 product = _mm_mul_ps(vec::loadf(state.r[code.ra]), vec::loadf(state.r[code.rb]));
+    state.r[code.rt_] = vec::storef(_mm_sub_ps(product, vec::loadf(state.r[code.rc])));
+#else
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    const auto& rc = state.r[code.rc];
+    V128 rt;
+    for (Size i = 0; i < 4; i++) {
+        rt.f32[i] = ra.f32[i] * rb.f32[i] - rc.f32[i];
+    }
+    state.r[code.rt_] = rt;
+#endif
+}
+
+void Interpreter::fnms(Instruction code)
+{
+#if defined(NUCLEUS_ARCH_X86)
+    const __m128 product = _mm_mul_ps(vec::loadf(state.r[code.ra]), vec::loadf(state.r[code.rb]));
+    state.r[code.rt_] = vec::storef(_mm_sub_ps(vec::loadf(state.r[code.rc]), product));
+#else
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    const auto& rc = state.r[code.rc];
+    V128 rt;
+    for (Size i = 0; i < 4; i++) {
+        rt.f32[i] = rc.f32[i] - ra.f32[i] * rb.f32[i];
+    }
+    state.r[code.rt_] = rt;
+#endif
+}
+
+void Interpreter::frds(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    V128 rt = {};
+    rt.f32[3] = F32(ra.f64[1]);
+    rt.f32[1] = F32(ra.f64[0]);
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::frest(Instruction code)
+{
+#if defined(NUCLEUS_ARCH_X86)
+    state.r[code.rt] = vec::storef(_mm_div_ps(_mm_set1_ps(1.0f), vec::loadf(state.r[code.ra])));
+#else
+    const auto& ra = state.r[code.ra];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.f32[i] = 1.0f / ra.f32[i];
+    }
+#endif
+}
+
+void Interpreter::frsqest(Instruction code)
+{
+    const V128 ra = vec::and_(state.r[code.ra], vec::splat32(0x7FFFFFFF));
+#if defined(NUCLEUS_ARCH_X86)
+    state.r[code.rt] = vec::storef(_mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(vec::loadf(ra))));
+#else
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.f32[i] = 1.0f / std::sqrt(ra.f32[i]);
+    }
+#endif
+}
+
+void Interpreter::fs(Instruction code)
+{
+#if defined(NUCLEUS_ARCH_X86)
+    state.r[code.rt] = vec::storef(_mm_sub_ps(vec::loadf(state.r[code.ra]), vec::loadf(state.r[code.rb])));
+#else
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.f32[i] = ra.f32[i] - rb.f32[i];
+    }
+#endif
+}
+
+void Interpreter::fscrrd(Instruction code)
+{
+    // NOTE: The FPSCR is not modeled, hence no exceptions are ever reported
+    state.r[code.rt] = V128{};
+}
+
+void Interpreter::fscrwr(Instruction code)
+{
+    // NOTE: The FPSCR is not modeled
+}
+
+}  // namespace spu
+}  // namespace frontend
+}  // namespace cpu
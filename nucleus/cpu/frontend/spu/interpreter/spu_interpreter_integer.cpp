@@ -0,0 +1,810 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "spu_interpreter.h"
+#include "spu_interpreter_utils.h"
+#include "nucleus/cpu/frontend/spu/spu_state.h"
+
+namespace cpu {
+namespace frontend {
+namespace spu {
+
+/**
+ * SPU Instructions:
+ *  - Constant-Formation Instructions (Chapter 4)
+ *  - Integer and Logical Instructions (Chapter 5)
+ *  - Shift and Rotate Instructions (Chapter 6)
+ */
+
+// Constant-Formation Instructions (Chapter 4)
+void Interpreter::fsmbi(Instruction code)
+{
+    V128 rt;
+    for (Size i = 0; i < 16; i++) {
+        rt.u8[i] = (code.i16 & (1 << i)) ? 0xFF : 0x00;
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::il(Instruction code)
+{
+    state.r[code.rt] = vec::splat32(code.i16);
+}
+
+void Interpreter::ila(Instruction code)
+{
+    state.r[code.rt] = vec::splat32(code.i18 & 0x3FFFF);
+}
+
+void Interpreter::ilh(Instruction code)
+{
+    state.r[code.rt] = vec::splat16(code.i16);
+}
+
+void Interpreter::ilhu(Instruction code)
+{
+    state.r[code.rt] = vec::splat32(code.i16 << 16);
+}
+
+void Interpreter::iohl(Instruction code)
+{
+    state.r[code.rt] = vec::or_(state.r[code.rt], vec::splat32(code.i16 & 0xFFFF));
+}
+
+// Integer and Logical Instructions (Chapter 5)
+void Interpreter::a(Instruction code)
+{
+    state.r[code.rt] = vec::add32(state.r[code.ra], state.r[code.rb]);
+}
+
+void Interpreter::absdb(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+#if defined(NUCLEUS_ARCH_X86)
+    const __m128i va = vec::load(ra);
+    const __m128i vb = vec::load(rb);
+    state.r[code.rt] = vec::store(_mm_sub_epi8(_mm_max_epu8(va, vb), _mm_min_epu8(va, vb)));
+#else
+    V128 rt;
+    for (Size i = 0; i < 16; i++) {
+        rt.u8[i] = (ra.u8[i] > rb.u8[i]) ? (ra.u8[i] - rb.u8[i]) : (rb.u8[i] - ra.u8[i]);
+    }
+    state.r[code.rt] = rt;
+#endif
+}
+
+void Interpreter::addx(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.u32[i] = ra.u32[i] + rb.u32[i] + (rt.u32[i] & 1);
+    }
+}
+
+void Interpreter::ah(Instruction code)
+{
+    state.r[code.rt] = vec::add16(state.r[code.ra], state.r[code.rb]);
+}
+
+void Interpreter::ahi(Instruction code)
+{
+    state.r[code.rt] = vec::add16(state.r[code.ra], vec::splat16(code.i10));
+}
+
+void Interpreter::ai(Instruction code)
+{
+    state.r[code.rt] = vec::add32(state.r[code.ra], vec::splat32(code.i10));
+}
+
+void Interpreter::and_(Instruction code)
+{
+    state.r[code.rt] = vec::and_(state.r[code.ra], state.r[code.rb]);
+}
+
+void Interpreter::andc(Instruction code)
+{
+    state.r[code.rt] = vec::andc(state.r[code.ra], state.r[code.rb]);
+}
+
+void Interpreter::andbi(Instruction code)
+{
+    state.r[code.rt] = vec::and_(state.r[code.ra], vec::splat8(code.i10));
+}
+
+void Interpreter::andhi(Instruction code)
+{
+    state.r[code.rt] = vec::and_(state.r[code.ra], vec::splat16(code.i10));
+}
+
+void Interpreter::andi(Instruction code)
+{
+    state.r[code.rt] = vec::and_(state.r[code.ra], vec::splat32(code.i10));
+}
+
+void Interpreter::avgb(Instruction code)
+{
+#if defined(NUCLEUS_ARCH_X86)
+    state.r[code.rt] = vec::store(_mm_avg_epu8(vec::load(state.r[code.ra]), vec::load(state.r[code.rb])));
+#else
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    V128 rt;
+    for (Size i = 0; i < 16; i++) {
+        rt.u8[i] = (ra.u8[i] + rb.u8[i] + 1) >> 1;
+    }
+    state.r[code.rt] = rt;
+#endif
+}
+
+void Interpreter::bg(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.u32[i] = (rb.u32[i] >= ra.u32[i]) ? 1 : 0;
+    }
+}
+
+void Interpreter::bgx(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        const S64 diff = S64(rb.u32[i]) - S64(ra.u32[i]) - S64((rt.u32[i] & 1) ^ 1);
+        rt.u32[i] = (diff >= 0) ? 1 : 0;
+    }
+}
+
+void Interpreter::cg(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.u32[i] = (U64(ra.u32[i]) + U64(rb.u32[i])) >> 32;
+    }
+}
+
+void Interpreter::cgx(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.u32[i] = (U64(ra.u32[i]) + U64(rb.u32[i]) + (rt.u32[i] & 1)) >> 32;
+    }
+}
+
+void Interpreter::clz(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        U32 value = ra.u32[i];
+        U32 count = 32;
+        while (value) {
+            value >>= 1;
+            count--;
+        }
+        rt.u32[i] = count;
+    }
+}
+
+void Interpreter::cntb(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        U32 value = ra.u32[i];
+        value = value - ((value >> 1) & 0x55555555);
+        value = (value & 0x33333333) + ((value >> 2) & 0x33333333);
+        rt.u32[i] = (value + (value >> 4)) & 0x0F0F0F0F;
+    }
+}
+
+void Interpreter::eqv(Instruction code)
+{
+    state.r[code.rt] = vec::not_(vec::xor_(state.r[code.ra], state.r[code.rb]));
+}
+
+void Interpreter::fsm(Instruction code)
+{
+    const U32 mask = state.r[code.ra].u32[3];
+    V128 rt;
+    for (Size i = 0; i < 4; i++) {
+        rt.u32[i] = (mask & (1 << i)) ? 0xFFFFFFFF : 0;
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::fsmb(Instruction code)
+{
+    const U32 mask = state.r[code.ra].u32[3];
+    V128 rt;
+    for (Size i = 0; i < 16; i++) {
+        rt.u8[i] = (mask & (1 << i)) ? 0xFF : 0;
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::fsmh(Instruction code)
+{
+    const U32 mask = state.r[code.ra].u32[3];
+    V128 rt;
+    for (Size i = 0; i < 8; i++) {
+        rt.u16[i] = (mask & (1 << i)) ? 0xFFFF : 0;
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::gb(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    V128 rt = {};
+    for (Size i = 0; i < 4; i++) {
+        rt.u32[3] |= (ra.u32[i] & 1) << i;
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::gbb(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    V128 rt = {};
+    for (Size i = 0; i < 16; i++) {
+        rt.u32[3] |= (ra.u8[i] & 1) << i;
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::gbh(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    V128 rt = {};
+    for (Size i = 0; i < 8; i++) {
+        rt.u32[3] |= (ra.u16[i] & 1) << i;
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::mpy(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.s32[i] = S16(ra.u32[i]) * S16(rb.u32[i]);
+    }
+}
+
+void Interpreter::mpya(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    const auto& rc = state.r[code.rc];
+    V128 rt;
+    for (Size i = 0; i < 4; i++) {
+        rt.s32[i] = S16(ra.u32[i]) * S16(rb.u32[i]) + rc.s32[i];
+    }
+    state.r[code.rt_] = rt;
+}
+
+void Interpreter::mpyh(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.u32[i] = ((ra.u32[i] >> 16) * U16(rb.u32[i])) << 16;
+    }
+}
+
+void Interpreter::mpyhh(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.s32[i] = S16(ra.u32[i] >> 16) * S16(rb.u32[i] >> 16);
+    }
+}
+
+void Interpreter::mpyhha(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.s32[i] += S16(ra.u32[i] >> 16) * S16(rb.u32[i] >> 16);
+    }
+}
+
+void Interpreter::mpyhhau(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.u32[i] += (ra.u32[i] >> 16) * (rb.u32[i] >> 16);
+    }
+}
+
+void Interpreter::mpyhhu(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.u32[i] = (ra.u32[i] >> 16) * (rb.u32[i] >> 16);
+    }
+}
+
+void Interpreter::mpyi(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.s32[i] = S16(ra.u32[i]) * code.i10;
+    }
+}
+
+void Interpreter::mpys(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.s32[i] = (S16(ra.u32[i]) * S16(rb.u32[i])) >> 16;
+    }
+}
+
+void Interpreter::mpyu(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.u32[i] = U16(ra.u32[i]) * U16(rb.u32[i]);
+    }
+}
+
+void Interpreter::mpyui(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.u32[i] = U16(ra.u32[i]) * U16(code.i10);
+    }
+}
+
+void Interpreter::nand(Instruction code)
+{
+    state.r[code.rt] = vec::not_(vec::and_(state.r[code.ra], state.r[code.rb]));
+}
+
+void Interpreter::nor(Instruction code)
+{
+    state.r[code.rt] = vec::not_(vec::or_(state.r[code.ra], state.r[code.rb]));
+}
+
+void Interpreter::or_(Instruction code)
+{
+    state.r[code.rt] = vec::or_(state.r[code.ra], state.r[code.rb]);
+}
+
+void Interpreter::orbi(Instruction code)
+{
+    state.r[code.rt] = vec::or_(state.r[code.ra], vec::splat8(code.i10));
+}
+
+void Interpreter::orc(Instruction code)
+{
+    state.r[code.rt] = vec::or_(state.r[code.ra], vec::not_(state.r[code.rb]));
+}
+
+void Interpreter::orhi(Instruction code)
+{
+    state.r[code.rt] = vec::or_(state.r[code.ra], vec::splat16(code.i10));
+}
+
+void Interpreter::ori(Instruction code)
+{
+    state.r[code.rt] = vec::or_(state.r[code.ra], vec::splat32(code.i10));
+}
+
+void Interpreter::orx(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    V128 rt = {};
+    rt.u32[3] = ra.u32[0] | ra.u32[1] | ra.u32[2] | ra.u32[3];
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::selb(Instruction code)
+{
+    const auto& rc = state.r[code.rc];
+    state.r[code.rt_] = vec::or_(vec::and_(state.r[code.rb], rc), vec::andc(state.r[code.ra], rc));
+}
+
+void Interpreter::sf(Instruction code)
+{
+    state.r[code.rt] = vec::sub32(state.r[code.rb], state.r[code.ra]);
+}
+
+void Interpreter::sfh(Instruction code)
+{
+    state.r[code.rt] = vec::sub16(state.r[code.rb], state.r[code.ra]);
+}
+
+void Interpreter::sfhi(Instruction code)
+{
+    state.r[code.rt] = vec::sub16(vec::splat16(code.i10), state.r[code.ra]);
+}
+
+void Interpreter::sfi(Instruction code)
+{
+    state.r[code.rt] = vec::sub32(vec::splat32(code.i10), state.r[code.ra]);
+}
+
+void Interpreter::sfx(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.u32[i] = rb.u32[i] - ra.u32[i] - ((rt.u32[i] & 1) ^ 1);
+    }
+}
+
+void Interpreter::shufb(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    const auto& rc = state.r[code.rc];
+    V128 rt;
+    for (Size i = 0; i < 16; i++) {
+        const U08 select = rc.u8[i];
+        if ((select & 0xC0) == 0x80) {
+            rt.u8[i] = 0x00;
+        } else if ((select & 0xE0) == 0xC0) {
+            rt.u8[i] = 0xFF;
+        } else if ((select & 0xE0) == 0xE0) {
+            rt.u8[i] = 0x80;
+        } else {
+            const U32 index = select & 0x1F;
+            rt.u8[i] = (index < 16) ? ra.u8[15 - index] : rb.u8[31 - index];
+        }
+    }
+    state.r[code.rt_] = rt;
+}
+
+void Interpreter::sumb(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    V128 rt;
+    for (Size i = 0; i < 4; i++) {
+        const U32 sumA = ra.u8[4*i+0] + ra.u8[4*i+1] + ra.u8[4*i+2] + ra.u8[4*i+3];
+        const U32 sumB = rb.u8[4*i+0] + rb.u8[4*i+1] + rb.u8[4*i+2] + rb.u8[4*i+3];
+        rt.u32[i] = (sumB << 16) | sumA;
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::xor_(Instruction code)
+{
+    state.r[code.rt] = vec::xor_(state.r[code.ra], state.r[code.rb]);
+}
+
+void Interpreter::xorbi(Instruction code)
+{
+    state.r[code.rt] = vec::xor_(state.r[code.ra], vec::splat8(code.i10));
+}
+
+void Interpreter::xorhi(Instruction code)
+{
+    state.r[code.rt] = vec::xor_(state.r[code.ra], vec::splat16(code.i10));
+}
+
+void Interpreter::xori(Instruction code)
+{
+    state.r[code.rt] = vec::xor_(state.r[code.ra], vec::splat32(code.i10));
+}
+
+void Interpreter::xsbh(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 8; i++) {
+        rt.s16[i] = S08(ra.u16[i]);
+    }
+}
+
+void Interpreter::xshw(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 4; i++) {
+        rt.s32[i] = S16(ra.u32[i]);
+    }
+}
+
+void Interpreter::xswd(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    auto& rt = state.r[code.rt];
+    for (Size i = 0; i < 2; i++) {
+        rt.s64[i] = S32(ra.u64[i]);
+    }
+}
+
+// Shift and Rotate Instructions (Chapter 6)
+void Interpreter::shl(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    V128 rt;
+    for (Size i = 0; i < 4; i++) {
+        const U32 count = rb.u32[i] & 0x3F;
+        rt.u32[i] = (count > 31) ? 0 : (ra.u32[i] << count);
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::shlh(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    V128 rt;
+    for (Size i = 0; i < 8; i++) {
+        const U32 count = rb.u16[i] & 0x1F;
+        rt.u16[i] = (count > 15) ? 0 : (ra.u16[i] << count);
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::shlhi(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const U32 count = code.i7 & 0x1F;
+    V128 rt;
+    for (Size i = 0; i < 8; i++) {
+        rt.u16[i] = (count > 15) ? 0 : (ra.u16[i] << count);
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::shli(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const U32 count = code.i7 & 0x3F;
+    V128 rt;
+    for (Size i = 0; i < 4; i++) {
+        rt.u32[i] = (count > 31) ? 0 : (ra.u32[i] << count);
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::shlqbi(Instruction code)
+{
+    state.r[code.rt] = vec::shl128(state.r[code.ra], state.r[code.rb].u32[3] & 0x7);
+}
+
+void Interpreter::shlqbii(Instruction code)
+{
+    state.r[code.rt] = vec::shl128(state.r[code.ra], code.i7 & 0x7);
+}
+
+void Interpreter::shlqby(Instruction code)
+{
+    state.r[code.rt] = vec::shl128(state.r[code.ra], (state.r[code.rb].u32[3] & 0x1F) * 8);
+}
+
+void Interpreter::shlqbybi(Instruction code)
+{
+    state.r[code.rt] = vec::shl128(state.r[code.ra], ((state.r[code.rb].u32[3] >> 3) & 0x1F) * 8);
+}
+
+void Interpreter::shlqbyi(Instruction code)
+{
+    state.r[code.rt] = vec::shl128(state.r[code.ra], (code.i7 & 0x1F) * 8);
+}
+
+void Interpreter::rot(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    V128 rt;
+    for (Size i = 0; i < 4; i++) {
+        const U32 count = rb.u32[i] & 0x1F;
+        rt.u32[i] = count ? ((ra.u32[i] << count) | (ra.u32[i] >> (32 - count))) : ra.u32[i];
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::roth(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    V128 rt;
+    for (Size i = 0; i < 8; i++) {
+        const U32 count = rb.u16[i] & 0xF;
+        rt.u16[i] = count ? ((ra.u16[i] << count) | (ra.u16[i] >> (16 - count))) : ra.u16[i];
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::rothi(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const U32 count = code.i7 & 0xF;
+    V128 rt;
+    for (Size i = 0; i < 8; i++) {
+        rt.u16[i] = count ? ((ra.u16[i] << count) | (ra.u16[i] >> (16 - count))) : ra.u16[i];
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::rothm(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    V128 rt;
+    for (Size i = 0; i < 8; i++) {
+        const U32 count = (0 - rb.u16[i]) & 0x1F;
+        rt.u16[i] = (count > 15) ? 0 : (ra.u16[i] >> count);
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::rothmi(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const U32 count = (0 - code.i7) & 0x1F;
+    V128 rt;
+    for (Size i = 0; i < 8; i++) {
+        rt.u16[i] = (count > 15) ? 0 : (ra.u16[i] >> count);
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::roti(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const U32 count = code.i7 & 0x1F;
+    V128 rt;
+    for (Size i = 0; i < 4; i++) {
+        rt.u32[i] = count ? ((ra.u32[i] << count) | (ra.u32[i] >> (32 - count))) : ra.u32[i];
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::rotm(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    V128 rt;
+    for (Size i = 0; i < 4; i++) {
+        const U32 count = (0 - rb.u32[i]) & 0x3F;
+        rt.u32[i] = (count > 31) ? 0 : (ra.u32[i] >> count);
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::rotma(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    V128 rt;
+    for (Size i = 0; i < 4; i++) {
+        const U32 count = (0 - rb.u32[i]) & 0x3F;
+        rt.s32[i] = ra.s32[i] >> ((count > 31) ? 31 : count);
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::rotmah(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const auto& rb = state.r[code.rb];
+    V128 rt;
+    for (Size i = 0; i < 8; i++) {
+        const U32 count = (0 - rb.u16[i]) & 0x1F;
+        rt.s16[i] = ra.s16[i] >> ((count > 15) ? 15 : count);
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::rotmahi(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const U32 count = (0 - code.i7) & 0x1F;
+    V128 rt;
+    for (Size i = 0; i < 8; i++) {
+        rt.s16[i] = ra.s16[i] >> ((count > 15) ? 15 : count);
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::rotmai(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const U32 count = (0 - code.i7) & 0x3F;
+    V128 rt;
+    for (Size i = 0; i < 4; i++) {
+        rt.s32[i] = ra.s32[i] >> ((count > 31) ? 31 : count);
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::rotmi(Instruction code)
+{
+    const auto& ra = state.r[code.ra];
+    const U32 count = (0 - code.i7) & 0x3F;
+    V128 rt;
+    for (Size i = 0; i < 4; i++) {
+        rt.u32[i] = (count > 31) ? 0 : (ra.u32[i] >> count);
+    }
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::rotqbi(Instruction code)
+{
+    state.r[code.rt] = vec::rotl128(state.r[code.ra], state.r[code.rb].u32[3] & 0x7);
+}
+
+void Interpreter::rotqbii(Instruction code)
+{
+    state.r[code.rt] = vec::rotl128(state.r[code.ra], code.i7 & 0x7);
+}
+
+void Interpreter::rotqby(Instruction code)
+{
+    state.r[code.rt] = vec::rotl128(state.r[code.ra], (state.r[code.rb].u32[3] & 0xF) * 8);
+}
+
+void Interpreter::rotqbybi(Instruction code)
+{
+    state.r[code.rt] = vec::rotl128(state.r[code.ra], ((state.r[code.rb].u32[3] >> 3) & 0xF) * 8);
+}
+
+void Interpreter::rotqbyi(Instruction code)
+{
+    state.r[code.rt] = vec::rotl128(state.r[code.ra], (code.i7 & 0xF) * 8);
+}
+
+void Interpreter::rotqmbi(Instruction code)
+{
+    state.r[code.rt] = vec::shr128(state.r[code.ra], (0 - state.r[code.rb].u32[3]) & 0x7);
+}
+
+void Interpreter::rotqmbii(Instruction code)
+{
+    state.r[code.rt] = vec::shr128(state.r[code.ra], (0 - code.i7) & 0x7);
+}
+
+void Interpreter::rotqmby(Instruction code)
+{
+    state.r[code.rt] = vec::shr128(state.r[code.ra], ((0 - state.r[code.rb].u32[3]) & 0x1F) * 8);
+}
+
+void Interpreter::rotqmbybi(Instruction code)
+{
+    state.r[code.rt] = vec::shr128(state.r[code.ra], ((0 - (state.r[code.rb].u32[3] >> 3)) & 0x1F) * 8);
+}
+
+void Interpreter::rotqmbyi(Instruction code)
+{
+    state.r[code.rt] = vec::shr128(state.r[code.ra], ((0 - code.i7) & 0x1F) * 8);
+}
+
+}  // namespace spu
+}  // namespace frontend
+}  // namespace cpu
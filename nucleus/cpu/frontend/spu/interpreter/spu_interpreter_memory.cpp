@@ -0,0 +1,138 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "spu_interpreter.h"
+#include "spu_interpreter_utils.h"
+#include "nucleus/cpu/frontend/spu/spu_state.h"
+
+namespace cpu {
+namespace frontend {
+namespace spu {
+
+/**
+ * Insertion controls: Identity shuffle pattern selecting the bytes of RB
+ */
+static V128 getInsertionControl() {
+    V128 value;
+    value.u32[3] = 0x10111213;
+    value.u32[2] = 0x14151617;
+    value.u32[1] = 0x18191A1B;
+    value.u32[0] = 0x1C1D1E1F;
+    return value;
+}
+
+/**
+ * SPU Instructions:
+ *  - Memory-Load/Store Instructions (Chapter 3)
+ */
+
+// Memory-Load/Store Instructions (Chapter 3)
+void Interpreter::cbd(Instruction code)
+{
+    const U32 t = (state.r[code.ra].u32[3] + code.i7) & 0xF;
+    V128 rt = getInsertionControl();
+    rt.u8[15 - t] = 0x03;
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::cbx(Instruction code)
+{
+    const U32 t = (state.r[code.ra].u32[3] + state.r[code.rb].u32[3]) & 0xF;
+    V128 rt = getInsertionControl();
+    rt.u8[15 - t] = 0x03;
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::cdd(Instruction code)
+{
+    const U32 t = (state.r[code.ra].u32[3] + code.i7) & 0x8;
+    V128 rt = getInsertionControl();
+    rt.u64[1 - t / 8] = 0x0001020304050607ULL;
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::cdx(Instruction code)
+{
+    const U32 t = (state.r[code.ra].u32[3] + state.r[code.rb].u32[3]) & 0x8;
+    V128 rt = getInsertionControl();
+    rt.u64[1 - t / 8] = 0x0001020304050607ULL;
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::chd(Instruction code)
+{
+    const U32 t = (state.r[code.ra].u32[3] + code.i7) & 0xE;
+    V128 rt = getInsertionControl();
+    rt.u16[7 - t / 2] = 0x0203;
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::chx(Instruction code)
+{
+    const U32 t = (state.r[code.ra].u32[3] + state.r[code.rb].u32[3]) & 0xE;
+    V128 rt = getInsertionControl();
+    rt.u16[7 - t / 2] = 0x0203;
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::cwd(Instruction code)
+{
+    const U32 t = (state.r[code.ra].u32[3] + code.i7) & 0xC;
+    V128 rt = getInsertionControl();
+    rt.u32[3 - t / 4] = 0x00010203;
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::cwx(Instruction code)
+{
+    const U32 t = (state.r[code.ra].u32[3] + state.r[code.rb].u32[3]) & 0xC;
+    V128 rt = getInsertionControl();
+    rt.u32[3 - t / 4] = 0x00010203;
+    state.r[code.rt] = rt;
+}
+
+void Interpreter::lqa(Instruction code)
+{
+    state.r[code.rt] = readMemory(code.i16 << 2);
+}
+
+void Interpreter::lqd(Instruction code)
+{
+    state.r[code.rt] = readMemory((code.i10 << 4) + state.r[code.ra].u32[3]);
+}
+
+void Interpreter::lqr(Instruction code)
+{
+    state.r[code.rt] = readMemory((code.i16 << 2) + currentAddress);
+}
+
+void Interpreter::lqx(Instruction code)
+{
+    state.r[code.rt] = readMemory(state.r[code.ra].u32[3] + state.r[code.rb].u32[3]);
+}
+
+void Interpreter::stqa(Instruction code)
+{
+    writeMemory(code.i16 << 2, state.r[code.rt]);
+}
+
+void Interpreter::stqd(Instruction code)
+{
+    writeMemory((code.i10 << 4) + state.r[code.ra].u32[3], state.r[code.rt]);
+}
+
+void Interpreter::stqr(Instruction code)
+{
+    writeMemory((code.i16 << 2) + currentAddress, state.r[code.rt]);
+}
+
+void Interpreter::stqx(Instruction code)
+{
+    writeMemory(state.r[code.ra].u32[3] + state.r[code.rb].u32[3], state.r[code.rt]);
+}
+
+}  // namespace spu
+}  // namespace frontend
+}  // namespace cpu
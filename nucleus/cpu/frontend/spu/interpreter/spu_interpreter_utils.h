@@ -0,0 +1,286 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+
+#if defined(NUCLEUS_ARCH_X86)
+#include <emmintrin.h>
+#endif
+
+namespace cpu {
+namespace frontend {
+namespace spu {
+
+/**
+ * Vector helpers for the SPU interpreter:
+ * Registers are stored with host-endian elements, i.e. the preferred slot of a word is
+ * u32[3] and the SPU element i of a vector with N elements is the host element N-1-i.
+ * Component-wise operations use SSE2, which is available on every x86-64 host.
+ */
+namespace vec {
+
+#if defined(NUCLEUS_ARCH_X86)
+inline __m128i load(const V128& v) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(&v)); }
+inline __m128 loadf(const V128& v) { return _mm_loadu_ps(v.f32); }
+inline __m128d loadd(const V128& v) { return _mm_loadu_pd(v.f64); }
+inline V128 store(__m128i x) { V128 v; _mm_storeu_si128(reinterpret_cast<__m128i*>(&v), x); return v; }
+inline V128 storef(__m128 x) { V128 v; _mm_storeu_ps(v.f32, x); return v; }
+inline V128 stored(__m128d x) { V128 v; _mm_storeu_pd(v.f64, x); return v; }
+#endif
+
+// Constants
+inline V128 splat8(U08 value) {
+    return V128::from_u8(value);
+}
+
+inline V128 splat16(U16 value) {
+    V128 v;
+    for (Size i = 0; i < 8; i++) {
+        v.u16[i] = value;
+    }
+    return v;
+}
+
+inline V128 splat32(U32 value) {
+    V128 v;
+    for (Size i = 0; i < 4; i++) {
+        v.u32[i] = value;
+    }
+    return v;
+}
+
+// Logical operations
+inline V128 and_(const V128& a, const V128& b) {
+#if defined(NUCLEUS_ARCH_X86)
+    return store(_mm_and_si128(load(a), load(b)));
+#else
+    V128 r;
+    r.u64[0] = a.u64[0] & b.u64[0];
+    r.u64[1] = a.u64[1] & b.u64[1];
+    return r;
+#endif
+}
+
+inline V128 andc(const V128& a, const V128& b) {
+#if defined(NUCLEUS_ARCH_X86)
+    return store(_mm_andnot_si128(load(b), load(a)));
+#else
+    V128 r;
+    r.u64[0] = a.u64[0] & ~b.u64[0];
+    r.u64[1] = a.u64[1] & ~b.u64[1];
+    return r;
+#endif
+}
+
+inline V128 or_(const V128& a, const V128& b) {
+#if defined(NUCLEUS_ARCH_X86)
+    return store(_mm_or_si128(load(a), load(b)));
+#else
+    V128 r;
+    r.u64[0] = a.u64[0] | b.u64[0];
+    r.u64[1] = a.u64[1] | b.u64[1];
+    return r;
+#endif
+}
+
+inline V128 xor_(const V128& a, const V128& b) {
+#if defined(NUCLEUS_ARCH_X86)
+    return store(_mm_xor_si128(load(a), load(b)));
+#else
+    V128 r;
+    r.u64[0] = a.u64[0] ^ b.u64[0];
+    r.u64[1] = a.u64[1] ^ b.u64[1];
+    return r;
+#endif
+}
+
+inline V128 not_(const V128& a) {
+    return xor_(a, splat8(0xFF));
+}
+
+// Arithmetic operations
+inline V128 add16(const V128& a, const V128& b) {
+#if defined(NUCLEUS_ARCH_X86)
+    return store(_mm_add_epi16(load(a), load(b)));
+#else
+    V128 r;
+    for (Size i = 0; i < 8; i++) {
+        r.u16[i] = a.u16[i] + b.u16[i];
+    }
+    return r;
+#endif
+}
+
+inline V128 add32(const V128& a, const V128& b) {
+#if defined(NUCLEUS_ARCH_X86)
+    return store(_mm_add_epi32(load(a), load(b)));
+#else
+    V128 r;
+    for (Size i = 0; i < 4; i++) {
+        r.u32[i] = a.u32[i] + b.u32[i];
+    }
+    return r;
+#endif
+}
+
+inline V128 sub16(const V128& a, const V128& b) {
+#if defined(NUCLEUS_ARCH_X86)
+    return store(_mm_sub_epi16(load(a), load(b)));
+#else
+    V128 r;
+    for (Size i = 0; i < 8; i++) {
+        r.u16[i] = a.u16[i] - b.u16[i];
+    }
+    return r;
+#endif
+}
+
+inline V128 sub32(const V128& a, const V128& b) {
+#if defined(NUCLEUS_ARCH_X86)
+    return store(_mm_sub_epi32(load(a), load(b)));
+#else
+    V128 r;
+    for (Size i = 0; i < 4; i++) {
+        r.u32[i] = a.u32[i] - b.u32[i];
+    }
+    return r;
+#endif
+}
+
+// Comparisons: Each element of the result is all-ones if the condition holds, all-zeros otherwise
+inline V128 cmpeq8(const V128& a, const V128& b) {
+#if defined(NUCLEUS_ARCH_X86)
+    return store(_mm_cmpeq_epi8(load(a), load(b)));
+#else
+    V128 r;
+    for (Size i = 0; i < 16; i++) {
+        r.u8[i] = (a.u8[i] == b.u8[i]) ? 0xFF : 0;
+    }
+    return r;
+#endif
+}
+
+inline V128 cmpeq16(const V128& a, const V128& b) {
+#if defined(NUCLEUS_ARCH_X86)
+    return store(_mm_cmpeq_epi16(load(a), load(b)));
+#else
+    V128 r;
+    for (Size i = 0; i < 8; i++) {
+        r.u16[i] = (a.u16[i] == b.u16[i]) ? 0xFFFF : 0;
+    }
+    return r;
+#endif
+}
+
+inline V128 cmpeq32(const V128& a, const V128& b) {
+#if defined(NUCLEUS_ARCH_X86)
+    return store(_mm_cmpeq_epi32(load(a), load(b)));
+#else
+    V128 r;
+    for (Size i = 0; i < 4; i++) {
+        r.u32[i] = (a.u32[i] == b.u32[i]) ? 0xFFFFFFFF : 0;
+    }
+    return r;
+#endif
+}
+
+inline V128 cmpgt8(const V128& a, const V128& b) {
+#if defined(NUCLEUS_ARCH_X86)
+    return store(_mm_cmpgt_epi8(load(a), load(b)));
+#else
+    V128 r;
+    for (Size i = 0; i < 16; i++) {
+        r.u8[i] = (a.s8[i] > b.s8[i]) ? 0xFF : 0;
+    }
+    return r;
+#endif
+}
+
+inline V128 cmpgt16(const V128& a, const V128& b) {
+#if defined(NUCLEUS_ARCH_X86)
+    return store(_mm_cmpgt_epi16(load(a), load(b)));
+#else
+    V128 r;
+    for (Size i = 0; i < 8; i++) {
+        r.u16[i] = (a.s16[i] > b.s16[i]) ? 0xFFFF : 0;
+    }
+    return r;
+#endif
+}
+
+inline V128 cmpgt32(const V128& a, const V128& b) {
+#if defined(NUCLEUS_ARCH_X86)
+    return store(_mm_cmpgt_epi32(load(a), load(b)));
+#else
+    V128 r;
+    for (Size i = 0; i < 4; i++) {
+        r.u32[i] = (a.s32[i] > b.s32[i]) ? 0xFFFFFFFF : 0;
+    }
+    return r;
+#endif
+}
+
+// Unsigned comparisons flip the sign bit and reuse the signed ones
+inline V128 cmpgtu8(const V128& a, const V128& b) {
+    const V128 sign = splat8(0x80);
+    return cmpgt8(xor_(a, sign), xor_(b, sign));
+}
+
+inline V128 cmpgtu16(const V128& a, const V128& b) {
+    const V128 sign = splat16(0x8000);
+    return cmpgt16(xor_(a, sign), xor_(b, sign));
+}
+
+inline V128 cmpgtu32(const V128& a, const V128& b) {
+    const V128 sign = splat32(0x80000000);
+    return cmpgt32(xor_(a, sign), xor_(b, sign));
+}
+
+// Quadword shifts: The SPU byte 0 is the most significant byte of the host 128-bit value
+inline V128 shl128(const V128& a, U32 bits) {
+    V128 r;
+    if (bits == 0) {
+        return a;
+    } else if (bits < 64) {
+        r.u64[1] = (a.u64[1] << bits) | (a.u64[0] >> (64 - bits));
+        r.u64[0] = (a.u64[0] << bits);
+    } else if (bits < 128) {
+        r.u64[1] = (a.u64[0] << (bits - 64));
+        r.u64[0] = 0;
+    } else {
+        r.u64[1] = 0;
+        r.u64[0] = 0;
+    }
+    return r;
+}
+
+inline V128 shr128(const V128& a, U32 bits) {
+    V128 r;
+    if (bits == 0) {
+        return a;
+    } else if (bits < 64) {
+        r.u64[0] = (a.u64[0] >> bits) | (a.u64[1] << (64 - bits));
+        r.u64[1] = (a.u64[1] >> bits);
+    } else if (bits < 128) {
+        r.u64[0] = (a.u64[1] >> (bits - 64));
+        r.u64[1] = 0;
+    } else {
+        r.u64[0] = 0;
+        r.u64[1] = 0;
+    }
+    return r;
+}
+
+inline V128 rotl128(const V128& a, U32 bits) {
+    bits &= 127;
+    return bits ? or_(shl128(a, bits), shr128(a, 128 - bits)) : a;
+}
+
+}  // namespace vec
+}  // namespace spu
+}  // namespace frontend
+}  // namespace cpu
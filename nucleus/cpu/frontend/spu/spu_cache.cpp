@@ -0,0 +1,73 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "spu_cache.h"
+#include "nucleus/logger/logger.h"
+#include "nucleus/cpu/frontend/spu/spu_decoder.h"
+
+#include <cstring>
+
+// Global SPU program cache
+cpu::frontend::spu::ProgramCache spuProgramCache;
+
+namespace cpu {
+namespace frontend {
+namespace spu {
+
+U64 ProgramCache::hash(U32 addr, const void* code, U32 size) {
+    const auto* data = static_cast<const U08*>(code);
+
+    // 64-bit Fowler/Noll/Vo FNV-1a hash code
+    U64 hash = 0xCBF29CE484222325ULL;
+    hash ^= (U64(addr) << 32) | size;
+    hash += (hash << 1) + (hash << 4) + (hash << 5) + (hash << 7) + (hash << 8) + (hash << 40);
+    for (U32 offset = 0; offset + 8 <= size; offset += 8) {
+        U64 value;
+        memcpy(&value, data + offset, sizeof(value));
+        hash ^= value;
+        hash += (hash << 1) + (hash << 4) + (hash << 5) + (hash << 7) + (hash << 8) + (hash << 40);
+    }
+    for (U32 offset = size & ~7; offset < size; offset++) {
+        hash ^= data[offset];
+        hash += (hash << 1) + (hash << 4) + (hash << 5) + (hash << 7) + (hash << 8) + (hash << 40);
+    }
+    return hash;
+}
+
+Module* ProgramCache::find(U32 addr, const void* code, U32 size) {
+    const U64 key = hash(addr, code, size);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto range = entries.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it) {
+        const auto& entry = it->second;
+        if (entry.module->address == addr && entry.module->size == size &&
+            memcmp(entry.code.data(), code, size) == 0) {
+            hits++;
+            return entry.module;
+        }
+    }
+    misses++;
+    return nullptr;
+}
+
+void ProgramCache::insert(Module* module, const void* code) {
+    const auto* data = static_cast<const U08*>(code);
+    const U64 key = hash(module->address, code, module->size);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry entry;
+    entry.module = module;
+    entry.code.assign(data, data + module->size);
+    entries.emplace(key, std::move(entry));
+
+    logger.notice(LOG_CPU, "Cached SPU program %016llX at 0x%08X (%llu hits, %llu misses)",
+        static_cast<unsigned long long>(key), module->address,
+        static_cast<unsigned long long>(hits), static_cast<unsigned long long>(misses));
+}
+
+}  // namespace spu
+}  // namespace frontend
+}  // namespace cpu
@@ -0,0 +1,71 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace cpu {
+namespace frontend {
+namespace spu {
+
+// Forward declarations
+class Module;
+
+/**
+ * Cache of SPU programs indexed by the contents of the local-storage range they
+ * were loaded into. Games upload the same kernels over and over, and a cache hit
+ * gives back the module along with every function already analyzed and compiled.
+ * Translated code embeds the local-storage base address, so it is part of the key.
+ */
+class ProgramCache {
+    struct Entry {
+        Module* module;
+        std::vector<U08> code;  // Copy of the program, to rule out hash collisions
+    };
+
+    std::mutex mutex;
+    std::unordered_multimap<U64, Entry> entries;
+
+    // Statistics
+    U64 hits = 0;
+    U64 misses = 0;
+
+public:
+    /**
+     * Hash a program loaded in the local storage
+     * @param[in]  addr  Guest address where the program is loaded
+     * @param[in]  code  Pointer to the program
+     * @param[in]  size  Size of the program in bytes
+     * @return           64-bit hash of the address and contents
+     */
+    static U64 hash(U32 addr, const void* code, U32 size);
+
+    /**
+     * Find a previously loaded program with identical contents at the same address
+     * @param[in]  addr  Guest address where the program is loaded
+     * @param[in]  code  Pointer to the program
+     * @param[in]  size  Size of the program in bytes
+     * @return           Cached module, or nullptr if the program was not seen before
+     */
+    Module* find(U32 addr, const void* code, U32 size);
+
+    /**
+     * Register a new program. Its module must cover exactly the given code
+     * @param[in]  module  Module created for the program
+     * @param[in]  code    Pointer to the program
+     */
+    void insert(Module* module, const void* code);
+};
+
+}  // namespace spu
+}  // namespace frontend
+}  // namespace cpu
+
+extern cpu::frontend::spu::ProgramCache spuProgramCache;
@@ -6,6 +6,10 @@
 #pragma once
 
 #include "nucleus/common.h"
+#include "nucleus/core/futex.h"
+
+#include <atomic>
+#include <cstddef>
 
 namespace cpu {
 namespace frontend {
@@ -50,6 +54,13 @@ enum ChannelName {
  * =======
  * Represents a SPU channel. While its properties are implementation-defined,
  * at userland they always remain constant. So we set them at compile time.
+ *
+ * Entries are kept in a lock-free single-producer/single-consumer ring: the
+ * producer only advances `tail` and the consumer only advances `head`. Blocking
+ * channels park the waiting side on the opposite index with a futex, and the
+ * other side only issues a wakeup if someone announced itself in `waiters`.
+ * Non-blocking channels overwrite their newest entry when full and read as 0
+ * when empty.
  * @tparam  N  Channel entries
  * @tparam  B  Blocking channel
  */
@@ -59,23 +70,92 @@ class Channel {
     using Entry = U32;
 
     Entry data[N];
-    Size index;
+    std::atomic<U32> head{0};     // Number of entries read
+    std::atomic<U32> tail{0};     // Number of entries written
+    std::atomic<U32> waiters{0};  // Threads parked on this channel
+
+    void wake(std::atomic<U32>& index) {
+        if (waiters.load() != 0) {
+            core::futexWakeAll(index);
+        }
+    }
+
+    void wait(std::atomic<U32>& index, U32 value) {
+        waiters.fetch_add(1);
+        // Re-check after announcing ourselves, so that a concurrent wake is not missed
+        if (index.load() == value) {
+            core::futexWait(index, value);
+        }
+        waiters.fetch_sub(1);
+    }
 
 public:
+    // Offsets of the indices, for translated code reading the channel count inline
+    static constexpr U32 getHeadOffset() { return offsetof(Channel, head); }
+    static constexpr U32 getTailOffset() { return offsetof(Channel, tail); }
+
+    // Number of entries that can be read
     Size getCount() const {
-        return index + 1;
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    // Number of entries that can be written
+    Size getFree() const {
+        return N - getCount();
+    }
+
+    /**
+     * Read an entry without blocking (consumer side)
+     * @param[out]  entry  Entry read
+     * @return             False if the channel was empty
+     */
+    bool tryRead(Entry& entry) {
+        const U32 h = head.load(std::memory_order_relaxed);
+        if (tail.load(std::memory_order_acquire) == h) {
+            return false;
+        }
+        entry = data[h % N];
+        head.store(h + 1);
+        wake(head);
+        return true;
+    }
+
+    /**
+     * Write an entry without blocking (producer side)
+     * @param[in]  entry  Entry to write
+     * @return            False if the channel was full
+     */
+    bool tryWrite(Entry entry) {
+        const U32 t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == N) {
+            return false;
+        }
+        data[t % N] = entry;
+        tail.store(t + 1);
+        wake(tail);
+        return true;
     }
 
     Entry read() {
-        // TODO: Return data
-        return 0;
+        Entry entry;
+        while (!tryRead(entry)) {
+            if (!B) {
+                return 0;
+            }
+            wait(tail, head.load(std::memory_order_relaxed));
+        }
+        return entry;
     }
 
     void write(Entry entry) {
-        // TODO: Blocking
-        data[index] == entry;
-        if (index < N - 1) {
-            index += 1;
+        while (!tryWrite(entry)) {
+            if (!B) {
+                // Replace the newest entry
+                const U32 t = tail.load(std::memory_order_relaxed);
+                data[(t - 1) % N] = entry;
+                return;
+            }
+            wait(head, tail.load(std::memory_order_relaxed) - N);
         }
     }
 };
@@ -24,13 +24,21 @@ namespace spu {
 
 void nucleusTranslateSPU(void* guestFunc, U64 guestAddr) {
     auto* function = static_cast<frontend::spu::Function*>(guestFunc);
+    auto* hirFunction = function->hirFunction;
+
+    // Functions invalidated by guest writes are analyzed again from scratch
+    function->clearBlocks();
+    hirFunction->reset();
     function->analyze_cfg();
     function->recompile();
 
-    auto* hirFunction = function->hirFunction;
     auto* cpu = CPU::getCurrentThread()->parent;
     auto* state = static_cast<frontend::spu::SPUThread*>(CPU::getCurrentThread())->state.get();
     cpu->compiler->compile(hirFunction);
+    for (const auto& item : function->blocks) {
+        const auto* block = item.second;
+        cpu->registerCode(hirFunction, block->address, block->size);
+    }
     cpu->compiler->call(hirFunction, state);
 }
 
@@ -150,24 +158,29 @@ bool Function::analyze_cfg()
             code.value = parent->parent->memory->read32(addr);
         }
 
-        // Push new labels
+        // Push new labels (indirect branches are resolved through branch hints)
+        const auto& analyzer = static_cast<Module*>(parent)->analyzer;
         if (code.is_branch_conditional() && !code.is_call()) {
-            const U32 target_a = code.get_target(addr);
+            const U32 target_a = analyzer.getTarget(addr);
             const U32 target_b = addr + 4;
-            if (!parent->contains(target_a) || !parent->contains(target_b)) {
+            if ((target_a && !parent->contains(target_a)) || !parent->contains(target_b)) {
                 return false;
             }
-            labels.push(target_a);
+            if (target_a) {
+                labels.push(target_a);
+            }
             labels.push(target_b);
             current.branch_a = target_a;
             current.branch_b = target_b;
         }
         if (code.is_branch_unconditional() && !code.is_call()) {
-            const U32 target = code.get_target(addr);
-            if (!parent->contains(target)) {
+            const U32 target = analyzer.getTarget(addr);
+            if (target && !parent->contains(target)) {
                 return false;
             }
-            labels.push(target);
+            if (target) {
+                labels.push(target);
+            }
             current.branch_a = target;
         }
 
@@ -179,43 +192,9 @@ bool Function::analyze_cfg()
 
 void Function::analyze_type()
 {
-    // Determine function arguments/return types
-    /*Analyzer status;
-    do_register_analysis(&status);
-
-    // Determine type of function arguments
-    for (U32 reg = 0; reg < 13; reg++) {
-        if ((status.gpr[reg + 3] & REG_READ_ORIG) && reg < 8) {
-            type_in.push_back(FUNCTION_IN_INTEGER);
-        }
-        if ((status.fpr[reg + 1] & REG_READ_ORIG) && reg < 13) {
-            type_in.push_back(FUNCTION_IN_FLOAT);
-        }
-        if ((status.vr[reg + 2] & REG_READ_ORIG) && reg < 12) {
-            type_in.push_back(FUNCTION_IN_VECTOR);
-        }
-    }
-
-    // Determine type of function return
+    // SPU functions exchange values through the SPU state
+    type_in.clear();
     type_out = FUNCTION_OUT_VOID;
-    if (status.gpr[3] & REG_WRITE) {
-        type_out = FUNCTION_OUT_INTEGER;
-    }
-    if (status.vr[2] & REG_WRITE) {
-        type_out = FUNCTION_OUT_VECTOR;
-    }
-    if (status.fpr[1] & REG_WRITE) {
-        type_out = FUNCTION_OUT_FLOAT;
-        if (status.fpr[2] & REG_WRITE) {
-            type_out = FUNCTION_OUT_FLOAT_X2;
-        }
-        if (status.fpr[3] & REG_WRITE) {
-            type_out = FUNCTION_OUT_FLOAT_X3;
-        }
-        if (status.fpr[4] & REG_WRITE) {
-            type_out = FUNCTION_OUT_FLOAT_X4;
-        }
-    }*/
 }
 
 void Function::declare()
@@ -266,6 +245,7 @@ void Function::declare()
 
     // Declare function in module
     hirFunction = new hir::Function(hirModule, result, params);
+    hirFunction->name = format("spu_%05X", address);
 }
 
 void Function::recompile() {
@@ -294,15 +274,15 @@ void Function::recompile() {
         builder.setInsertPoint(recompiler.blocks[block.address]);
 
         // Get function (TODO: This gets loaded multiple times into the module)
-        hir::Function* logFunc = builder.getExternFunction(
-            nucleusLogSPU, hir::TYPE_VOID, {hir::TYPE_I64});
+        //hir::Function* logFunc = builder.getExternFunction(
+        //    nucleusLogSPU, hir::TYPE_VOID, {hir::TYPE_I64});
 
         for (U32 offset = 0; offset < block.size; offset += 4) {
             recompiler.currentAddress = block.address + offset;
             Instruction instr;
             instr.value = parent->parent->memory->read32(recompiler.currentAddress);
             auto method = get_entry(instr).recompile;
-            builder.createCall(logFunc, {builder.getConstantI64(recompiler.currentAddress)}, hir::CALL_EXTERN);
+            //builder.createCall(logFunc, {builder.getConstantI64(recompiler.currentAddress)}, hir::CALL_EXTERN);
             (recompiler.*method)(instr);
         }
 
@@ -336,83 +316,51 @@ void Function::createPlaceholder() {
 /**
  * SPU Module methods
  */
-Module::Module(CPU* parent) : frontend::Module<U32>(parent) {
+Module::Module(CPU* parent) : frontend::Module<U32>(parent), analyzer(this) {
 }
 
 Function* Module::addFunction(U32 addr) {
-    // Return function if already present
+    // Return function if already present, declaring it if the analyzer only listed it
     if (functions.find(addr) != functions.end()) {
-        return static_cast<Function*>(functions[addr]);
+        auto* function = static_cast<Function*>(functions[addr]);
+        if (!function->hirFunction) {
+            declareFunction(function);
+        }
+        return function;
     }
 
     // Create the function otherwise
     Function* function = new Function(this);
     function->name = format("func_%08X", addr);
     function->address = addr;
-    function->declare();
-    function->createPlaceholder();
-    parent->compiler->compile(function->hirFunction);
+    declareFunction(function);
 
     // Save and return the function
     functions[addr] = function;
     return function;
 }
 
-void Module::analyze() {
-    // Lists of labels
-    std::set<U32> labelBlocks;  // Detected immediately
-    std::set<U32> labelCalls;   // Direct target of a {bl*, bcl*} instruction (call)
-    std::set<U32> labelJumps;   // Direct or indirect target of a {b, ba, bc, bca} instruction (jump)
-
-    // Basic Block Slicing
-    U32 currentBlock = 0;
-    for (U32 i = address; i < (address + size); i += 4) {
-        Instruction instr;
-        instr.value = parent->memory->read32(i);
-
-        // New block appeared
-        if (currentBlock == 0 && instr.is_valid()) {
-            currentBlock = i;
-        }
-
-        // Block is corrupt
-        if (currentBlock != 0 && !instr.is_valid()) {
-            currentBlock = 0;
-        }
-
-        // Function call detected
-        if (currentBlock != 0 && instr.is_call()) {
-            labelCalls.insert(instr.get_target(i));
-        }
-
-        // Block finished
-        if (currentBlock != 0 && instr.is_branch() && !instr.is_call()) {
-            if (instr.is_branch_conditional()) {
-                labelJumps.insert(instr.get_target(i));
-                labelJumps.insert(i + 4);
-            }
-            if (instr.is_branch_unconditional()) {
-                labelJumps.insert(instr.get_target(i));
-            }
-            labelBlocks.insert(currentBlock);
-            currentBlock = 0;
-        }
-    }
+void Module::declareFunction(Function* function) {
+    function->declare();
+    function->createPlaceholder();
+    parent->compiler->compile(function->hirFunction);
+    function->hirFunction->stubAddress = function->hirFunction->nativeAddress.load();
+}
 
-    // Functions := ((Blocks \ Jumps) U Calls)
-    std::set<U32> labelFunctions;
-    std::set_difference(labelBlocks.begin(), labelBlocks.end(), labelJumps.begin(), labelJumps.end(), std::inserter(labelFunctions, labelFunctions.end()));
-    std::set_union(labelFunctions.begin(), labelFunctions.end(), labelCalls.begin(), labelCalls.end(), std::inserter(labelFunctions, labelFunctions.end()));
+void Module::analyze() {
+    analyzer.analyze();
+    analyzed = true;
 
     // List the functions and get their CFG
-    for (const auto& label : labelFunctions) {
-        if (this->contains(label)) {
-            Function function(this);
-            function.name = format("func_%X", label);
-            function.address = label;
-            if (function.analyze_cfg()) {
-                functions[label] = new Function(function);
-            }
+    for (const auto& label : analyzer.getFunctions()) {
+        if (functions.find(label) != functions.end()) {
+            continue;
+        }
+        Function function(this);
+        function.name = format("func_%X", label);
+        function.address = label;
+        if (function.analyze_cfg()) {
+            functions[label] = new Function(function);
         }
     }
     // Get type of every listed function
@@ -423,6 +371,29 @@ void Module::analyze() {
 }
 
 void Module::recompile() {
+    // Declare every function first, so that calls between them can be resolved
+    for (auto& item : functions) {
+        auto& function = static_cast<Function&>(*item.second);
+        if (function.hirFunction) {
+            continue;
+        }
+        declareFunction(&function);
+    }
+
+    // Translate the function bodies
+    for (auto& item : functions) {
+        auto& function = static_cast<Function&>(*item.second);
+        if (function.blocks.empty()) {
+            continue;
+        }
+        function.recompile();
+
+        auto* hirFunction = function.hirFunction;
+        parent->compiler->compile(hirFunction);
+        for (const auto& block : function.blocks) {
+            parent->registerCode(hirFunction, block.second->address, block.second->size);
+        }
+    }
 }
 
 void Module::hook(U32 funcAddr, U32 fnid) {
@@ -14,7 +14,7 @@
 #include "nucleus/cpu/frontend/frontend_block.h"
 #include "nucleus/cpu/frontend/frontend_function.h"
 #include "nucleus/cpu/frontend/frontend_module.h"
-//#include "nucleus/cpu/frontend/spu/analyzer/spu_analyzer.h"
+#include "nucleus/cpu/frontend/spu/analyzer/spu_analyzer.h"
 
 #include <map>
 #include <string>
@@ -91,15 +91,22 @@ public:
 
 class Module : public frontend::Module<U32> {
 public:
+    // Local-store analysis results
+    Analyzer analyzer;
+    bool analyzed = false;
+
     Function* addFunction(U32 addr);
 
+    // Declare a function and make it callable through a placeholder stub
+    void declareFunction(Function* function);
+
     // Constructor
     Module(CPU* parent);
 
     // Generate a list of functions and analyze them
     void analyze();
 
-    // Recompile each of the functions
+    // Recompile each of the functions, i.e. translate the whole program
     void recompile();
 
     // Replace a function with a HLE hook
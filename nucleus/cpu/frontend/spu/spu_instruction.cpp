@@ -87,11 +87,64 @@ bool Instruction::is_call() const {
     return false;
 }
 
+bool Instruction::is_call_known() const {
+    if ((op9  == 0x062) || // brasl
+        (op9  == 0x066)) { // brsl
+        return true;
+    }
+    return false;
+}
+
+bool Instruction::is_call_unknown() const {
+    if ((op11 == 0x1A9) || // bisl
+        (op11 == 0x1AB)) { // bisled
+        return true;
+    }
+    return false;
+}
+
+bool Instruction::is_jump() const {
+    return is_branch() && !is_call() && (op11 != 0x000); // stop
+}
+
+bool Instruction::is_jump_known() const {
+    if ((op9  == 0x040) || // brz
+        (op9  == 0x042) || // brnz
+        (op9  == 0x044) || // brhz
+        (op9  == 0x046) || // brhnz
+        (op9  == 0x060) || // bra
+        (op9  == 0x064)) { // br
+        return true;
+    }
+    return false;
+}
+
+bool Instruction::is_jump_unknown() const {
+    if ((op11 == 0x1A8) || // bi
+        (op11 == 0x128) || // biz
+        (op11 == 0x129) || // binz
+        (op11 == 0x12A) || // bihz
+        (op11 == 0x12B)) { // bihnz
+        return true;
+    }
+    return false;
+}
+
+bool Instruction::is_return() const {
+    // By convention, the link register is $0
+    if ((op11 == 0x1A8) && (ra == 0)) { // bi $lr
+        return true;
+    }
+    return false;
+}
+
 U32 Instruction::get_target(U32 currentAddr) const {
+    const U32 lsBase = currentAddr & ~0x3FFFF;
+
     // Absolute branches
     if ((op9  == 0x060) || // bra
         (op9  == 0x062)) { // brasl
-        return (currentAddr & 0xFF000000) + (i16 << 2);
+        return lsBase | ((i16 << 2) & 0x3FFFF);
     }
     // Relative branches
     if ((op9  == 0x040) || // brz
@@ -100,7 +153,35 @@ U32 Instruction::get_target(U32 currentAddr) const {
         (op9  == 0x046) || // brhnz
         (op9  == 0x064) || // br
         (op9  == 0x066)) { // brsl
-        return currentAddr + (i16 << 2);
+        return lsBase | ((currentAddr + (i16 << 2)) & 0x3FFFF);
+    }
+    return 0;
+}
+
+bool Instruction::is_hint() const {
+    if ((op7  == 0x008) || // hbra
+        (op7  == 0x009) || // hbrr
+        (op11 == 0x1AC)) { // hbr
+        return true;
+    }
+    return false;
+}
+
+U32 Instruction::get_hint_branch(U32 currentAddr) const {
+    // The branch offset is a signed 9-bit word offset split in two fields
+    const U32 high = (op11 == 0x1AC) ? roh_ : roh;
+    const S32 offset = static_cast<S32>(((high << 7) | rol) << 23) >> 23;
+    return (currentAddr & ~0x3FFFF) | ((currentAddr + (offset << 2)) & 0x3FFFF);
+}
+
+U32 Instruction::get_hint_target(U32 currentAddr) const {
+    const U32 lsBase = currentAddr & ~0x3FFFF;
+
+    if (op7 == 0x008) { // hbra
+        return lsBase | ((i16 << 2) & 0x3FFFF);
+    }
+    if (op7 == 0x009) { // hbrr
+        return lsBase | ((currentAddr + (i16 << 2)) & 0x3FFFF);
     }
     return 0;
 }
@@ -33,6 +33,7 @@ union Instruction
 
     // Instruction fields
     FIELD(11, 17, S32 i7);    // Immediate (7-bit)
+    FIELD(10, 17, U32 i8);    // Immediate (8-bit)
     FIELD( 8, 17, S32 i10);   // Immediate (10-bit)
     FIELD( 9, 24, S32 i16);   // Immediate (16-bit)
     FIELD( 7, 24, S32 i18);   // Immediate (18-bit)
@@ -42,6 +43,9 @@ union Instruction
     FIELD(25, 31, U32 rc);    // GPR: Source
     FIELD(25, 31, U32 rt);    // GPR: Destination
     FIELD( 4, 10, U32 rt_);   // GPR: Destination (RRR-Form)
+    FIELD( 7,  8, U32 roh);   // Hint: Branch offset high (hbra, hbrr)
+    FIELD(16, 17, U32 roh_);  // Hint: Branch offset high (hbr)
+    FIELD(25, 31, U32 rol);   // Hint: Branch offset low
 
     /**
      * SPU Instruction properties:
@@ -70,6 +74,15 @@ union Instruction
     // Obtain the target address if the branch is taken
     U32 get_target(U32 currentAddr) const;
 
+    // Determines whether the instruction is a hint-for-branch instruction
+    bool is_hint() const;
+
+    // Obtain the address of the branch instruction affected by the hint
+    U32 get_hint_branch(U32 currentAddr) const;
+
+    // Obtain the hinted target address (0 if it is only known at runtime)
+    U32 get_hint_target(U32 currentAddr) const;
+
 #undef FIELD
 };
 
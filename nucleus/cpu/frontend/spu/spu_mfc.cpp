@@ -0,0 +1,217 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "spu_mfc.h"
+#include "nucleus/core/config.h"
+#include "nucleus/cpu/frontend/spu/spu_state.h"
+#include "nucleus/cpu/frontend/spu/spu_thread.h"
+#include "nucleus/logger/logger.h"
+#include "nucleus/assert.h"
+
+#include <atomic>
+
+namespace cpu {
+namespace frontend {
+namespace spu {
+
+MFCQueue::MFCQueue(SPUThread* thread) : thread(thread) {
+}
+
+MFCQueue::~MFCQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+        cv.notify_all();
+    }
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+bool MFCQueue::execute(MFCRequest& request) {
+    switch (request.cmd & ~(MFC_BARRIER_ENABLE | MFC_FENCE_ENABLE)) {
+    case MFC_PUT_CMD:
+    case MFC_PUTR_CMD:
+    case MFC_GET_CMD:
+        thread->dmaTransfer(request.cmd, request.eal, request.lsa, request.size);
+        break;
+
+    case MFC_PUTL_CMD:
+    case MFC_PUTRL_CMD:
+    case MFC_GETL_CMD:
+        return thread->dmaTransferList(request);
+
+    case MFC_SNDSIG_CMD:
+        logger.warning(LOG_CPU, "MFC: Signal notification to 0x%08X is not supported", request.eal);
+        break;
+
+    case MFC_BARRIER_CMD:
+    case MFC_EIEIO_CMD:
+    case MFC_SYNC_CMD:
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        break;
+
+    default:
+        logger.error(LOG_CPU, "MFC: Unsupported command 0x%X", request.cmd);
+    }
+    return true;
+}
+
+void MFCQueue::stall(const MFCRequest& request) {
+    headStalled = true;
+    listStallStatus |= (1 << request.tag);
+    cv.notify_all();
+}
+
+void MFCQueue::work() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        cv.wait(lock, [&]{ return (!queue.empty() && !headStalled) || !running; });
+        if (!running) {
+            break;
+        }
+
+        // Keep the command in the queue while it runs, so that it counts as outstanding
+        MFCRequest request = queue.front();
+        lock.unlock();
+        const bool completed = execute(request);
+        lock.lock();
+
+        // Stalled lists resume from the remaining elements once acknowledged
+        if (!completed) {
+            queue.front() = request;
+            stall(request);
+            continue;
+        }
+        queue.pop_front();
+        pending[request.tag]--;
+        cv.notify_all();
+    }
+}
+
+U32 MFCQueue::getCompletedTags() const {
+    U32 completed = 0;
+    for (U32 tag = 0; tag < MFC_TAG_COUNT; tag++) {
+        if (pending[tag] == 0) {
+            completed |= (1 << tag);
+        }
+    }
+    return completed;
+}
+
+bool MFCQueue::isTagStatusReady() const {
+    const U32 completed = getCompletedTags() & tagMask;
+    switch (tagUpdate) {
+    case MFC_TAG_UPDATE_ANY:
+        return completed != 0 || tagMask == 0;
+    case MFC_TAG_UPDATE_ALL:
+        return completed == tagMask;
+    default:
+        return true;
+    }
+}
+
+void MFCQueue::push(const MFCRequest& request) {
+    assert_true(request.tag < MFC_TAG_COUNT);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    pending[request.tag]++;
+
+    // Run small commands in place if nothing else is in flight
+    if (queue.empty() && (!config.spuAsyncDma || request.size < MFC_ASYNC_THRESHOLD)) {
+        MFCRequest current = request;
+        lock.unlock();
+        const bool completed = execute(current);
+        lock.lock();
+        if (completed) {
+            pending[request.tag]--;
+            cv.notify_all();
+            return;
+        }
+
+        // The list stalled: the remaining elements are left to the worker
+        queue.push_back(current);
+        stall(current);
+        startWorker();
+        return;
+    }
+
+    cv.wait(lock, [&]{ return queue.size() < MFC_QUEUE_SIZE; });
+    queue.push_back(request);
+    startWorker();
+    cv.notify_all();
+}
+
+void MFCQueue::startWorker() {
+    if (!running) {
+        running = true;
+        worker = std::thread([this]{ work(); });
+    }
+}
+
+void MFCQueue::drain() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&]{ return queue.empty(); });
+}
+
+U32 MFCQueue::getFreeEntries() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return MFC_QUEUE_SIZE - static_cast<U32>(queue.size());
+}
+
+U32 MFCQueue::getTagMask() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return tagMask;
+}
+
+void MFCQueue::setTagMask(U32 mask) {
+    std::lock_guard<std::mutex> lock(mutex);
+    tagMask = mask;
+}
+
+void MFCQueue::setTagUpdate(U32 type) {
+    std::lock_guard<std::mutex> lock(mutex);
+    tagUpdate = type;
+}
+
+U32 MFCQueue::getTagStatusCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return isTagStatusReady() ? 1 : 0;
+}
+
+U32 MFCQueue::readTagStatus() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&]{ return isTagStatusReady(); });
+
+    // Conditional updates are consumed once reported
+    tagUpdate = MFC_TAG_UPDATE_IMMEDIATE;
+    return getCompletedTags() & tagMask;
+}
+
+void MFCQueue::acknowledgeStall(U32 tag) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (headStalled && !queue.empty() && queue.front().tag == (tag & 0x1F)) {
+        headStalled = false;
+        cv.notify_all();
+    }
+}
+
+U32 MFCQueue::getListStallStatusCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return listStallStatus ? 1 : 0;
+}
+
+U32 MFCQueue::readListStallStatus() {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&]{ return listStallStatus != 0; });
+
+    const U32 status = listStallStatus;
+    listStallStatus = 0;
+    return status;
+}
+
+}  // namespace spu
+}  // namespace frontend
+}  // namespace cpu
@@ -0,0 +1,130 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace cpu {
+namespace frontend {
+namespace spu {
+
+// Forward declarations
+class SPUThread;
+
+// MFC SPU command queue
+#define MFC_QUEUE_SIZE  16
+#define MFC_TAG_COUNT   32
+
+// Transfers of at least this size are handed over to the background worker, if enabled
+#define MFC_ASYNC_THRESHOLD  4_KB
+
+enum MFCTagUpdate {
+    MFC_TAG_UPDATE_IMMEDIATE  = 0,  // Report the status of the tag groups without waiting
+    MFC_TAG_UPDATE_ANY        = 1,  // Wait until any of the tag groups completes
+    MFC_TAG_UPDATE_ALL        = 2,  // Wait until all of the tag groups complete
+};
+
+enum MFCAtomicStatus {
+    MFC_PUTLLC_FAILURE  = 0x1,  // PUTLLC lost its reservation and did not store the line
+    MFC_PUTLLUC_SUCCESS = 0x2,  // PUTLLUC completed
+    MFC_GETLLAR_SUCCESS = 0x4,  // GETLLAR completed
+};
+
+struct MFCRequest {
+    U32 cmd;   // Command opcode
+    U32 tag;   // Tag group ID
+    U32 lsa;   // Guest address of the local storage buffer
+    U32 eal;   // Effective address (or list address)
+    U32 size;  // Transfer size (or list size)
+};
+
+/**
+ * MFC command queue
+ * =================
+ * Commands are completed in issue order. This is one of the valid schedules of the real
+ * MFC and it implicitly satisfies every fence and barrier. A list command that reaches an
+ * element with the stall-and-notify flag stays at the head of the queue, blocking later
+ * commands, until the SPU acknowledges the stall of its tag group. Small commands issued while the
+ * queue is idle run immediately on the SPU thread, others are executed by a worker thread
+ * so that SPU code can overlap computation with its transfers.
+ */
+class MFCQueue {
+    SPUThread* thread;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<MFCRequest> queue;  // Commands issued but not yet completed
+    U32 pending[MFC_TAG_COUNT] = {};  // Number of outstanding commands per tag group
+
+    // Background worker
+    std::thread worker;
+    bool running = false;
+
+    // Tag group status
+    U32 tagMask = 0;
+    U32 tagUpdate = MFC_TAG_UPDATE_IMMEDIATE;
+
+    // List stall-and-notify
+    bool headStalled = false;  // Head of the queue is a list waiting for MFC_WrListStallAck
+    U32 listStallStatus = 0;   // Tag groups with a stalled list not yet reported to the SPU
+
+    /**
+     * Perform the command
+     * @param[in,out]  request  Command, updated to the remaining elements if a list stalls
+     * @return                  False if the command stalled and must be resumed later
+     */
+    bool execute(MFCRequest& request);
+
+    // Mark the list at the head of the queue as stalled (the mutex must be held)
+    void stall(const MFCRequest& request);
+
+    // Start the worker thread if it is not running yet (the mutex must be held)
+    void startWorker();
+
+    // Worker thread loop
+    void work();
+
+    // Get a mask of the tag groups with no outstanding commands
+    U32 getCompletedTags() const;
+
+    // Check whether the requested tag status update can be reported
+    bool isTagStatusReady() const;
+
+public:
+    MFCQueue(SPUThread* thread);
+    ~MFCQueue();
+
+    /**
+     * Issue a command, blocking the caller if the queue is full
+     * @param[in]  request  Command to enqueue
+     */
+    void push(const MFCRequest& request);
+
+    // Block until every issued command has completed
+    void drain();
+
+    /**
+     * Channel interface
+     */
+    U32 getFreeEntries();
+    U32 getTagMask();
+    void setTagMask(U32 mask);
+    void setTagUpdate(U32 type);
+    U32 getTagStatusCount();
+    U32 readTagStatus();
+    void acknowledgeStall(U32 tag);
+    U32 getListStallStatusCount();
+    U32 readListStallStatus();
+};
+
+}  // namespace spu
+}  // namespace frontend
+}  // namespace cpu
@@ -0,0 +1,47 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "spu_scheduler.h"
+
+// Global SPU scheduler
+cpu::frontend::spu::Scheduler spuScheduler;
+
+namespace cpu {
+namespace frontend {
+namespace spu {
+
+Scheduler::Scheduler(U32 count) : freeCount(count) {
+}
+
+void Scheduler::acquire(SPUThread* thread) {
+    std::unique_lock<std::mutex> lock(mutex);
+    waiting.push_back(thread);
+    waitingCount++;
+    cv.wait(lock, [&]{ return freeCount > 0 && waiting.front() == thread; });
+    waiting.pop_front();
+    waitingCount--;
+    freeCount--;
+
+    // Another SPU might still be free for the next thread in line
+    cv.notify_all();
+}
+
+void Scheduler::release(SPUThread* thread) {
+    std::lock_guard<std::mutex> lock(mutex);
+    freeCount++;
+    cv.notify_all();
+}
+
+void Scheduler::yield(SPUThread* thread) {
+    if (waitingCount.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    release(thread);
+    acquire(thread);
+}
+
+}  // namespace spu
+}  // namespace frontend
+}  // namespace cpu
@@ -0,0 +1,89 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace cpu {
+namespace frontend {
+namespace spu {
+
+// Forward declarations
+class SPUThread;
+
+// Number of physical SPUs available to user applications
+#define SPU_PHYSICAL_COUNT  6
+
+/**
+ * SPU scheduler
+ * =============
+ * Maps guest SPU threads onto a bounded number of physical SPUs. A thread must own
+ * one of the SPUs to execute code, and gives it up whenever it blocks on a channel,
+ * so that parked threads never compete with running ones for host cores. Threads
+ * waiting for an SPU are served in FIFO order, and interpreted threads yield theirs
+ * at the end of each time slice if someone else is waiting.
+ */
+class Scheduler {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<SPUThread*> waiting;  // Threads waiting for a physical SPU
+    std::atomic<U32> waitingCount{0};
+    U32 freeCount;
+
+public:
+    Scheduler(U32 count = SPU_PHYSICAL_COUNT);
+
+    /**
+     * Block until a physical SPU is assigned to the thread
+     * @param[in]  thread  Thread requesting a SPU
+     */
+    void acquire(SPUThread* thread);
+
+    /**
+     * Give up the physical SPU owned by the thread
+     * @param[in]  thread  Thread owning a SPU
+     */
+    void release(SPUThread* thread);
+
+    /**
+     * Hand over the SPU owned by the thread if other threads are waiting
+     * @param[in]  thread  Thread owning a SPU
+     */
+    void yield(SPUThread* thread);
+
+    /**
+     * Releases the SPU of a thread for the lifetime of this object, if requested
+     */
+    class Suspension {
+        Scheduler& scheduler;
+        SPUThread* thread;
+        bool active;
+
+    public:
+        Suspension(Scheduler& scheduler, SPUThread* thread, bool active)
+            : scheduler(scheduler), thread(thread), active(active) {
+            if (active) {
+                scheduler.release(thread);
+            }
+        }
+        ~Suspension() {
+            if (active) {
+                scheduler.acquire(thread);
+            }
+        }
+    };
+};
+
+}  // namespace spu
+}  // namespace frontend
+}  // namespace cpu
+
+extern cpu::frontend::spu::Scheduler spuScheduler;
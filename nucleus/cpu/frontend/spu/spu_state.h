@@ -105,8 +105,8 @@ public:
     Channel<1, false> chListStallStat; // MFC List Stall-and-Notify Tag Acknowledgment
     Channel<1, false> chAtomicStat;    // MFC Atomic Command Status
     Channel<4,  true> chInMbox;        // SPU Inbound Mailbox
-    Channel<1,  true> chOutMbox;       // SPU Outbound Mailbox
-    Channel<1,  true> chOutIntrMbox;   // SPU Outbound Interrupt Mailbox
+    Channel<1, false> chOutMbox;       // SPU Outbound Mailbox (no PPU reader yet, so it never blocks)
+    Channel<1, false> chOutIntrMbox;   // SPU Outbound Interrupt Mailbox (no PPU reader yet, so it never blocks)
     Channel<1,  true> chSigNotify1;    // SPU Signal Notification Register 1
     Channel<1,  true> chSigNotify2;    // SPU Signal Notification Register 2
 };
@@ -6,10 +6,10 @@
 #include "spu_tables.h"
 
 // Instruction entry
-#define INSTRUCTION(name) { ENTRY_INSTRUCTION, nullptr, #name, &Translator::name }
+#define INSTRUCTION(name) { ENTRY_INSTRUCTION, nullptr, #name, &Translator::name, &Interpreter::name }
 
 // Table entry
-# define TABLE(caller) { ENTRY_TABLE, caller, nullptr, nullptr }
+# define TABLE(caller) { ENTRY_TABLE, caller, nullptr, nullptr, nullptr }
 
 namespace cpu {
 namespace frontend {
@@ -7,6 +7,7 @@
 
 #include "nucleus/common.h"
 #include "nucleus/cpu/frontend/spu/spu_instruction.h"
+#include "nucleus/cpu/frontend/spu/interpreter/spu_interpreter.h"
 #include "nucleus/cpu/frontend/spu/translator/spu_translator.h"
 
 #include <string>
@@ -34,6 +35,7 @@ struct Entry
     // Instruction data
     const char* name;
     void (Translator::*recompile)(Instruction);
+    void (Interpreter::*interpret)(Instruction);
 };
 
 // Instruction callers
@@ -8,6 +8,10 @@
 #include "nucleus/cpu/cell.h"
 #include "nucleus/cpu/frontend/spu/spu_state.h"
 #include "nucleus/cpu/frontend/spu/spu_decoder.h"
+#include "nucleus/cpu/frontend/spu/spu_mfc.h"
+#include "nucleus/cpu/frontend/spu/spu_scheduler.h"
+#include "nucleus/cpu/frontend/spu/interpreter/spu_interpreter.h"
+#include "nucleus/memory/reservation.h"
 #include "nucleus/assert.h"
 
 #ifdef NUCLEUS_ARCH_X86
@@ -26,22 +30,67 @@ namespace spu {
 
 SPUThread::SPUThread(CPU* parent) : Thread(parent) {
     state = std::make_unique<SPUState>();
+    mfcQueue = std::make_unique<MFCQueue>(this);
+}
+
+SPUThread::~SPUThread() {
 }
 
 void SPUThread::start() {
     m_thread = std::thread([&](){
         parent->setCurrentThread(this);
+        spuScheduler.acquire(this);
         task();
+        spuScheduler.release(this);
     });
 }
 
 void SPUThread::task() {
-     if (config.spuTranslator & CPU_TRANSLATOR_FUNCTION) {
-        for (auto* spu_segment : static_cast<Cell*>(parent)->spu_modules) {
+    // Calls from promoted functions go straight to the translator
+    if ((config.spuTranslator & CPU_TRANSLATOR_INSTRUCTION) && !(interpreter && interpreter->native)) {
+        if (!interpreter) {
+            interpreter = std::make_unique<Interpreter>(parent, this);
+        }
+        interpreter->halted = false;
+        while (!interpreter->halted) {
+            // Handle events
+            if (m_event) {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                if (m_event == NUCLEUS_EVENT_PAUSE) {
+                    spuScheduler.release(this);
+                    m_status = NUCLEUS_STATUS_PAUSED;
+                    m_cv.wait(lock, [&]{ return m_event == NUCLEUS_EVENT_RUN; });
+                    m_status = NUCLEUS_STATUS_RUNNING;
+                    lock.unlock();
+                    spuScheduler.acquire(this);
+                    lock.lock();
+                }
+                if (m_event == NUCLEUS_EVENT_STOP) {
+                    break;
+                }
+                m_event = NUCLEUS_EVENT_NONE;
+            }
+            parent->flushCodeWrites();
+            interpreter->run(1024);
+            spuScheduler.yield(this);
+        }
+        return;
+    }
+    if (config.spuTranslator & (CPU_TRANSLATOR_FUNCTION | CPU_TRANSLATOR_MODULE)) {
+        parent->flushCodeWrites();
+        for (auto* spu_segment : modules) {
             if (!spu_segment->contains(state->pc)) {
                 continue;
             }
 
+            // Analyze the local storage once, translating the whole program if requested
+            if (!spu_segment->analyzed) {
+                spu_segment->analyze();
+                if (config.spuTranslator & CPU_TRANSLATOR_MODULE) {
+                    spu_segment->recompile();
+                }
+            }
+
             auto* function = spu_segment->addFunction(state->pc);
             auto* hirFunction = function->hirFunction;
             if (!(hirFunction->flags & hir::FUNCTION_IS_COMPILED)) {
@@ -69,8 +118,122 @@ void SPUThread::stop() {
     m_event = NUCLEUS_EVENT_STOP;
 }
 
+U32 SPUThread::readChannel(U32 ch) {
+    // Give up the physical SPU while the channel blocks
+    Scheduler::Suspension suspension(spuScheduler, this, getChannelCount(ch) == 0);
+
+    switch (ch) {
+    case SPU_RdInMbox:
+        return state->chInMbox.read();
+    case SPU_RdSigNotify1:
+        return state->chSigNotify1.read();
+    case SPU_RdSigNotify2:
+        return state->chSigNotify2.read();
+    case MFC_LSA:
+        return state->mfc.lsa;
+    case MFC_EAH:
+        return state->mfc.eah;
+    case MFC_EAL:
+        return state->mfc.eal;
+    case MFC_Size:
+        return state->mfc.size;
+    case MFC_RdTagMask:
+        return mfcQueue->getTagMask();
+    case MFC_RdTagStat:
+        return mfcQueue->readTagStatus();
+    case MFC_RdListStallStat:
+        return mfcQueue->readListStallStatus();
+    case MFC_RdAtomicStat:
+        atomicStatusPending = false;
+        return atomicStatus;
+    default:
+        assert_always("Unimplemented");
+        return 0;
+    }
+}
+
+void SPUThread::writeChannel(U32 ch, U32 value) {
+    // Give up the physical SPU while the channel blocks
+    Scheduler::Suspension suspension(spuScheduler, this, getChannelCount(ch) == 0);
+
+    switch (ch) {
+    case SPU_WrOutMbox:
+        state->chOutMbox.write(value);
+        break;
+    case SPU_WrOutIntrMbox:
+        state->chOutIntrMbox.write(value);
+        break;
+    case MFC_LSA:
+        assert_true(value < 0x40000);
+        state->mfc.lsa = value;
+        break;
+    case MFC_EAH:
+        state->mfc.eah = value;
+        break;
+    case MFC_EAL:
+        state->mfc.eal = value;
+        break;
+    case MFC_Size:
+        assert_true(value <= 16_KB);
+        state->mfc.size = value;
+        break;
+    case MFC_TagID:
+        state->mfc.tag = value;
+        break;
+    case MFC_Cmd:
+        mfcCommand(value);
+        break;
+    case MFC_WrTagMask:
+        mfcQueue->setTagMask(value);
+        break;
+    case MFC_WrTagUpdate:
+        mfcQueue->setTagUpdate(value);
+        break;
+    case MFC_WrListStallAck:
+        mfcQueue->acknowledgeStall(value);
+        break;
+    default:
+        assert_always("Unimplemented");
+    }
+}
+
+U32 SPUThread::getChannelCount(U32 ch) {
+    switch (ch) {
+    case SPU_WrOutMbox:        // Outbound mailboxes replace their pending entry, so they are always writable
+    case SPU_WrOutIntrMbox:    return 1;
+    case SPU_RdInMbox:         return state->chInMbox.getCount();
+    case MFC_RdTagStat:        return mfcQueue->getTagStatusCount();
+    case MFC_Cmd:              return mfcQueue->getFreeEntries();
+    case MFC_LSA:
+    case MFC_EAH:
+    case MFC_EAL:
+    case MFC_Size:
+    case MFC_TagID:
+    case MFC_RdTagMask:
+    case MFC_WrTagMask:
+    case MFC_WrTagUpdate:
+    case MFC_WrListStallAck:   return 1;
+    case MFC_RdListStallStat:  return mfcQueue->getListStallStatusCount();
+    case SPU_RdSigNotify1:     return state->chSigNotify1.getCount();
+    case SPU_RdSigNotify2:     return state->chSigNotify2.getCount();
+    case MFC_RdAtomicStat:     return atomicStatusPending ? 1 : 0;
+    default:
+        assert_always("Unimplemented");
+        return 0;
+    }
+}
+
 void SPUThread::mfcCommand(U32 cmd) {
     const auto& mfc = state->mfc;
+
+    // Transfers refer to the local storage this thread is running on
+    MFCRequest request;
+    request.cmd = cmd;
+    request.tag = mfc.tag & 0x1F;
+    request.lsa = (state->pc & ~0x3FFFF) | (mfc.lsa & 0x3FFFF);
+    request.eal = mfc.eal;
+    request.size = mfc.size;
+
     switch (cmd) {
     case MFC_PUT_CMD:
     case MFC_PUTB_CMD:
@@ -81,7 +244,11 @@ void SPUThread::mfcCommand(U32 cmd) {
     case MFC_GET_CMD:
     case MFC_GETB_CMD:
     case MFC_GETF_CMD:
-        dmaTransfer(cmd, mfc.eal, mfc.lsa, mfc.size);
+        // Code fetched by the transfer must be decoded again
+        if (interpreter && (cmd & MFC_GET_CMD)) {
+            interpreter->invalidate(request.lsa, request.size);
+        }
+        mfcQueue->push(request);
         break;
 
     case MFC_PUTL_CMD:
@@ -93,7 +260,35 @@ void SPUThread::mfcCommand(U32 cmd) {
     case MFC_GETL_CMD:
     case MFC_GETLB_CMD:
     case MFC_GETLF_CMD:
-        dmaTransferList(cmd, mfc.eal, mfc.lsa, mfc.size);
+        if (interpreter && (cmd & MFC_GET_CMD)) {
+            const auto* list = parent->memory->ptr<MFCListElement>((request.lsa & ~0x3FFFF) | (request.eal & 0x3FFF8));
+            U32 lsa = request.lsa;
+            for (U32 i = 0; i < request.size / sizeof(MFCListElement); i++) {
+                interpreter->invalidate(lsa, list[i].lts & 0x7FFF);
+                lsa += list[i].lts & 0x7FFF;
+            }
+        }
+        mfcQueue->push(request);
+        break;
+
+    case MFC_GETLLAR_CMD:
+    case MFC_PUTLLC_CMD:
+    case MFC_PUTLLUC_CMD:
+    case MFC_PUTQLLUC_CMD:
+        // Only the queued variant is ordered after the outstanding transfers
+        if (cmd == MFC_PUTQLLUC_CMD) {
+            mfcQueue->drain();
+        }
+        atomicCommand(cmd, request.eal, (state->pc & ~0x3FFFF) | (mfc.lsa & 0x3FF80));
+        break;
+
+    case MFC_SNDSIG_CMD:
+    case MFC_SNDSIGB_CMD:
+    case MFC_SNDSIGF_CMD:
+    case MFC_BARRIER_CMD:
+    case MFC_EIEIO_CMD:
+    case MFC_SYNC_CMD:
+        mfcQueue->push(request);
         break;
 
     default:
@@ -113,31 +308,123 @@ void SPUThread::dmaTransfer(U32 cmd, U32 eal, U32 lsa, U32 size) {
     case MFC_PUT_CMD:
     case MFC_PUTR_CMD:
         memcpy(memory->ptr(eal), memory->ptr(lsa), size);
+        memory->getReservations().notify(eal, size);
         break;
     case MFC_GET_CMD:
         memcpy(memory->ptr(lsa), memory->ptr(eal), size);
         break;
     default:
-        assert_true("Unexpected");
+        assert_always("Unexpected");
+    }
+}
+
+void SPUThread::atomicCommand(U32 cmd, U32 eal, U32 lsa) {
+    const auto& memory = parent->memory;
+    auto& reservations = memory->getReservations();
+
+    eal &= ~RESERVATION_LINE_MASK;
+    U08* line = memory->ptr<U08>(eal);
+    U08* ls = memory->ptr<U08>(lsa);
+
+    switch (cmd) {
+    case MFC_GETLLAR_CMD:
+        // Retry if a store completed while copying the line
+        do {
+            reservation.version = reservations.acquire(eal);
+            std::memcpy(reservation.data, line, RESERVATION_LINE_SIZE);
+        } while (!reservations.check(eal, reservation.version));
+        reservation.addr = eal;
+        reservation.valid = true;
+
+        std::memcpy(ls, reservation.data, RESERVATION_LINE_SIZE);
+        if (interpreter) {
+            interpreter->invalidate(lsa, RESERVATION_LINE_SIZE);
+        }
+        atomicStatus = MFC_GETLLAR_SUCCESS;
+        break;
+
+    case MFC_PUTLLC_CMD: {
+        bool success = reservation.valid && reservation.addr == eal && reservations.lock(eal, reservation.version);
+        if (success) {
+            // Plain stores do not update the line version, so compare the reserved data as well
+            success = std::memcmp(line, reservation.data, RESERVATION_LINE_SIZE) == 0;
+            if (success) {
+                std::memcpy(line, ls, RESERVATION_LINE_SIZE);
+            }
+            reservations.unlock(eal, success);
+        }
+        reservation.valid = false;
+        atomicStatus = success ? 0 : MFC_PUTLLC_FAILURE;
+        break;
+    }
+
+    case MFC_PUTLLUC_CMD:
+    case MFC_PUTQLLUC_CMD:
+        reservations.lock(eal);
+        std::memcpy(line, ls, RESERVATION_LINE_SIZE);
+        reservations.unlock(eal);
+        if (reservation.addr == eal) {
+            reservation.valid = false;
+        }
+        if (cmd == MFC_PUTQLLUC_CMD) {
+            return;
+        }
+        atomicStatus = MFC_PUTLLUC_SUCCESS;
+        break;
     }
+    atomicStatusPending = true;
 }
 
-void SPUThread::dmaTransferList(U32 cmd, U32 eal, U32 lsa, U32 size) {
-    const U32 listAddr = eal & 0x3ffff;
-    const U32 listSize = size / 8;
+bool SPUThread::dmaTransferList(MFCRequest& request) {
+    const U32 lsBase = request.lsa & ~0x3FFFF;
+    const U32 listAddr = lsBase | (request.eal & 0x3FFF8);
+    const U32 listSize = request.size / sizeof(MFCListElement);
+
+    // Each element is transferred as the equivalent non-list command
+    const U32 cmd = request.cmd & ~MFC_LIST_ENABLE;
 
     const auto& memory = parent->memory;
     const auto* list = memory->ptr<MFCListElement>(listAddr);
 
-    for (Size i = 0; i < listSize; i++) {
+    // Contiguous elements are coalesced into a single transfer
+    U32 runEal = 0;
+    U32 runLsa = request.lsa;
+    U32 runSize = 0;
+
+    U32 lsa = request.lsa;
+    for (U32 i = 0; i < listSize; i++) {
         const auto& entry = list[i];
-        if (entry.lts) {
-            dmaTransfer(cmd, entry.leal, lsa, entry.lts);
+        const U32 lts = entry.lts & 0x7FFF;
+        const U32 leal = entry.leal;
+        if (runSize && (runEal + runSize != leal || runLsa + runSize != lsa)) {
+            dmaTransfer(cmd, runEal, runLsa, runSize);
+            runSize = 0;
         }
-        if (entry.s) {
-            assert_always("Unimplemented");
+        if (lts) {
+            if (!runSize) {
+                runEal = leal;
+                runLsa = lsa;
+            }
+            runSize += lts;
         }
+        lsa = lsBase | ((lsa + lts) & 0x3FFFF);
+
+        // Stall the list after this element until the SPU acknowledges it. A stall on the
+        // last element is also reported, and the list completes once it is acknowledged.
+        if (entry.s & 0x8000) {
+            if (runSize) {
+                dmaTransfer(cmd, runEal, runLsa, runSize);
+            }
+            request.eal += (i + 1) * sizeof(MFCListElement);
+            request.size -= (i + 1) * sizeof(MFCListElement);
+            request.lsa = lsa;
+            return false;
+        }
+    }
+    if (runSize) {
+        dmaTransfer(cmd, runEal, runLsa, runSize);
     }
+    return true;
 }
 
 }  // namespace spu
@@ -8,16 +8,29 @@
 #include "nucleus/common.h"
 #include "nucleus/cpu/thread.h"
 
+#include <vector>
+
 namespace cpu {
 namespace frontend {
 namespace spu {
 
 // Forward declarations
+class Interpreter;
+class MFCQueue;
+struct MFCRequest;
+class Module;
 class SPUState;
 
 class SPUThread : public Thread {
 public:
     std::unique_ptr<SPUState> state;
+    std::unique_ptr<MFCQueue> mfcQueue;
+
+    // Programs loaded in the local storage of this thread
+    std::vector<Module*> modules;
+
+    // Interpreter, created on demand if enabled in the SPU translator settings
+    std::unique_ptr<Interpreter> interpreter;
 
     SPUThread(CPU* parent = nullptr);
     ~SPUThread();
@@ -30,9 +43,40 @@ public:
     virtual void pause() override;
     virtual void stop() override;
 
+    // Channels
+    U32 readChannel(U32 ch);
+    void writeChannel(U32 ch, U32 value);
+    U32 getChannelCount(U32 ch);
+
     void mfcCommand(U32 cmd);
+
+    // Lock-line reservation taken by GETLLAR
+    struct {
+        U32 addr;
+        U64 version;
+        U08 data[128];
+        bool valid = false;
+    } reservation;
+
+    // Status of the last atomic command, reported through MFC_RdAtomicStat
+    U32 atomicStatus = 0;
+    bool atomicStatusPending = false;
+
+    /**
+     * Perform an atomic lock-line command (GETLLAR, PUTLLC, PUTLLUC, PUTQLLUC)
+     * @param[in]  cmd  Command opcode
+     * @param[in]  eal  Effective address of the 128-byte line
+     * @param[in]  lsa  Guest address of the local storage buffer
+     */
+    void atomicCommand(U32 cmd, U32 eal, U32 lsa);
     void dmaTransfer(U32 cmd, U32 eal, U32 lsa, U32 size);
-    void dmaTransferList(U32 cmd, U32 eal, U32 lsa, U32 size);
+
+    /**
+     * Process the elements of a DMA list command
+     * @param[in,out]  request  List command, updated to the remaining elements if it stalls (possibly none)
+     * @return                  False if the list stalled on an element with the stall-and-notify flag
+     */
+    bool dmaTransferList(MFCRequest& request);
 };
 
 }  // namespace ppu
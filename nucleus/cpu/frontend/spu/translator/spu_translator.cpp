@@ -4,6 +4,7 @@
  */
 
 #include "spu_translator.h"
+#include "nucleus/cpu/backend/compiler.h"
 #include "nucleus/cpu/frontend/spu/spu_state.h"
 #include "nucleus/core/config.h"
 #include "nucleus/assert.h"
@@ -46,26 +47,51 @@ void Translator::setSPR(int index, hir::Value* value) {
 }
 
 /**
- * Memory access
+ * Local storage access
+ * The local storage of the thread running this code is the 256 KB window of guest memory
+ * containing the current address. Addresses only need to be masked to wrap around the
+ * local storage and to select an aligned quadword, which lets the backend emit aligned
+ * vector moves. If the backend supports fastmem, accesses take the resulting guest address
+ * relative to the pinned guest memory base, so that no host address is baked into the code.
  */
-Value* Translator::readMemory(hir::Value* addr, hir::Type type) {
-    assert_true(type == TYPE_V128);
+Value* Translator::getLocalStorageAddress(Value* lsAddr) {
+    const U32 lsBase = currentAddress & ~0x3FFFF;
+
+    Value* addr;
+    if (lsAddr->isConstant()) {
+        addr = builder.getConstantI32(lsBase | (lsAddr->constant.i32 & 0x3FFF0));
+    } else {
+        addr = builder.createAnd(lsAddr, builder.getConstantI32(0x3FFF0));
+        addr = builder.createOr(addr, builder.getConstantI32(lsBase));
+    }
+    addr = builder.createZExt(addr, TYPE_PTR);
+    if (parent->compiler->guestMemory) {
+        return addr;
+    }
 
     // Get host address
     void* baseAddress = parent->memory->getBaseAddr();
-    addr = builder.createZExt(addr, TYPE_PTR);
-    addr = builder.createAdd(addr, builder.getConstantPointer(baseAddress));
-    return builder.createLoad(addr, type, ENDIAN_BIG);
+    return builder.createAdd(addr, builder.getConstantPointer(baseAddress));
+}
+
+MemoryFlags Translator::getLocalStorageFlags() const {
+    OpcodeFlags flags = ENDIAN_BIG | ACCESS_ALIGNED;
+    if (parent->compiler->guestMemory) {
+        flags |= ACCESS_GUEST;
+    }
+    return MemoryFlags(flags);
 }
 
-void Translator::writeMemory(Value* addr, Value* value) {
+Value* Translator::readLocalStorage(Value* lsAddr) {
+    Value* addr = getLocalStorageAddress(lsAddr);
+    return builder.createLoad(addr, TYPE_V128, getLocalStorageFlags());
+}
+
+void Translator::writeLocalStorage(Value* lsAddr, Value* value) {
     assert_true(value->type == TYPE_V128);
 
-    // Get host address
-    void* baseAddress = parent->memory->getBaseAddr();
-    addr = builder.createZExt(addr, TYPE_PTR);
-    addr = builder.createAdd(addr, builder.getConstantPointer(baseAddress));
-    builder.createStore(addr, value, ENDIAN_BIG);
+    Value* addr = getLocalStorageAddress(lsAddr);
+    builder.createStore(addr, value, getLocalStorageFlags());
 }
 
 void Translator::createProlog() {
@@ -77,9 +103,8 @@ void Translator::createEpilog() {
     epilog = new hir::Block(function->hirFunction);
     builder.setInsertPoint(epilog);
 
-    if (config.spuTranslator != CPU_TRANSLATOR_MODULE) {
-        builder.createRet();
-    }
+    // SPU functions always return to their caller, even when translating whole programs
+    builder.createRet();
 }
 
 
@@ -28,9 +28,18 @@ private:
     void setGPR(int index, hir::Value* value);
     void setSPR(int index, hir::Value* value);
 
-    // Memory access
-    hir::Value* readMemory(hir::Value* addr, hir::Type type);
-    void writeMemory(hir::Value* addr, hir::Value* value);
+    // Local storage access
+    hir::Value* getLocalStorageAddress(hir::Value* lsAddr);
+    hir::MemoryFlags getLocalStorageFlags() const;
+    hir::Value* readLocalStorage(hir::Value* lsAddr);
+    void writeLocalStorage(hir::Value* lsAddr, hir::Value* value);
+
+    // Branching
+    hir::Value* getBranchTarget(int index);
+    hir::Value* getLinkValue();
+    void createIndirectJump(hir::Value* target);
+    void createIndirectCall(hir::Value* target);
+    void createIndirectBranchCond(Instruction code, hir::Value* cond);
 
 public:
     hir::Builder builder;
@@ -33,6 +33,85 @@ void nucleusCallSPU(U64 guestAddr) {
     thread->task();
 }
 
+/**
+ * Branching
+ */
+Value* Translator::getBranchTarget(int index) {
+    Value* ps = builder.createExtract(getGPR(index), builder.getConstantI8(3), TYPE_I32);
+    ps = builder.createAnd(ps, builder.getConstantI32(0x3FFFC));
+    return builder.createOr(ps, builder.getConstantI32(currentAddress & ~0x3FFFF));
+}
+
+Value* Translator::getLinkValue() {
+    V128 value = {};
+    value.u32[3] = (currentAddress + 4) & 0x3FFFF;
+    return builder.getConstantV128(value);
+}
+
+void Translator::createIndirectJump(Value* target) {
+    auto* module = static_cast<Module*>(function->parent);
+
+    // Jump straight to the hinted block if the prediction holds
+    const U32 hint = module->analyzer.getTarget(currentAddress);
+    if (hint && blocks.find(hint) != blocks.end()) {
+        hir::Block* miss = new hir::Block(function->hirFunction);
+        Value* cond = builder.createCmpEQ(target, builder.getConstantI32(hint));
+        builder.createBrCond(cond, blocks.at(hint), miss);
+        builder.setInsertPoint(miss);
+    }
+
+    // Otherwise, leave the function by tail-calling the target
+    hir::Function* proxyFunc = builder.getExternFunction(nucleusCallSPU, TYPE_VOID, { TYPE_I32 });
+    builder.createCall(proxyFunc, { target }, hir::CALL_EXTERN);
+    builder.createRet();
+}
+
+void Translator::createIndirectCall(Value* target) {
+    auto* module = static_cast<Module*>(function->parent);
+
+    // Call the hinted function directly if the prediction holds
+    hir::Block* done = nullptr;
+    const U32 hint = module->analyzer.getTarget(currentAddress);
+    if (hint && module->contains(hint)) {
+        if (config.spuTranslator & CPU_TRANSLATOR_IS_JIT) {
+            module->addFunction(hint);
+        }
+        const auto it = module->functions.find(hint);
+        if (it != module->functions.end() && it->second->hirFunction) {
+            hir::Block* hit = new hir::Block(function->hirFunction);
+            hir::Block* miss = new hir::Block(function->hirFunction);
+            done = new hir::Block(function->hirFunction);
+
+            Value* cond = builder.createCmpEQ(target, builder.getConstantI32(hint));
+            builder.createBrCond(cond, hit, miss);
+            builder.setInsertPoint(hit);
+            builder.createCall(it->second->hirFunction);
+            builder.createBr(done);
+            builder.setInsertPoint(miss);
+        }
+    }
+
+    hir::Function* proxyFunc = builder.getExternFunction(nucleusCallSPU, TYPE_VOID, { TYPE_I32 });
+    builder.createCall(proxyFunc, { target }, hir::CALL_EXTERN);
+    if (done) {
+        builder.createBr(done);
+        builder.setInsertPoint(done);
+    }
+}
+
+void Translator::createIndirectBranchCond(Instruction code, Value* cond) {
+    const U32 nextAddr = currentAddress + 4;
+
+    hir::Block* taken = new hir::Block(function->hirFunction);
+    builder.createBrCond(cond, taken, blocks.at(nextAddr));
+    builder.setInsertPoint(taken);
+    if (code.ra == 0) {
+        builder.createRet();
+    } else {
+        createIndirectJump(getBranchTarget(code.ra));
+    }
+}
+
 /**
  * SPU Instructions:
  *  - Compare, Branch and Halt Instructions (Chapter 7)
@@ -42,32 +121,39 @@ void nucleusCallSPU(U64 guestAddr) {
 // Compare, Branch and Halt Instructions (Chapter 7)
 void Translator::bi(Instruction code)
 {
-    builder.createRet();
+    if (code.is_return()) {
+        builder.createRet();
+        return;
+    }
+    createIndirectJump(getBranchTarget(code.ra));
 }
 
 void Translator::bihnz(Instruction code)
 {
-    assert_always("Unimplemented");
+    Value* ps = builder.createExtract(getGPR(code.rt), builder.getConstantI8(7), TYPE_I16);
+    Value* cond = builder.createCmpNE(ps, builder.getConstantI16(0));
+    createIndirectBranchCond(code, cond);
 }
 
 void Translator::bihz(Instruction code)
 {
-    assert_always("Unimplemented");
+    Value* ps = builder.createExtract(getGPR(code.rt), builder.getConstantI8(7), TYPE_I16);
+    Value* cond = builder.createCmpEQ(ps, builder.getConstantI16(0));
+    createIndirectBranchCond(code, cond);
 }
 
 void Translator::binz(Instruction code)
 {
-    assert_always("Unimplemented");
+    Value* ps = builder.createExtract(getGPR(code.rt), builder.getConstantI8(3), TYPE_I32);
+    Value* cond = builder.createCmpNE(ps, builder.getConstantI32(0));
+    createIndirectBranchCond(code, cond);
 }
 
 void Translator::bisl(Instruction code)
 {
-    Value* ra = getGPR(code.ra);
-    Value* ps = builder.createExtract(ra, builder.getConstantI8(3), TYPE_I32);
-    Value* addr = builder.createOr(ps, builder.getConstantI32(currentAddress & ~0x3FFFF));
-
-    hir::Function* proxyFunc = builder.getExternFunction(nucleusCallSPU, TYPE_VOID, { TYPE_I32 });
-    builder.createCall(proxyFunc, { addr }, hir::CALL_EXTERN);
+    Value* target = getBranchTarget(code.ra);
+    setGPR(code.rt, getLinkValue());
+    createIndirectCall(target);
 }
 
 void Translator::bisled(Instruction code)
@@ -77,22 +163,34 @@ void Translator::bisled(Instruction code)
 
 void Translator::biz(Instruction code)
 {
-    assert_always("Unimplemented");
+    Value* ps = builder.createExtract(getGPR(code.rt), builder.getConstantI8(3), TYPE_I32);
+    Value* cond = builder.createCmpEQ(ps, builder.getConstantI32(0));
+    createIndirectBranchCond(code, cond);
 }
 
 void Translator::br(Instruction code)
 {
-    assert_always("Unimplemented");
+    const U32 targetAddr = code.get_target(currentAddress);
+    builder.createBr(blocks.at(targetAddr));
 }
 
 void Translator::bra(Instruction code)
 {
-    assert_always("Unimplemented");
+    const U32 targetAddr = code.get_target(currentAddress);
+    builder.createBr(blocks.at(targetAddr));
 }
 
 void Translator::brasl(Instruction code)
 {
-    assert_always("Unimplemented");
+    const U32 targetAddr = code.get_target(currentAddress);
+    setGPR(code.rt, getLinkValue());
+
+    Module* module = static_cast<Module*>(function->parent);
+    if (config.spuTranslator & CPU_TRANSLATOR_IS_JIT) {
+        module->addFunction(targetAddr);
+    }
+    auto& targetFunc = static_cast<Function&>(*module->functions.at(targetAddr));
+    builder.createCall(targetFunc.hirFunction);
 }
 
 void Translator::brhnz(Instruction code)
@@ -133,10 +231,8 @@ void Translator::brnz(Instruction code)
 
 void Translator::brsl(Instruction code)
 {
-    const U32 targetAddr = currentAddress + (code.i16 << 2);
-
-    Value* rt = builder.getConstantI32(currentAddress + 4);
-    setGPR(code.rt, rt);
+    const U32 targetAddr = code.get_target(currentAddress);
+    setGPR(code.rt, getLinkValue());
 
     Module* module = static_cast<Module*>(function->parent);
     if (config.spuTranslator & CPU_TRANSLATOR_IS_JIT) {
@@ -386,23 +482,20 @@ void Translator::iret(Instruction code)
 // Hint-for-Branch Instructions (Chapter 8)
 void Translator::hbr(Instruction code)
 {
-    // NOTE: Not implemented.
-    // Although there is no need to translate these branch hints,
-    // its translation could result in performance improvements.
+    // NOTE: Branch hints are consumed by the analyzer, which uses them
+    // to resolve the targets of indirect branches at translation time.
 }
 
 void Translator::hbra(Instruction code)
 {
-    // NOTE: Not implemented.
-    // Although there is no need to translate these branch hints,
-    // its translation could result in performance improvements.
+    // NOTE: Branch hints are consumed by the analyzer, which uses them
+    // to resolve the targets of indirect branches at translation time.
 }
 
 void Translator::hbrr(Instruction code)
 {
-    // NOTE: Not implemented.
-    // Although there is no need to translate these branch hints,
-    // its translation could result in performance improvements.
+    // NOTE: Branch hints are consumed by the analyzer, which uses them
+    // to resolve the targets of indirect branches at translation time.
 }
 
 }  // namespace spu
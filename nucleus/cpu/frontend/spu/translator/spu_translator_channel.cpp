@@ -5,6 +5,7 @@
 
 #include "spu_translator.h"
 #include "nucleus/assert.h"
+#include "nucleus/cpu/frontend/spu/spu_channel.h"
 #include "nucleus/cpu/frontend/spu/spu_state.h"
 #include "nucleus/cpu/frontend/spu/spu_thread.h"
 
@@ -30,82 +31,104 @@ using namespace cpu::hir;
  *  - Channel Instructions (Chapter 11)
  */
 
+/**
+ * Channels backed by plain registers in the SPU state are accessed inline, and so
+ * are the counts of the mailboxes. Anything that might block, or that depends on
+ * the MFC queue, calls out to the thread.
+ */
+#define CHANNEL_OFFSET(channel, index) \
+    (offsetof(SPUState, channel) + decltype(SPUState::channel)::get##index##Offset())
+
+// Build a register holding the value in its preferred slot
+static Value* createPreferredSlot(Builder& builder, Value* value) {
+    return builder.createInsert(builder.getConstantV128(V128{}), builder.getConstantI8(3), value);
+}
+
 // Channel Instructions (Chapter 11)
 void Translator::rchcnt(Instruction code)
 {
-    INTERPRET({
-        U32& rt = state.r[i.rt].u32[3];
-        switch (i.ca) {
-        case SPU_WrOutMbox:        rt = state.chOutMbox.getCount();       break;
-        case SPU_WrOutIntrMbox:    rt = state.chOutIntrMbox.getCount();   break;
-        case SPU_RdInMbox:         rt = state.chInMbox.getCount();        break;
-        case MFC_RdTagStat:        rt = state.chTagStat.getCount();       break;
-        case MFC_RdListStallStat:  rt = state.chListStallStat.getCount(); break;
-        case SPU_RdSigNotify1:     rt = state.chSigNotify1.getCount();    break;
-        case SPU_RdSigNotify2:     rt = state.chSigNotify2.getCount();    break;
-        case MFC_RdAtomicStat:     rt = state.chAtomicStat.getCount();    break;
-        default:
-            assert_always("Unimplemented");
-        }
-    });
+    Value* count = nullptr;
+    switch (code.ca) {
+    case MFC_LSA:
+    case MFC_EAH:
+    case MFC_EAL:
+    case MFC_Size:
+    case MFC_TagID:
+    case MFC_RdTagMask:
+    case MFC_WrTagMask:
+    case MFC_WrTagUpdate:
+    case MFC_WrListStallAck:
+    case SPU_WrOutMbox:
+    case SPU_WrOutIntrMbox:
+        count = builder.getConstantI32(1);
+        break;
+
+    case SPU_RdInMbox:
+        count = builder.createSub(
+            builder.createCtxLoad(CHANNEL_OFFSET(chInMbox, Tail), TYPE_I32),
+            builder.createCtxLoad(CHANNEL_OFFSET(chInMbox, Head), TYPE_I32));
+        break;
+
+    default:
+        INTERPRET({
+            state.r[i.rt].u32[3] = thread.getChannelCount(i.ca);
+        });
+        return;
+    }
+    setGPR(code.rt, createPreferredSlot(builder, count));
 }
 
 void Translator::rdch(Instruction code)
 {
-    INTERPRET({
-        U32& result = state.r[i.rt].u32[3];
-        switch (i.ca) {
-        case MFC_LSA:
-            result = state.mfc.lsa;
-            break;
-        case MFC_EAH:
-            result = state.mfc.eah;
-            break;
-        case MFC_EAL:
-            result = state.mfc.eal;
-            break;
-        case MFC_Size:
-            result = state.mfc.size;
-            break;
-        default:
-            assert_always("Unimplemented");
-        }
-    });
+    Value* value = nullptr;
+    switch (code.ca) {
+    case MFC_LSA:
+        value = builder.createCtxLoad(offsetof(SPUState, mfc.lsa), TYPE_I32);
+        break;
+    case MFC_EAH:
+        value = builder.createCtxLoad(offsetof(SPUState, mfc.eah), TYPE_I32);
+        break;
+    case MFC_EAL:
+        value = builder.createCtxLoad(offsetof(SPUState, mfc.eal), TYPE_I32);
+        break;
+    case MFC_Size:
+        value = builder.createZExt(builder.createCtxLoad(offsetof(SPUState, mfc.size), TYPE_I16), TYPE_I32);
+        break;
+
+    default:
+        INTERPRET({
+            state.r[i.rt].u32[3] = thread.readChannel(i.ca);
+        });
+        return;
+    }
+    setGPR(code.rt, createPreferredSlot(builder, value));
 }
 
 void Translator::wrch(Instruction code)
 {
-    INTERPRET({
-        U32 value = state.r[i.rt].u32[3];
-        switch (i.ca) {
-        case MFC_LSA:
-            assert_true(value < 0x40000);
-            state.mfc.lsa = value;
-            break;
-        case MFC_EAH:
-            state.mfc.eah = value;
-            break;
-        case MFC_EAL:
-            state.mfc.eal = value;
-            break;
-        case MFC_Size:
-            assert_true(value <= 16_KB);
-            state.mfc.size = value;
-            break;
-        case MFC_TagID:
-            state.mfc.tag = value;
-            break;
-        case MFC_Cmd:
-            thread.mfcCommand(value);
-            break;
-        case MFC_WrTagMask:
-            assert_always("Unimplemented");
-            break;
-        case MFC_WrTagUpdate:
-        default:
-            assert_always("Unimplemented");
-        }
-    });
+    Value* rt = builder.createExtract(getGPR(code.rt), builder.getConstantI8(3), TYPE_I32);
+    switch (code.ca) {
+    case MFC_LSA:
+        builder.createCtxStore(offsetof(SPUState, mfc.lsa), builder.createAnd(rt, builder.getConstantI32(0x3FFFF)));
+        break;
+    case MFC_EAH:
+        builder.createCtxStore(offsetof(SPUState, mfc.eah), rt);
+        break;
+    case MFC_EAL:
+        builder.createCtxStore(offsetof(SPUState, mfc.eal), rt);
+        break;
+    case MFC_Size:
+        builder.createCtxStore(offsetof(SPUState, mfc.size), builder.createTrunc(rt, TYPE_I16));
+        break;
+    case MFC_TagID:
+        builder.createCtxStore(offsetof(SPUState, mfc.tag), builder.createTrunc(rt, TYPE_I16));
+        break;
+
+    default:
+        INTERPRET({
+            thread.writeChannel(i.ca, state.r[i.rt].u32[3]);
+        });
+    }
 }
 
 }  // namespace spu
@@ -154,11 +154,8 @@ void Translator::cwx(Instruction code)
 
 void Translator::lqa(Instruction code)
 {
-    U32 lsAddr = (code.i16 << 2) & 0x3FFFF;
-    U32 lsBase = currentAddress & ~0x3FFFF;
-    Value* addr = builder.getConstantI32((lsBase + lsAddr) & ~0xF);
-
-    Value* rt = readMemory(addr, TYPE_V128);
+    Value* addr = builder.getConstantI32(code.i16 << 2);
+    Value* rt = readLocalStorage(addr);
     setGPR(code.rt, rt);
 }
 
@@ -167,17 +164,17 @@ void Translator::lqd(Instruction code)
     Value* ra = getGPR(code.ra);
     Value* rt;
 
-    Value* addr = builder.getConstantI32((code.i10 << 4) + (currentAddress & ~0x3FFFF));
+    Value* addr = builder.getConstantI32(code.i10 << 4);
     addr = builder.createAdd(addr, builder.createExtract(ra, builder.getConstantI8(3), TYPE_I32));
-    rt = readMemory(addr, TYPE_V128);
+    rt = readLocalStorage(addr);
 
     setGPR(code.rt, rt);
 }
 
 void Translator::lqr(Instruction code)
 {
-    Value* addr = builder.getConstantI32(((code.i16 << 2) + currentAddress) & ~0xF);
-    Value* rt = readMemory(addr, TYPE_V128);
+    Value* addr = builder.getConstantI32((code.i16 << 2) + currentAddress);
+    Value* rt = readLocalStorage(addr);
     setGPR(code.rt, rt);
 }
 
@@ -187,39 +184,36 @@ void Translator::lqx(Instruction code)
     Value* rb = getGPR(code.rb);
     Value* rt;
 
-    Value* addr = builder.getConstantI32(currentAddress & ~0x3FFFF);
-    addr = builder.createAdd(addr, builder.createExtract(ra, builder.getConstantI8(3), TYPE_I32));
-    addr = builder.createAdd(addr, builder.createExtract(rb, builder.getConstantI8(3), TYPE_I32));
-    addr = builder.createAnd(addr, builder.getConstantI32(~0xF));
-    rt = readMemory(addr, TYPE_V128);
+    Value* addr = builder.createAdd(
+        builder.createExtract(ra, builder.getConstantI8(3), TYPE_I32),
+        builder.createExtract(rb, builder.getConstantI8(3), TYPE_I32));
+    rt = readLocalStorage(addr);
 
     setGPR(code.rt, rt);
 }
 
 void Translator::stqa(Instruction code)
 {
-    U32 lsAddr = (code.i16 << 2) & 0x3FFFF;
-    U32 lsBase = currentAddress & ~0x3FFFF;
-    Value* addr = builder.getConstantI32((lsBase + lsAddr) & ~0xF);
-
+    Value* addr = builder.getConstantI32(code.i16 << 2);
     Value* rt = getGPR(code.rt);
-    writeMemory(addr, rt);
+    writeLocalStorage(addr, rt);
 }
 
 void Translator::stqd(Instruction code)
 {
     Value* ra = getGPR(code.ra);
     Value* rt = getGPR(code.rt);
-    Value* addr = builder.getConstantI32((code.i10 << 4) + (currentAddress & ~0x3FFFF));
+
+    Value* addr = builder.getConstantI32(code.i10 << 4);
     addr = builder.createAdd(addr, builder.createExtract(ra, builder.getConstantI8(3), TYPE_I32));
-    writeMemory(addr, rt);
+    writeLocalStorage(addr, rt);
 }
 
 void Translator::stqr(Instruction code)
 {
     Value* rt = getGPR(code.rt);
-    Value* addr = builder.getConstantI32(((code.i16 << 2) + currentAddress) & ~0xF);
-    writeMemory(addr, rt);
+    Value* addr = builder.getConstantI32((code.i16 << 2) + currentAddress);
+    writeLocalStorage(addr, rt);
 }
 
 void Translator::stqx(Instruction code)
@@ -228,12 +222,10 @@ void Translator::stqx(Instruction code)
     Value* rb = getGPR(code.rb);
     Value* rt = getGPR(code.rt);
 
-    Value* addr = builder.getConstantI32(currentAddress & ~0x3FFFF);
-    addr = builder.createAdd(addr, builder.createExtract(ra, builder.getConstantI8(3), TYPE_I32));
-    addr = builder.createAdd(addr, builder.createExtract(rb, builder.getConstantI8(3), TYPE_I32));
-    addr = builder.createAnd(addr, builder.getConstantI32(~0xF));
-
-    writeMemory(addr, rt);
+    Value* addr = builder.createAdd(
+        builder.createExtract(ra, builder.getConstantI8(3), TYPE_I32),
+        builder.createExtract(rb, builder.getConstantI8(3), TYPE_I32));
+    writeLocalStorage(addr, rt);
 }
 
 }  // namespace spu
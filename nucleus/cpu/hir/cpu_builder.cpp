@@ -134,7 +134,7 @@ Function* Builder::getExternFunction(void* hostAddr, Type typeOut, const std::ve
     }
 
     externFunc->flags |= FUNCTION_IS_EXTERN;
-    externFunc->nativeAddress = hostAddr;
+    externFunc->nativeAddress.store(hostAddr);
     return externFunc;
 }
 
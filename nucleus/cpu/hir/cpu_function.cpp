@@ -11,14 +11,18 @@ namespace cpu {
 namespace hir {
 
 Function::Function(Module* parent, TypeOut tOut, TypeIn tIn)
-    : parent(parent), typeOut(tOut), typeIn(tIn), flags(0), nativeAddress(nullptr) {
+    : parent(parent), typeOut(tOut), typeIn(tIn), flags(0), nativeAddress(nullptr), stubAddress(nullptr) {
     // Set flags
     flags |= FUNCTION_IS_DECLARED;
 
     // Argument values
     for (auto type : tIn) {
         Value* value = new Value();
+        value->parent.function = this;
         value->type = type;
+        value->flags = VALUE_IS_ARGUMENT;
+        value->usage = 0;
+        value->reg = 0;
         args.push_back(value);
     }
 
@@ -41,9 +45,20 @@ S32 Function::getId() {
 
 void Function::reset() {
     flags = FUNCTION_IS_DECLARED;
+    for (auto block : blocks) {
+        delete block;
+    }
     blocks.clear();
 }
 
+void Function::invalidate() {
+    // Threads still running the previous code will finish executing it,
+    // so the old native code is intentionally not released here
+    if (stubAddress) {
+        nativeAddress.store(stubAddress, std::memory_order_release);
+    }
+}
+
 std::string Function::dump() {
     std::string output;
     output += "f" + std::to_string(getId()) + "() {\n";
@@ -4,11 +4,149 @@
  */
 
 #include "module.h"
+#include "nucleus/cpu/hir/block.h"
 #include "nucleus/cpu/hir/function.h"
+#include "nucleus/cpu/hir/instruction.h"
+#include "nucleus/format.h"
+#include "nucleus/filesystem/filesystem_host.h"
+#include "nucleus/logger/logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
 
 namespace cpu {
 namespace hir {
 
+/**
+ * Binary HIR format
+ * =================
+ * All fields are stored in little-endian byte order. Strings are stored as a U32 length
+ * followed by its characters. Version must be increased on any change to this layout,
+ * to the opcode list or to the meaning of the opcode flags.
+ *
+ *   Header:     U32 magic, U32 version, U32 opcodeCount, String name, U32 functionCount
+ *   Functions:  For each function (declarations first, so calls can reference any function):
+ *                 String name, U32 flags, U08 typeOut, U32 argCount, U08 typeIn[argCount],
+ *                 U64 nativeAddress (only meaningful for extern functions in the saving process)
+ *   Bodies:     For each function:
+ *                 U32 valueCount, U08 valueType[valueCount], U32 blockCount,
+ *                 For each block: U32 flags, U32 instrCount, Instruction[instrCount]
+ *   Instruction: U16 opcode, U32 flags, U32 dest, Operand src1, Operand src2, Operand src3
+ *
+ * Values are indexed per function: arguments first, followed by the destination values
+ * of the instructions. Operands are encoded according to the opcode signature:
+ *   Value/Maybe:  U08 kind (0: None, 1: Value, 2: Constant), followed by
+ *                 U32 index if kind is Value or U08 type and raw bytes if kind is Constant
+ *   Immediate:    U64 immediate
+ *   Block:        U32 block index
+ *   Function:     U32 function index
+ */
+#define HIR_FORMAT_MAGIC    0x5249484E  // "NHIR"
+#define HIR_FORMAT_VERSION  1
+#define HIR_INDEX_NONE      0xFFFFFFFF
+
+enum OperandKind : U08 {
+    OPERAND_KIND_NONE = 0,
+    OPERAND_KIND_VALUE = 1,
+    OPERAND_KIND_CONSTANT = 2,
+};
+
+static Size getTypeSize(Type type) {
+    switch (type) {
+    case TYPE_I8:   return 1;
+    case TYPE_I16:  return 2;
+    case TYPE_I32:  return 4;
+    case TYPE_I64:  return 8;
+    case TYPE_F32:  return 4;
+    case TYPE_F64:  return 8;
+    case TYPE_V128: return 16;
+    case TYPE_V256: return 32;
+    default:
+        return 0;
+    }
+}
+
+static bool isValueSignature(U08 sigType) {
+    return sigType == OPCODE_SIG_TYPE_V || sigType == OPCODE_SIG_TYPE_M;
+}
+
+class ModuleWriter {
+    std::vector<U08>& buffer;
+
+public:
+    ModuleWriter(std::vector<U08>& buffer) : buffer(buffer) {}
+
+    template <typename T>
+    void write(T value) {
+        const auto* bytes = reinterpret_cast<const U08*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+    void writeBytes(const void* data, Size size) {
+        const auto* bytes = static_cast<const U08*>(data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+    void writeString(const std::string& str) {
+        write<U32>(str.size());
+        writeBytes(str.data(), str.size());
+    }
+};
+
+class ModuleReader {
+    const U08* data;
+    Size size;
+    Size offset = 0;
+
+public:
+    // Set if any read went out of bounds
+    bool failed = false;
+
+    ModuleReader(const U08* data, Size size) : data(data), size(size) {}
+
+    template <typename T>
+    T read() {
+        T value = {};
+        readBytes(&value, sizeof(T));
+        return value;
+    }
+    void readBytes(void* dst, Size count) {
+        if (failed || count > size - offset) {
+            failed = true;
+            return;
+        }
+        memcpy(dst, data + offset, count);
+        offset += count;
+    }
+    Size remaining() const {
+        return size - offset;
+    }
+    std::string readString() {
+        const U32 length = read<U32>();
+        if (failed || length > size - offset) {
+            failed = true;
+            return "";
+        }
+        std::string str(reinterpret_cast<const char*>(data + offset), length);
+        offset += length;
+        return str;
+    }
+};
+
+// Live modules, in creation order
+static std::mutex modulesMutex;
+static std::vector<Module*> modules;
+
+Module::Module() {
+    std::lock_guard<std::mutex> lock(modulesMutex);
+    modules.push_back(this);
+}
+
+Module::~Module() {
+    std::lock_guard<std::mutex> lock(modulesMutex);
+    modules.erase(std::remove(modules.begin(), modules.end(), this), modules.end());
+}
+
 bool Module::addFunction(Function* function) {
     functions.push_back(function);
     return true;
@@ -22,5 +160,300 @@ std::string Module::dump() const {
     return output;
 }
 
+std::vector<U08> Module::serialize() const {
+    std::vector<U08> buffer;
+    ModuleWriter w(buffer);
+
+    // Header
+    w.write<U32>(HIR_FORMAT_MAGIC);
+    w.write<U32>(HIR_FORMAT_VERSION);
+    w.write<U32>(__OPCODE_COUNT);
+    w.writeString(name);
+    w.write<U32>(functions.size());
+
+    // Function declarations
+    std::map<const Function*, U32> functionIndex;
+    for (const auto* function : functions) {
+        functionIndex.emplace(function, functionIndex.size());
+        w.writeString(function->name);
+        w.write<U32>(function->flags & (FUNCTION_IS_EXTERN | FUNCTION_IS_DECLARED | FUNCTION_IS_DEFINED));
+        w.write<U08>(function->typeOut);
+        w.write<U32>(function->typeIn.size());
+        for (auto type : function->typeIn) {
+            w.write<U08>(type);
+        }
+        const bool isExtern = function->flags & FUNCTION_IS_EXTERN;
+        w.write<U64>(isExtern ? reinterpret_cast<U64>(function->nativeAddress.load()) : 0);
+    }
+
+    // Function bodies
+    for (const auto* function : functions) {
+        std::map<const Block*, U32> blockIndex;
+        std::map<const Value*, U32> valueIndex;
+        std::vector<U08> valueTypes;
+        for (const auto* arg : function->args) {
+            valueIndex.emplace(arg, valueIndex.size());
+        }
+        for (const auto* block : function->blocks) {
+            blockIndex.emplace(block, blockIndex.size());
+            for (const auto* instr : block->instructions) {
+                if (instr->dest && valueIndex.find(instr->dest) == valueIndex.end()) {
+                    valueIndex.emplace(instr->dest, valueIndex.size());
+                    valueTypes.push_back(instr->dest->type);
+                }
+            }
+        }
+
+        w.write<U32>(valueTypes.size());
+        w.writeBytes(valueTypes.data(), valueTypes.size());
+        w.write<U32>(function->blocks.size());
+        for (const auto* block : function->blocks) {
+            w.write<U32>(block->flags);
+            w.write<U32>(block->instructions.size());
+            for (const auto* instr : block->instructions) {
+                const auto& opInfo = opcodeInfo[instr->opcode];
+                w.write<U16>(instr->opcode);
+                w.write<U32>(instr->flags);
+                w.write<U32>(instr->dest ? valueIndex[instr->dest] : HIR_INDEX_NONE);
+
+                const U08 sigTypes[3] = {
+                    opInfo.getSignatureSrc1(), opInfo.getSignatureSrc2(), opInfo.getSignatureSrc3() };
+                const Instruction::Operand* operands[3] = { &instr->src1, &instr->src2, &instr->src3 };
+                for (int i = 0; i < 3; i++) {
+                    const auto& operand = *operands[i];
+                    if (isValueSignature(sigTypes[i])) {
+                        const Value* value = operand.value;
+                        if (!value) {
+                            w.write<U08>(OPERAND_KIND_NONE);
+                        } else if (value->isConstant()) {
+                            w.write<U08>(OPERAND_KIND_CONSTANT);
+                            w.write<U08>(value->type);
+                            w.writeBytes(&value->constant, getTypeSize(value->type));
+                        } else {
+                            w.write<U08>(OPERAND_KIND_VALUE);
+                            w.write<U32>(valueIndex.at(value));
+                        }
+                    } else if (sigTypes[i] == OPCODE_SIG_TYPE_I) {
+                        w.write<U64>(operand.immediate);
+                    } else if (sigTypes[i] == OPCODE_SIG_TYPE_B) {
+                        w.write<U32>(blockIndex.at(operand.block));
+                    } else if (sigTypes[i] == OPCODE_SIG_TYPE_F) {
+                        w.write<U32>(functionIndex.at(operand.function));
+                    }
+                }
+            }
+        }
+    }
+    return buffer;
+}
+
+bool Module::deserialize(const U08* data, Size size) {
+    ModuleReader r(data, size);
+
+    // Header
+    if (r.read<U32>() != HIR_FORMAT_MAGIC) {
+        logger.error(LOG_CPU, "Invalid HIR module: Wrong magic");
+        return false;
+    }
+    const U32 version = r.read<U32>();
+    if (version != HIR_FORMAT_VERSION) {
+        logger.error(LOG_CPU, "Unsupported HIR module version %d (expected %d)", version, HIR_FORMAT_VERSION);
+        return false;
+    }
+    if (r.read<U32>() != __OPCODE_COUNT) {
+        logger.error(LOG_CPU, "Invalid HIR module: Opcode list mismatch");
+        return false;
+    }
+    name = r.readString();
+    const U32 functionCount = r.read<U32>();
+    if (r.failed) {
+        logger.error(LOG_CPU, "Invalid HIR module: Truncated header");
+        return false;
+    }
+
+    // Function declarations
+    std::vector<Function*> loaded;
+    for (U32 i = 0; i < functionCount && !r.failed; i++) {
+        const std::string functionName = r.readString();
+        const U32 flags = r.read<U32>();
+        const auto typeOut = static_cast<Type>(r.read<U08>());
+        const U32 argCount = r.read<U32>();
+        if (r.failed || argCount > r.remaining()) {
+            r.failed = true;
+            break;
+        }
+        std::vector<Type> typeIn(argCount);
+        for (auto& type : typeIn) {
+            type = static_cast<Type>(r.read<U08>());
+        }
+        const U64 nativeAddress = r.read<U64>();
+
+        Function* function = new Function(this, typeOut, typeIn);
+        function->name = functionName;
+        function->flags = flags;
+        function->nativeSize = 0;
+        if (flags & FUNCTION_IS_EXTERN) {
+            function->nativeAddress.store(reinterpret_cast<void*>(nativeAddress));
+        }
+        loaded.push_back(function);
+    }
+
+    // Function bodies
+    for (auto* function : loaded) {
+        if (r.failed) {
+            break;
+        }
+        std::vector<Value*> values(function->args.begin(), function->args.end());
+        const U32 valueCount = r.read<U32>();
+        if (r.failed || valueCount > r.remaining()) {
+            r.failed = true;
+            break;
+        }
+        for (U32 i = 0; i < valueCount && !r.failed; i++) {
+            Value* value = new Value();
+            value->type = static_cast<Type>(r.read<U08>());
+            value->flags = 0;
+            value->usage = 0;
+            value->reg = 0;
+            value->parent.instruction = nullptr;
+            values.push_back(value);
+        }
+
+        const U32 blockCount = r.read<U32>();
+        if (r.failed || blockCount > r.remaining()) {
+            r.failed = true;
+            break;
+        }
+        std::vector<Block*> blocks;
+        for (U32 i = 0; i < blockCount && !r.failed; i++) {
+            blocks.push_back(new Block(function));
+        }
+        for (auto* block : blocks) {
+            block->flags = r.read<U32>();
+            const U32 instrCount = r.read<U32>();
+            for (U32 i = 0; i < instrCount && !r.failed; i++) {
+                const U16 opcode = r.read<U16>();
+                if (opcode >= __OPCODE_COUNT) {
+                    r.failed = true;
+                    break;
+                }
+                Instruction* instr = new Instruction();
+                instr->parent = block;
+                instr->opcode = static_cast<Opcode>(opcode);
+                instr->flags = r.read<U32>();
+                instr->dest = nullptr;
+                instr->src1.value = nullptr;
+                instr->src2.value = nullptr;
+                instr->src3.value = nullptr;
+                block->instructions.push_back(instr);
+
+                const U32 dest = r.read<U32>();
+                if (dest != HIR_INDEX_NONE) {
+                    if (dest >= values.size()) {
+                        r.failed = true;
+                        break;
+                    }
+                    instr->dest = values[dest];
+                    if (!instr->dest->parent.instruction) {
+                        instr->dest->parent.instruction = instr;
+                    }
+                }
+
+                const auto& opInfo = opcodeInfo[instr->opcode];
+                const U08 sigTypes[3] = {
+                    opInfo.getSignatureSrc1(), opInfo.getSignatureSrc2(), opInfo.getSignatureSrc3() };
+                Instruction::Operand* operands[3] = { &instr->src1, &instr->src2, &instr->src3 };
+                for (int j = 0; j < 3 && !r.failed; j++) {
+                    auto& operand = *operands[j];
+                    if (isValueSignature(sigTypes[j])) {
+                        const U08 kind = r.read<U08>();
+                        if (kind == OPERAND_KIND_VALUE) {
+                            const U32 index = r.read<U32>();
+                            if (index >= values.size()) {
+                                r.failed = true;
+                                break;
+                            }
+                            operand.setValue(values[index]);
+                        } else if (kind == OPERAND_KIND_CONSTANT) {
+                            Value* value = new Value();
+                            value->type = static_cast<Type>(r.read<U08>());
+                            value->flags = VALUE_IS_CONSTANT;
+                            value->usage = 0;
+                            value->reg = 0;
+                            value->parent.instruction = nullptr;
+                            r.readBytes(&value->constant, getTypeSize(value->type));
+                            operand.setValue(value);
+                        }
+                    } else if (sigTypes[j] == OPCODE_SIG_TYPE_I) {
+                        operand.immediate = r.read<U64>();
+                    } else if (sigTypes[j] == OPCODE_SIG_TYPE_B) {
+                        const U32 index = r.read<U32>();
+                        if (index >= blocks.size()) {
+                            r.failed = true;
+                            break;
+                        }
+                        operand.block = blocks[index];
+                    } else if (sigTypes[j] == OPCODE_SIG_TYPE_F) {
+                        const U32 index = r.read<U32>();
+                        if (index >= loaded.size()) {
+                            r.failed = true;
+                            break;
+                        }
+                        operand.function = loaded[index];
+                    }
+                }
+            }
+        }
+
+        // Creating blocks marks the function as being defined
+        function->flags &= ~FUNCTION_IS_DEFINING;
+    }
+
+    if (r.failed) {
+        logger.error(LOG_CPU, "Invalid HIR module: Truncated or corrupted data");
+        return false;
+    }
+    return true;
+}
+
+bool Module::load(const std::string& path) {
+    auto file = fs::HostFileSystem::openFile(path, fs::Read);
+    if (!file) {
+        logger.error(LOG_CPU, "Could not open HIR module: %s", path.c_str());
+        return false;
+    }
+    std::vector<U08> buffer(file->attributes().size);
+    if (file->read(buffer.data(), buffer.size()) != buffer.size()) {
+        logger.error(LOG_CPU, "Could not read HIR module: %s", path.c_str());
+        return false;
+    }
+    return deserialize(buffer.data(), buffer.size());
+}
+
+bool Module::save(const std::string& path) {
+    auto file = fs::HostFileSystem::openFile(path, fs::Write);
+    if (!file) {
+        logger.error(LOG_CPU, "Could not create HIR module: %s", path.c_str());
+        return false;
+    }
+    const auto buffer = serialize();
+    if (file->write(buffer.data(), buffer.size()) != buffer.size()) {
+        logger.error(LOG_CPU, "Could not write HIR module: %s", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+void Module::saveAll(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(modulesMutex);
+    for (Size i = 0; i < modules.size(); i++) {
+        const auto& name = modules[i]->name;
+        const auto path = name.empty()
+            ? format("%s/module_%03d.hir", directory.c_str(), int(i))
+            : format("%s/module_%03d_%s.hir", directory.c_str(), int(i), name.c_str());
+        modules[i]->save(path);
+    }
+}
+
 }  // namespace hir
 }  // namespace cpu
@@ -9,6 +9,7 @@
 #include "nucleus/cpu/hir/type.h"
 #include "nucleus/cpu/hir/value.h"
 
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -53,10 +54,17 @@ public:
     // Arguments
     std::vector<Value*> args;
 
-    // Pointer to the compiled function
-    void* nativeAddress;
+    // Symbolic name including the guest address, used by dumps and host profilers
+    std::string name;
+
+    // Pointer to the compiled function. Updated while other threads might be calling it
+    // through this field, so compilers publish it with release and callers load it with acquire.
+    std::atomic<void*> nativeAddress;
     U64 nativeSize;
 
+    // Pointer to the compiled placeholder that triggers the translation of this function
+    void* stubAddress;
+
     // Constructor
     Function(Module* parent, TypeOut tOut, TypeIn tIn = {});
     ~Function();
@@ -73,6 +81,12 @@ public:
      */
     void reset();
 
+    /**
+     * Discard the compiled result by redirecting callers to the placeholder,
+     * so that the function gets translated again on its next call
+     */
+    void invalidate();
+
     /**
      * Save a human-readable version of this HIR function
      * @return           String containing the readable version of this HIR function
@@ -20,9 +20,16 @@ class Module {
 public:
     std::vector<Function*> functions;
 
+    // Name of the guest module, if known (profiling related)
+    std::string name;
+
     // Generate IDs for child blocks and values
     S32 functionIdCounter = 0;
 
+    // Constructor and destructor keep track of the live modules
+    Module();
+    ~Module();
+
     // Frontend methods
 
     /**
@@ -42,6 +49,20 @@ public:
 
     // Load-Saving methods
 
+    /**
+     * Serialize this module into the versioned binary HIR format
+     * @return           Buffer containing the serialized module
+     */
+    std::vector<U08> serialize() const;
+
+    /**
+     * Append the functions of a serialized module to this module
+     * @param[in]  data  Buffer containing the serialized module
+     * @param[in]  size  Size of the buffer in bytes
+     * @return           True on success
+     */
+    bool deserialize(const U08* data, Size size);
+
     /**
      * Save a human-readable version of this HIR module
      * @return           String containing the readable version of this HIR module
@@ -49,18 +70,24 @@ public:
     std::string dump() const;
 
     /**
-     * Load module from file
+     * Load module from a binary HIR file
      * @param[im]  path  Path where the module file is located
      * @return           True on success
      */
     bool load(const std::string& path);
 
     /**
-     * Save module to file
+     * Save module to a binary HIR file
      * @param[im]  path  Path where the module file is to be saved
      * @return           True on success
      */
     bool save(const std::string& path);
+
+    /**
+     * Save every live module to a binary HIR file, so it can be inspected with nucleus-hir
+     * @param[in]  directory  Directory where the module files are to be saved
+     */
+    static void saveAll(const std::string& directory);
 };
 
 }  // namespace hir
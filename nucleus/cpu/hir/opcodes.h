@@ -42,6 +42,8 @@ enum MemoryFlags : OpcodeFlags {
     ENDIAN_DEFAULT  = 0,
     ENDIAN_BIG      = 1 << 0,  // Big Endian memory access
     ENDIAN_LITTLE   = 1 << 1,  // Little Endian memory access
+    ACCESS_ALIGNED  = 1 << 2,  // Address is aligned to the size of the accessed type
+    ACCESS_GUEST    = 1 << 3,  // Address is a 32-bit guest address, relative to the guest memory base
 };
 
 enum VectorFlags : OpcodeFlags {
@@ -9,6 +9,9 @@ namespace cpu {
 namespace hir {
 namespace passes {
 
+DeadCodeEliminationPass::DeadCodeEliminationPass() {
+}
+
 bool DeadCodeEliminationPass::run(Function* function) {
     // Check function flags
     if (!function || !(function->flags & FUNCTION_IS_DEFINED)) {
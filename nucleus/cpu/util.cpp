@@ -22,13 +22,21 @@ namespace cpu {
 
 void nucleusTranslate(void* guestFunc, U64 guestAddr) {
     auto* function = static_cast<frontend::ppu::Function*>(guestFunc);
+    auto* hirFunction = function->hirFunction;
+
+    // Functions invalidated by guest writes are analyzed again from scratch
+    function->clearBlocks();
+    hirFunction->reset();
     function->analyze_cfg();
     function->recompile();
 
-    auto* hirFunction = function->hirFunction;
     auto* cpu = CPU::getCurrentThread()->parent;
     auto* state = static_cast<frontend::ppu::PPUThread*>(CPU::getCurrentThread())->state.get();
     cpu->compiler->compile(hirFunction);
+    for (const auto& item : function->blocks) {
+        const auto* block = item.second;
+        cpu->registerCode(hirFunction, block->address, block->size);
+    }
     cpu->compiler->call(hirFunction, state);
 }
 
@@ -44,6 +52,9 @@ void nucleusSysCall() {
 #if !defined(NUCLEUS_BUILD_TEST)
     auto* state = static_cast<frontend::ppu::PPUThread*>(CPU::getCurrentThread())->state.get();
     static_cast<sys::LV2*>(nucleus.sys.get())->call(*state);
+
+    // Drop translations of code written by the guest or by the system call
+    CPU::getCurrentThread()->parent->flushCodeWrites();
 #endif
 }
 
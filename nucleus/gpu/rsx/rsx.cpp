@@ -8,6 +8,7 @@
 #include "nucleus/logger/logger.h"
 #include "nucleus/memory/memory.h"
 #include "nucleus/core/config.h"
+#include "nucleus/core/futex.h"
 #include "nucleus/system/scei/cellos/lv1/lv1_gpu.h"
 
 #include "nucleus/gpu/rsx/rsx_dma.h"
@@ -19,6 +20,16 @@
 #include <Windows.h>
 #endif
 
+#include <algorithm>
+
+// Guest address of the control registers (PUT, GET, REF)
+#define RSX_CONTROL_ADDR  0x40100000
+#define RSX_CONTROL_SIZE  0x1000
+
+// Bounds of the number of polls before an idle PFIFO blocks
+#define PFIFO_SPIN_MIN  16
+#define PFIFO_SPIN_MAX  1024
+
 // Method matching
 #define case_2(offset, step) \
     case offset: \
@@ -69,16 +80,44 @@ RSX::RSX(std::shared_ptr<mem::Memory> mem, std::shared_ptr<gfx::GraphicsBackend>
     dma_control->get = 0;
     dma_control->put = 0;
 
+    // Wake up the FIFO whenever the control registers are written
+    m_pfifo_spin = PFIFO_SPIN_MIN;
+    m_pfifo_watch = memory->watchWrites(RSX_CONTROL_ADDR, RSX_CONTROL_SIZE, &m_pfifo_doorbell);
+
     m_pfifo_thread = new std::thread([&](){
         task();
     });
 }
 
+void RSX::wait() {
+    // Poll for a while, since the guest often kicks the FIFO again shortly after it drains.
+    // Idle periods that end while polling allow polling longer next time, and vice versa.
+    for (U32 i = 0; i < m_pfifo_spin; i++) {
+        if (dma_control->get != dma_control->put) {
+            m_pfifo_spin = std::min<U32>(m_pfifo_spin * 2, PFIFO_SPIN_MAX);
+            return;
+        }
+        std::this_thread::yield();
+    }
+    m_pfifo_spin = std::max<U32>(m_pfifo_spin / 2, PFIFO_SPIN_MIN);
+
+    // Block until a write to the control registers rings the doorbell. Protecting them
+    // again before checking GET and PUT ensures that no PUT update can be missed.
+    while (dma_control->get == dma_control->put) {
+        const U32 doorbell = m_pfifo_doorbell.load(std::memory_order_acquire);
+        memory->resetDirty(RSX_CONTROL_ADDR, RSX_CONTROL_SIZE);
+        if (dma_control->get != dma_control->put) {
+            break;
+        }
+        core::futexWait(m_pfifo_doorbell, doorbell);
+    }
+}
+
 void RSX::task() {
     while (true) {
         // Wait until GET and PUT are different
-        while (dma_control->get == dma_control->put) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (dma_control->get == dma_control->put) {
+            wait();
         }
         const U32 get = dma_control->get;
         const U32 put = dma_control->put;
@@ -10,6 +10,7 @@
 #include "nucleus/gpu/gpu.h"
 #include "nucleus/gpu/rsx/rsx_pgraph.h"
 
+#include <atomic>
 #include <stack>
 #include <thread>
 
@@ -110,6 +111,15 @@ class RSX : public GPU {
     // Call stack
     std::stack<U32> m_pfifo_stack;
 
+    // Doorbell rung by writes to the control registers, and number of
+    // times to poll them before blocking, adapted to recent idle periods
+    std::atomic<U32> m_pfifo_doorbell{0};
+    U32 m_pfifo_watch;
+    U32 m_pfifo_spin;
+
+    // Block the PFIFO until GET and PUT are different
+    void wait();
+
 public:
     // RSX Local Memory (mapped into the user space)
     rsx_device_t* device;
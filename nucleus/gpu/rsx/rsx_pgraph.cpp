@@ -106,29 +106,23 @@ void PGRAPH::LoadVertexAttributes(U32 first, U32 count) {
         const U32 typeSize = vertexTypeSize[attr.type];
         //attr.data.resize(count * attr.size * typeSize);
 
-        // Copy data per vertex
+        // Copy data of all vertices, packing the components of each one
         U08* data = (U08*)vpeInputs[attrIndex]->map();
-        for (U32 i = 0; i < count; i++) {
-            U32 src = addr + vertex_data_base_offset + attr.stride * (first + i + vertex_data_base_index);
-            void* dst = &/*attr.*/data[i * attr.size * typeSize];
-
-            switch (typeSize) {
-            case 1:
-                for (U08 j = 0; j < attr.size; j++) {
-                    ((U08*)dst)[j] = nucleus.memory->read8(src + 1*j);
-                }
-                break;
-            case 2:
-                for (U08 j = 0; j < attr.size; j++) {
-                    ((U16*)dst)[j] = nucleus.memory->read16(src + 2*j);
-                }
-                break;
-            case 4:
+        const U32 src = addr + vertex_data_base_offset + attr.stride * (first + vertex_data_base_index);
+        switch (typeSize) {
+        case 1:
+            for (U32 i = 0; i < count; i++) {
                 for (U08 j = 0; j < attr.size; j++) {
-                    ((U32*)dst)[j] = nucleus.memory->read32(src + 4*j);
+                    data[i * attr.size + j] = nucleus.memory->read8(src + attr.stride * i + j);
                 }
-                break;
             }
+            break;
+        case 2:
+            nucleus.memory->copyFromGuestSwapStrided16(data, src, attr.stride, attr.size, count);
+            break;
+        case 4:
+            nucleus.memory->copyFromGuestSwapStrided32(data, src, attr.stride, attr.size, count);
+            break;
         }
         vpeInputs[attrIndex]->unmap();
 
@@ -0,0 +1,158 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "fault.h"
+#include "nucleus/logger/logger.h"
+
+#if defined(NUCLEUS_TARGET_WINDOWS)
+#include <Windows.h>
+#elif defined(NUCLEUS_TARGET_LINUX) || defined(NUCLEUS_TARGET_OSX)
+#include <signal.h>
+#include <ucontext.h>
+#endif
+
+#include <atomic>
+#include <mutex>
+
+namespace mem {
+
+// Maximum number of simultaneously registered handlers
+#define MAX_FAULT_HANDLERS 8
+
+struct FaultHandlerEntry {
+    std::atomic<FaultHandler> handler;
+    std::atomic<void*> userdata;
+};
+
+static FaultHandlerEntry gFaultHandlers[MAX_FAULT_HANDLERS];
+static std::mutex gFaultMutex;
+static bool gFaultInstalled = false;
+
+/**
+ * Dispatch a fault to the registered handlers.
+ * Runs in signal/exception context: no allocations or locks allowed.
+ */
+static bool dispatchFault(FaultInfo& info) {
+    for (auto& entry : gFaultHandlers) {
+        FaultHandler handler = entry.handler.load(std::memory_order_acquire);
+        if (handler && handler(info, entry.userdata.load(std::memory_order_relaxed))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#if defined(NUCLEUS_TARGET_WINDOWS)
+static LONG CALLBACK exceptionHandler(PEXCEPTION_POINTERS exception) {
+    PEXCEPTION_RECORD record = exception->ExceptionRecord;
+    if (record->ExceptionCode != EXCEPTION_ACCESS_VIOLATION) {
+        return EXCEPTION_CONTINUE_SEARCH;
+    }
+
+    FaultInfo info;
+    info.address = reinterpret_cast<void*>(record->ExceptionInformation[1]);
+    info.isWrite = record->ExceptionInformation[0] == 1;
+    info.context = exception->ContextRecord;
+    if (dispatchFault(info)) {
+        return EXCEPTION_CONTINUE_EXECUTION;
+    }
+    return EXCEPTION_CONTINUE_SEARCH;
+}
+
+static bool installHandler() {
+    return AddVectoredExceptionHandler(1, exceptionHandler) != nullptr;
+}
+
+#elif defined(NUCLEUS_TARGET_LINUX) || defined(NUCLEUS_TARGET_OSX)
+static struct sigaction gPrevSegv;
+static struct sigaction gPrevBus;
+
+static bool isWriteAccess(void* context) {
+    auto* uc = static_cast<ucontext_t*>(context);
+#if defined(NUCLEUS_TARGET_LINUX) && defined(NUCLEUS_ARCH_X86_64BITS)
+    return (uc->uc_mcontext.gregs[REG_ERR] & 2) != 0;
+#elif defined(NUCLEUS_TARGET_OSX) && defined(NUCLEUS_ARCH_X86_64BITS)
+    return (uc->uc_mcontext->__es.__err & 2) != 0;
+#else
+    // Access type unknown: assume it was a write
+    return true;
+#endif
+}
+
+static void signalHandler(int sig, siginfo_t* siginfo, void* context) {
+    FaultInfo info;
+    info.address = siginfo->si_addr;
+    info.isWrite = isWriteAccess(context);
+    info.context = context;
+    if (dispatchFault(info)) {
+        return;
+    }
+
+    // Forward unhandled faults to the previous handler
+    const struct sigaction& prev = (sig == SIGSEGV) ? gPrevSegv : gPrevBus;
+    if (prev.sa_flags & SA_SIGINFO) {
+        prev.sa_sigaction(sig, siginfo, context);
+    } else if (prev.sa_handler != SIG_DFL && prev.sa_handler != SIG_IGN) {
+        prev.sa_handler(sig);
+    } else {
+        signal(sig, SIG_DFL);
+        raise(sig);
+    }
+}
+
+static bool installHandler() {
+    struct sigaction sa = {};
+    sa.sa_sigaction = signalHandler;
+    sa.sa_flags = SA_SIGINFO;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGSEGV, &sa, &gPrevSegv) != 0) {
+        return false;
+    }
+    if (sigaction(SIGBUS, &sa, &gPrevBus) != 0) {
+        return false;
+    }
+    return true;
+}
+
+#else
+static bool installHandler() {
+    return false;
+}
+#endif
+
+bool addFaultHandler(FaultHandler handler, void* userdata) {
+    std::lock_guard<std::mutex> lock(gFaultMutex);
+
+    if (!gFaultInstalled) {
+        if (!installHandler()) {
+            logger.error(LOG_MEMORY, "Could not install the memory fault handler");
+            return false;
+        }
+        gFaultInstalled = true;
+    }
+    for (auto& entry : gFaultHandlers) {
+        if (!entry.handler.load(std::memory_order_relaxed)) {
+            entry.userdata.store(userdata, std::memory_order_relaxed);
+            entry.handler.store(handler, std::memory_order_release);
+            return true;
+        }
+    }
+    logger.error(LOG_MEMORY, "Too many memory fault handlers registered");
+    return false;
+}
+
+void removeFaultHandler(FaultHandler handler, void* userdata) {
+    std::lock_guard<std::mutex> lock(gFaultMutex);
+
+    for (auto& entry : gFaultHandlers) {
+        if (entry.handler.load(std::memory_order_relaxed) == handler &&
+            entry.userdata.load(std::memory_order_relaxed) == userdata) {
+            entry.handler.store(nullptr, std::memory_order_release);
+            entry.userdata.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+}
+
+}  // namespace mem
@@ -0,0 +1,43 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+
+namespace mem {
+
+/**
+ * Information about a host memory access fault
+ */
+struct FaultInfo {
+    void* address;  // Host address that caused the fault
+    bool isWrite;   // Whether the faulting access was a write
+    void* context;  // Platform-specific context (ucontext_t* or PCONTEXT)
+};
+
+/**
+ * Fault handler callback. Returns true if the fault was resolved and the faulting
+ * instruction can be restarted, or false to let the next handler process it.
+ */
+using FaultHandler = bool(*)(FaultInfo& info, void* userdata);
+
+/**
+ * Register a handler for host memory access faults.
+ * The platform-specific signal/exception handler is installed on first use.
+ * @param[in]  handler   Function to be called on every fault
+ * @param[in]  userdata  Pointer to be passed to the handler
+ * @return               True on success
+ */
+bool addFaultHandler(FaultHandler handler, void* userdata);
+
+/**
+ * Unregister a previously added handler
+ * @param[in]  handler   Function to be removed
+ * @param[in]  userdata  Pointer it was registered with
+ */
+void removeFaultHandler(FaultHandler handler, void* userdata);
+
+}  // namespace mem
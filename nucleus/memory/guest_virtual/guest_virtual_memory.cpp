@@ -4,7 +4,15 @@
  */
 
 #include "guest_virtual_memory.h"
+#include "nucleus/format.h"
+#include "nucleus/core/config.h"
+#include "nucleus/core/futex.h"
 #include "nucleus/logger/logger.h"
+#include "nucleus/memory/swap.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
 
 #ifdef NUCLEUS_TARGET_WINDOWS
 #include <Windows.h>
@@ -34,6 +42,16 @@ GuestVirtualMemory::GuestVirtualMemory(Size amount) {
         logger.error(LOG_MEMORY, "Could not reserve memory");
     }
 
+    // Initialize page table before segments start mapping pages
+    m_pages = std::make_unique<std::atomic<U08>[]>(GUEST_PAGE_COUNT);
+    for (U64 page = 0; page < GUEST_PAGE_COUNT; page++) {
+        m_pages[page].store(0, std::memory_order_relaxed);
+    }
+    m_codeWrites = std::make_unique<std::atomic<U64>[]>(GUEST_PAGE_COUNT / 64);
+    for (U64 word = 0; word < GUEST_PAGE_COUNT / 64; word++) {
+        m_codeWrites[word].store(0, std::memory_order_relaxed);
+    }
+
     // Initialize segments
     m_segments[SEG_MAIN_MEMORY].init(this, 0x00010000, 0x2FFF0000);
     m_segments[SEG_USER_MEMORY].init(this, 0x10000000, 0x10000000);
@@ -43,11 +61,32 @@ GuestVirtualMemory::GuestVirtualMemory(Size amount) {
     m_segments[SEG_STACK].init(this, 0xD0000000, 0x10000000);
     m_segments[SEG_SPU].init(this, 0xF0000000, 0x10000000);
 
+    // Back memory accessed by translated code with huge pages to reduce TLB misses.
+    // These segments hold code and GPU resources, which are write-protected per 4 KB page,
+    // so only transparent huge pages can be used: the host splits them when needed.
+    if (config.hugePages) {
+        m_segments[SEG_MAIN_MEMORY].setBacking(BACKING_TRANSPARENT);
+        m_segments[SEG_USER_MEMORY].setBacking(BACKING_TRANSPARENT);
+        m_segments[SEG_RSX_LOCAL_MEMORY].setBacking(BACKING_TRANSPARENT);
+    }
+
+    // Allocation tracing
+    if (config.traceAlloc) {
+        for (auto& segment : m_segments) {
+            segment.setTracing(true);
+        }
+    }
+
     // Allocate SPU-related memory
     m_segments[SEG_SPU].alloc(0x10000000);
+
+    // Self-modifying code detection
+    addFaultHandler(handleFault, this);
 }
 
 Memory::~Memory() {
+    removeFaultHandler(handleFault, this);
+
     bool success;
 #if defined(NUCLEUS_TARGET_UWP)
     success = false;
@@ -70,9 +109,395 @@ void Memory::free(U32 addr) {
 }
 
 bool Memory::check(U32 addr) {
+    return getPageFlags(addr) & PAGE_ALLOCATED;
+}
+
+/**
+ * Statistics
+ */
+void GuestVirtualMemory::setCallerCallback(CallerCallback callback) {
+    m_callerCallback = std::move(callback);
+}
+
+U32 GuestVirtualMemory::getCaller() const {
+    return m_callerCallback ? m_callerCallback() : 0;
+}
+
+std::string GuestVirtualMemory::report(Size maxCallers) {
+    static const char* segmentNames[_SEG_COUNT] = {
+        "Main", "User", "RSX map", "Mmapper", "RSX local", "Stack", "SPU",
+    };
+
+    std::string output;
+    output += format("Guest memory usage (KB):\n");
+    output += format("  %-10s %10s %10s %10s %12s %8s %8s %12s %10s\n",
+        "Segment", "Total", "Used", "Peak", "Largest free", "Blocks", "Holes", "THP advised", "Regular");
+    for (Size id = 0; id < _SEG_COUNT; id++) {
+        const auto& segment = m_segments[id];
+        output += format("  %-10s %10u %10u %10u %12u %8llu %8llu %12u %10u\n",
+            segmentNames[id],
+            segment.getTotalMemory() >> 10,
+            segment.getUsedMemory() >> 10,
+            segment.getPeakMemory() >> 10,
+            segment.getLargestFreeBlock() >> 10,
+            static_cast<unsigned long long>(segment.getBlockCount()),
+            static_cast<unsigned long long>(segment.getFreeRangeCount()),
+            segment.getBackedMemory(BACKING_TRANSPARENT) >> 10,
+            segment.getBackedMemory(BACKING_DEFAULT) >> 10);
+    }
+
+    // Live memory by allocating guest code, only known if allocations were traced
+    std::unordered_map<U32, std::pair<U64, U64>> callers;
+    for (const auto& segment : m_segments) {
+        segment.forEachBlock([&](const Block& block) {
+            if (block.caller) {
+                auto& entry = callers[block.caller];
+                entry.first += block.size;
+                entry.second += 1;
+            }
+        });
+    }
+    if (!callers.empty()) {
+        std::vector<std::pair<U32, std::pair<U64, U64>>> sorted(callers.begin(), callers.end());
+        std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+            return a.second.first > b.second.first;
+        });
+        output += format("Live allocations by caller:\n");
+        output += format("  %-10s %10s %8s\n", "Caller", "KB", "Blocks");
+        for (Size i = 0; i < sorted.size() && i < maxCallers; i++) {
+            output += format("  0x%08X %10llu %8llu\n", sorted[i].first,
+                static_cast<unsigned long long>(sorted[i].second.first >> 10),
+                static_cast<unsigned long long>(sorted[i].second.second));
+        }
+    }
+    return output;
+}
+
+void GuestVirtualMemory::dump() {
+    logger.notice(LOG_MEMORY, "%s", report().c_str());
+}
+
+/**
+ * Page table
+ */
+void GuestVirtualMemory::setPageFlags(U32 addr, U32 size, U08 flags) {
+    const U64 first = addr >> GUEST_PAGE_SHIFT;
+    const U64 last = (U64(addr) + size - 1) >> GUEST_PAGE_SHIFT;
+    for (U64 page = first; page <= last; page++) {
+        m_pages[page].fetch_or(flags, std::memory_order_acq_rel);
+    }
+}
+
+void GuestVirtualMemory::clearPageFlags(U32 addr, U32 size, U08 flags) {
+    const U64 first = addr >> GUEST_PAGE_SHIFT;
+    const U64 last = (U64(addr) + size - 1) >> GUEST_PAGE_SHIFT;
+    for (U64 page = first; page <= last; page++) {
+        m_pages[page].fetch_and(U08(~flags), std::memory_order_acq_rel);
+    }
+}
+
+void GuestVirtualMemory::mapPages(U32 addr, U32 size, U32 pageSize) {
+    U08 flags = PAGE_ALLOCATED | PAGE_READ | PAGE_WRITE;
+    if (pageSize >= 1_MB) {
+        flags |= PAGE_SIZE_1M;
+    } else if (pageSize >= 64_KB) {
+        flags |= PAGE_SIZE_64K;
+    }
+    setPageFlags(addr, size, flags);
+}
+
+void GuestVirtualMemory::unmapPages(U32 addr, U32 size) {
+    const U64 first = addr >> GUEST_PAGE_SHIFT;
+    const U64 last = (U64(addr) + size - 1) >> GUEST_PAGE_SHIFT;
+
+    // Releasing a page counts as writing it: translated code and clean watched pages in
+    // the range are reported to their owners, and write-protected pages are restored
+    protectPages(first, last, true, [&](U64 page) {
+        const U08 prev = m_pages[page].exchange(0, std::memory_order_acq_rel);
+        if ((prev & PAGE_CODE) && m_codeWriteCallback) {
+            m_codeWriteCallback(U32(page << GUEST_PAGE_SHIFT), GUEST_PAGE_SIZE);
+        }
+        if ((prev & PAGE_GPU) && !(prev & PAGE_DIRTY)) {
+            ringWatchers(page);
+        }
+        return isWriteProtected(prev);
+    });
+}
+
+/**
+ * Self-modifying code detection
+ */
+bool GuestVirtualMemory::protect(U32 addr, U32 size, bool writable) {
+    void* hostAddr = reinterpret_cast<void*>((U64)m_base + addr);
+    bool success;
+#if defined(NUCLEUS_TARGET_UWP)
+    success = false;
+#elif defined(NUCLEUS_TARGET_WINDOWS)
+    DWORD oldProtect;
+    success = VirtualProtect(hostAddr, size, writable ? PAGE_READWRITE : PAGE_READONLY, &oldProtect) != 0;
+#elif defined(NUCLEUS_TARGET_LINUX) || defined(NUCLEUS_TARGET_OSX)
+    success = ::mprotect(hostAddr, size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ) == 0;
+#endif
+    return success;
+}
+
+void GuestVirtualMemory::protectRun(U64 first, U64 count, bool writable) {
+    const U32 addr = U32(first << GUEST_PAGE_SHIFT);
+    const U32 size = U32(count << GUEST_PAGE_SHIFT);
+    if (protect(addr, size, writable)) {
+        return;
+    }
+    logger.warning(LOG_MEMORY, "Could not %s pages at 0x%08X (0x%X bytes)",
+        writable ? "unprotect" : "write-protect", addr, size);
+
+    // Writes to pages that stay writable can't be detected: stop tracking their code,
+    // and report watched pages as permanently dirty so that GPU caches always reload them
+    if (!writable) {
+        for (U64 page = first; page < first + count; page++) {
+            const U08 prev = m_pages[page].fetch_and(U08(~PAGE_CODE), std::memory_order_acq_rel);
+            if (prev & PAGE_GPU) {
+                m_pages[page].fetch_or(PAGE_DIRTY, std::memory_order_acq_rel);
+            }
+        }
+    }
+}
+
+template <typename Predicate>
+void GuestVirtualMemory::protectPages(U64 first, U64 last, bool writable, Predicate predicate) {
+    U64 runStart = 0;
+    U64 runCount = 0;
+    for (U64 page = first; page <= last; page++) {
+        if (predicate(page)) {
+            if (runCount == 0) {
+                runStart = page;
+            }
+            runCount++;
+            continue;
+        }
+        if (runCount) {
+            protectRun(runStart, runCount, writable);
+            runCount = 0;
+        }
+    }
+    if (runCount) {
+        protectRun(runStart, runCount, writable);
+    }
+}
+
+void GuestVirtualMemory::protectCode(U32 addr, U32 size) {
+    const U64 first = addr >> GUEST_PAGE_SHIFT;
+    const U64 last = (U64(addr) + size - 1) >> GUEST_PAGE_SHIFT;
+    for (U64 page = first; page <= last; page++) {
+        const U08 prev = m_pages[page].fetch_or(PAGE_CODE, std::memory_order_acq_rel);
+        if (prev & PAGE_CODE) {
+            continue;
+        }
+        if (!protect(U32(page << GUEST_PAGE_SHIFT), GUEST_PAGE_SIZE, false)) {
+            m_pages[page].fetch_and(U08(~PAGE_CODE), std::memory_order_acq_rel);
+            logger.warning(LOG_MEMORY, "Could not write-protect code page at 0x%08X", U32(page << GUEST_PAGE_SHIFT));
+        }
+    }
+}
+
+void GuestVirtualMemory::unprotectCode(U32 addr, U32 size) {
+    const U64 first = addr >> GUEST_PAGE_SHIFT;
+    const U64 last = (U64(addr) + size - 1) >> GUEST_PAGE_SHIFT;
+    for (U64 page = first; page <= last; page++) {
+        const U08 flags = m_pages[page].load(std::memory_order_acquire);
+        if (!(flags & PAGE_CODE)) {
+            continue;
+        }
+        if (!isWriteProtected(flags & ~PAGE_CODE)) {
+            protectRun(page, 1, true);
+        }
+        m_pages[page].fetch_and(U08(~PAGE_CODE), std::memory_order_acq_rel);
+    }
+}
+
+bool GuestVirtualMemory::isCode(U32 addr) const {
+    return getPageFlags(addr) & PAGE_CODE;
+}
+
+void GuestVirtualMemory::setCodeWriteCallback(CodeWriteCallback callback) {
+    m_codeWriteCallback = std::move(callback);
+}
+
+void GuestVirtualMemory::flushCodeWrites() {
+    if (!m_codeWritesPending.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    for (U64 word = 0; word < GUEST_PAGE_COUNT / 64; word++) {
+        if (!m_codeWrites[word].load(std::memory_order_relaxed)) {
+            continue;
+        }
+        const U64 bits = m_codeWrites[word].exchange(0, std::memory_order_acq_rel);
+        for (U64 bit = 0; bit < 64; bit++) {
+            if ((bits & (1ULL << bit)) && m_codeWriteCallback) {
+                const U64 page = (word << 6) | bit;
+                m_codeWriteCallback(U32(page << GUEST_PAGE_SHIFT), GUEST_PAGE_SIZE);
+            }
+        }
+    }
+}
+
+bool GuestVirtualMemory::handleFault(FaultInfo& info, void* userdata) {
+    auto* memory = static_cast<GuestVirtualMemory*>(userdata);
+    const U64 offset = (U64)info.address - (U64)memory->m_base;
+    if (!info.isWrite || offset >= 0x100000000ULL) {
+        return false;
+    }
+
+    // Only writes to pages holding translated code or watched by GPU caches are handled here
+    const U64 page = offset >> GUEST_PAGE_SHIFT;
+    auto& entry = memory->m_pages[page];
+    const U08 flags = entry.load(std::memory_order_acquire);
+    if (!isWriteProtected(flags)) {
+        // Another thread already resolved a concurrent fault on this watched page
+        return (flags & PAGE_GPU) != 0;
+    }
+
+    // Re-enable writes before updating the flags, so that concurrent faults
+    // on the same page are either resolved here or already writable on retry
+    const U32 pageAddr = U32(page << GUEST_PAGE_SHIFT);
+    if (!memory->protect(pageAddr, GUEST_PAGE_SIZE, true)) {
+        return false;
+    }
+    if (flags & PAGE_GPU) {
+        const U08 prev = entry.fetch_or(PAGE_DIRTY, std::memory_order_acq_rel);
+        if (!(prev & PAGE_DIRTY)) {
+            memory->ringWatchers(page);
+        }
+    }
+    // Invalidating translations takes locks, so only record the page for the next flush
+    const U08 prev = entry.fetch_and(U08(~PAGE_CODE), std::memory_order_acq_rel);
+    if (prev & PAGE_CODE) {
+        memory->m_codeWrites[page >> 6].fetch_or(1ULL << (page & 63), std::memory_order_acq_rel);
+        memory->m_codeWritesPending.store(true, std::memory_order_release);
+    }
     return true;
 }
 
+/**
+ * Write watching
+ */
+WatchHandle GuestVirtualMemory::watchWrites(U32 addr, U32 size, std::atomic<U32>* doorbell) {
+    std::lock_guard<std::mutex> lock(m_watchesMutex);
+    WatchHandle handle = 0;
+    while (handle < GUEST_WATCH_COUNT && m_watches[handle].active.load(std::memory_order_relaxed)) {
+        handle++;
+    }
+    if (handle == GUEST_WATCH_COUNT) {
+        logger.error(LOG_MEMORY, "Could not watch 0x%X bytes at 0x%08X: Too many watched ranges", size, addr);
+        return GUEST_WATCH_INVALID;
+    }
+    auto& watch = m_watches[handle];
+    watch.addr = addr;
+    watch.size = size;
+    watch.doorbell = doorbell;
+    watch.active.store(true, std::memory_order_release);
+
+    const U64 first = addr >> GUEST_PAGE_SHIFT;
+    const U64 last = (U64(addr) + size - 1) >> GUEST_PAGE_SHIFT;
+    protectPages(first, last, false, [&](U64 page) {
+        const U08 prev = m_pages[page].fetch_or(PAGE_GPU, std::memory_order_acq_rel);
+        return !(prev & PAGE_GPU) && (prev & PAGE_ALLOCATED) && !isWriteProtected(prev);
+    });
+    return handle;
+}
+
+void GuestVirtualMemory::unwatchWrites(WatchHandle handle) {
+    std::lock_guard<std::mutex> lock(m_watchesMutex);
+    if (handle >= GUEST_WATCH_COUNT || !m_watches[handle].active.load(std::memory_order_relaxed)) {
+        return;
+    }
+    auto& watch = m_watches[handle];
+    watch.active.store(false, std::memory_order_release);
+
+    const U64 first = watch.addr >> GUEST_PAGE_SHIFT;
+    const U64 last = (U64(watch.addr) + watch.size - 1) >> GUEST_PAGE_SHIFT;
+    protectPages(first, last, true, [&](U64 page) {
+        if (isWatched(page)) {
+            return false;
+        }
+        const U08 prev = m_pages[page].fetch_and(U08(~(PAGE_GPU | PAGE_DIRTY)), std::memory_order_acq_rel);
+        return (prev & PAGE_GPU) && !(prev & PAGE_CODE) && !(prev & PAGE_DIRTY);
+    });
+}
+
+bool GuestVirtualMemory::isWatched(U64 page) const {
+    const U64 pageAddr = page << GUEST_PAGE_SHIFT;
+    for (const auto& watch : m_watches) {
+        if (watch.active.load(std::memory_order_acquire) &&
+            pageAddr < U64(watch.addr) + watch.size && watch.addr < pageAddr + GUEST_PAGE_SIZE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void GuestVirtualMemory::ringWatchers(U64 page) {
+    const U64 pageAddr = page << GUEST_PAGE_SHIFT;
+    for (auto& watch : m_watches) {
+        if (!watch.active.load(std::memory_order_acquire) || !watch.doorbell) {
+            continue;
+        }
+        if (pageAddr < U64(watch.addr) + watch.size && watch.addr < pageAddr + GUEST_PAGE_SIZE) {
+            watch.doorbell->fetch_add(1, std::memory_order_release);
+            core::futexWakeOneFromHandler(*watch.doorbell);
+        }
+    }
+}
+
+bool GuestVirtualMemory::isDirty(U32 addr, U32 size) const {
+    const U64 first = addr >> GUEST_PAGE_SHIFT;
+    const U64 last = (U64(addr) + size - 1) >> GUEST_PAGE_SHIFT;
+    for (U64 page = first; page <= last; page++) {
+        if (m_pages[page].load(std::memory_order_acquire) & PAGE_DIRTY) {
+            return true;
+        }
+    }
+    return false;
+}
+
+U32 GuestVirtualMemory::resetDirty(U32 addr, U32 size, std::vector<U32>* pages) {
+    const U64 first = addr >> GUEST_PAGE_SHIFT;
+    const U64 last = (U64(addr) + size - 1) >> GUEST_PAGE_SHIFT;
+    U32 count = 0;
+
+    // Clear the flag before protecting, so that writes racing with the reset
+    // are either seen by the caller afterwards or mark the page dirty again
+    protectPages(first, last, false, [&](U64 page) {
+        const U08 prev = m_pages[page].fetch_and(U08(~PAGE_DIRTY), std::memory_order_acq_rel);
+        if (!(prev & PAGE_DIRTY)) {
+            return false;
+        }
+        count++;
+        if (pages) {
+            pages->push_back(U32(page << GUEST_PAGE_SHIFT));
+        }
+        return !(prev & PAGE_CODE);
+    });
+    return count;
+}
+
+/**
+ * Copy bytes in reverse order, as needed by partial vector accesses (lvlx, stvrx, etc.).
+ * Ranges of up to 16 bytes are swapped as two 64-bit words, and only the bytes within
+ * the range are accessed, so that neighboring data written by other threads is preserved.
+ */
+static void copyReversed(U08* dst, const U08* src, U32 size) {
+    if (size > 16) {
+        for (U32 i = 0; i < size; i++) {
+            dst[size - 1 - i] = src[i];
+        }
+        return;
+    }
+    U128 value = {0, 0};
+    std::memcpy(&value, src, size);
+    value = SE128(value);
+    std::memcpy(dst, reinterpret_cast<U08*>(&value) + 16 - size, size);
+}
+
 /**
  * Read memory reversing endianness if necessary
  */
@@ -92,14 +517,10 @@ U128 Memory::read128(U32 addr) {
     return SE128(*(U128*)((U64)m_base + addr));
 }
 void Memory::readLeft(U08* dst, U32 src, U32 size) {
-    for (U32 i = 0; i < size; i++) {
-        dst[size - 1 - i] = read8(src + i);
-    }
+    copyReversed(dst, ptr<U08>(src), size);
 }
 void Memory::readRight(U08* dst, U32 src, U32 size) {
-    for (U32 i = 0; i < size; i++) {
-        dst[i] = read8(src + (size - 1 - i));
-    }
+    copyReversed(dst, ptr<U08>(src), size);
 }
 
 /**
@@ -121,13 +542,85 @@ void Memory::write128(U32 addr, U128 value) {
     *(U128*)((U64)m_base + addr) = SE128(value);
 }
 void Memory::writeLeft(U32 dst, U08* src, U32 size) {
-    for (U32 i = 0; i < size; i++) {
-        write8(dst + i, src[size - 1 - i]);
-    }
+    copyReversed(ptr<U08>(dst), src, size);
 }
 void Memory::writeRight(U32 dst, U08* src, U32 size) {
-    for (U32 i = 0; i < size; i++) {
-        write8(dst + (size - 1 - i), src[i]);
+    copyReversed(ptr<U08>(dst), src, size);
+}
+
+/**
+ * Bulk copies reversing endianness
+ */
+void GuestVirtualMemory::copyFromGuestSwap16(void* dst, U32 src, Size count) {
+    copySwap16(dst, ptr(src), count);
+}
+void GuestVirtualMemory::copyToGuestSwap16(U32 dst, const void* src, Size count) {
+    copySwap16(ptr(dst), src, count);
+}
+void GuestVirtualMemory::copyFromGuestSwapStrided16(void* dst, U32 src, U32 stride, Size components, Size count) {
+    if (stride == components * 2) {
+        copySwap16(dst, ptr(src), components * count);
+        return;
+    }
+    for (Size i = 0; i < count; i++) {
+        copySwap16(static_cast<U08*>(dst) + i * components * 2, ptr(src + i * stride), components);
+    }
+}
+void GuestVirtualMemory::copyToGuestSwapStrided16(U32 dst, const void* src, U32 stride, Size components, Size count) {
+    if (stride == components * 2) {
+        copySwap16(ptr(dst), src, components * count);
+        return;
+    }
+    for (Size i = 0; i < count; i++) {
+        copySwap16(ptr(dst + i * stride), static_cast<const U08*>(src) + i * components * 2, components);
+    }
+}
+void GuestVirtualMemory::copyFromGuestSwap32(void* dst, U32 src, Size count) {
+    copySwap32(dst, ptr(src), count);
+}
+void GuestVirtualMemory::copyToGuestSwap32(U32 dst, const void* src, Size count) {
+    copySwap32(ptr(dst), src, count);
+}
+void GuestVirtualMemory::copyFromGuestSwapStrided32(void* dst, U32 src, U32 stride, Size components, Size count) {
+    if (stride == components * 4) {
+        copySwap32(dst, ptr(src), components * count);
+        return;
+    }
+    for (Size i = 0; i < count; i++) {
+        copySwap32(static_cast<U08*>(dst) + i * components * 4, ptr(src + i * stride), components);
+    }
+}
+void GuestVirtualMemory::copyToGuestSwapStrided32(U32 dst, const void* src, U32 stride, Size components, Size count) {
+    if (stride == components * 4) {
+        copySwap32(ptr(dst), src, components * count);
+        return;
+    }
+    for (Size i = 0; i < count; i++) {
+        copySwap32(ptr(dst + i * stride), static_cast<const U08*>(src) + i * components * 4, components);
+    }
+}
+void GuestVirtualMemory::copyFromGuestSwap64(void* dst, U32 src, Size count) {
+    copySwap64(dst, ptr(src), count);
+}
+void GuestVirtualMemory::copyToGuestSwap64(U32 dst, const void* src, Size count) {
+    copySwap64(ptr(dst), src, count);
+}
+void GuestVirtualMemory::copyFromGuestSwapStrided64(void* dst, U32 src, U32 stride, Size components, Size count) {
+    if (stride == components * 8) {
+        copySwap64(dst, ptr(src), components * count);
+        return;
+    }
+    for (Size i = 0; i < count; i++) {
+        copySwap64(static_cast<U08*>(dst) + i * components * 8, ptr(src + i * stride), components);
+    }
+}
+void GuestVirtualMemory::copyToGuestSwapStrided64(U32 dst, const void* src, U32 stride, Size components, Size count) {
+    if (stride == components * 8) {
+        copySwap64(ptr(dst), src, components * count);
+        return;
+    }
+    for (Size i = 0; i < count; i++) {
+        copySwap64(ptr(dst + i * stride), static_cast<const U08*>(src) + i * components * 8, components);
     }
 }
 
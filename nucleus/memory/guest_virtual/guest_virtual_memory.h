@@ -6,8 +6,17 @@
 #pragma once
 
 #include "nucleus/common.h"
+#include "nucleus/memory/fault.h"
+#include "nucleus/memory/reservation.h"
 #include "nucleus/memory/guest_virtual/guest_virtual_segment.h"
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
 namespace mem {
 
 enum {
@@ -24,6 +33,48 @@ enum {
     _SEG_COUNT,
 };
 
+// Guest page table granularity
+#define GUEST_PAGE_SHIFT   12
+#define GUEST_PAGE_SIZE    (1 << GUEST_PAGE_SHIFT)
+#define GUEST_PAGE_COUNT   (0x100000000ULL >> GUEST_PAGE_SHIFT)
+
+/**
+ * Guest page flags
+ * Allocations are made of 4 KB, 64 KB or 1 MB pages, but the page table tracks every
+ * region at 4 KB granularity, recording the size of the page it belongs to.
+ */
+enum PageFlags : U08 {
+    PAGE_ALLOCATED  = (1 << 0),  // Page is backed by host memory
+    PAGE_READ       = (1 << 1),  // Guest can read from the page
+    PAGE_WRITE      = (1 << 2),  // Guest can write to the page
+    PAGE_CODE       = (1 << 3),  // Page backs translated code and is write-protected
+    PAGE_GPU        = (1 << 4),  // Page is watched by GPU caches (textures, vertices, etc.)
+    PAGE_SIZE_64K   = (1 << 5),  // Page belongs to a 64 KB page
+    PAGE_SIZE_1M    = (1 << 6),  // Page belongs to a 1 MB page
+    PAGE_DIRTY      = (1 << 7),  // Page watched by GPU caches was written since the last reset
+};
+
+/**
+ * Callback invoked whenever a write hits a page containing translated code.
+ * It receives the guest address and size of the page that was unprotected.
+ */
+using CodeWriteCallback = std::function<void(U32 addr, U32 size)>;
+
+// Maximum number of ranges watched for writes at the same time
+#define GUEST_WATCH_COUNT    64
+#define GUEST_WATCH_INVALID  0xFFFFFFFF
+
+/**
+ * Identifies a range registered with GuestVirtualMemory::watchWrites
+ */
+using WatchHandle = U32;
+
+/**
+ * Callback returning the guest address of the code currently requesting memory,
+ * used to attribute allocations when tracing them.
+ */
+using CallerCallback = std::function<U32()>;
+
 /**
  * Guest Virtual Memory
  * ====================
@@ -49,6 +100,57 @@ class GuestVirtualMemory : public Memory {
     void* m_base;
     Segment m_segments[_SEG_COUNT];
 
+    // Page table: One entry of PageFlags per 4 KB guest page
+    std::unique_ptr<std::atomic<U08>[]> m_pages;
+
+    // Code pages written since the last flush: One bit per 4 KB guest page, set by the fault handler
+    std::unique_ptr<std::atomic<U64>[]> m_codeWrites;
+    std::atomic<bool> m_codeWritesPending{false};
+
+    CodeWriteCallback m_codeWriteCallback;
+    CallerCallback m_callerCallback;
+
+    // Ranges watched for writes. Entries never move and are published through `active`,
+    // so that the fault handler can find the owners of a page without taking locks.
+    struct WatchEntry {
+        std::atomic<bool> active{false};
+        U32 addr;
+        U32 size;
+        std::atomic<U32>* doorbell;
+    };
+    WatchEntry m_watches[GUEST_WATCH_COUNT];
+    std::mutex m_watchesMutex;
+
+    // Whether any registered range covers a page
+    bool isWatched(U64 page) const;
+
+    // Ring the doorbells of the ranges covering a page that became dirty.
+    // Called from the fault handler, so it must not allocate or take locks.
+    void ringWatchers(U64 page);
+
+    // Lock-line reservations shared by PPU and SPU atomics
+    ReservationTable m_reservations;
+
+    // Set host protection of a page range
+    bool protect(U32 addr, U32 size, bool writable);
+
+    // Set host protection of `count` pages starting at `first`. If write-protecting fails,
+    // the pages are left writable and their code and watch flags are updated accordingly.
+    void protectRun(U64 first, U64 count, bool writable);
+
+    // Set host protection of the pages in [first, last] selected by the predicate,
+    // merging consecutive pages into a single call
+    template <typename Predicate>
+    void protectPages(U64 first, U64 last, bool writable, Predicate predicate);
+
+    // Whether writes to a page must fault, given its flags
+    static bool isWriteProtected(U08 flags) {
+        return (flags & PAGE_CODE) || ((flags & PAGE_GPU) && !(flags & PAGE_DIRTY));
+    }
+
+    // Resolve faults caused by writes to protected code pages
+    static bool handleFault(FaultInfo& info, void* userdata);
+
 public:
     GuestVirtualMemory(Size amount);
     ~GuestVirtualMemory();
@@ -73,8 +175,131 @@ public:
     void writeLeft(U32 dst, U08* src, U32 size);
     void writeRight(U32 dst, U08* src, U32 size);
 
+    /**
+     * Bulk copies reversing the endianness of each element
+     * @param[out]  dst    Destination buffer or guest address
+     * @param[in]   src    Source guest address or buffer
+     * @param[in]   count  Number of elements
+     */
+    void copyFromGuestSwap16(void* dst, U32 src, Size count);
+    void copyFromGuestSwap32(void* dst, U32 src, Size count);
+    void copyFromGuestSwap64(void* dst, U32 src, Size count);
+    void copyToGuestSwap16(U32 dst, const void* src, Size count);
+    void copyToGuestSwap32(U32 dst, const void* src, Size count);
+    void copyToGuestSwap64(U32 dst, const void* src, Size count);
+
+    /**
+     * Bulk copies of interleaved records, e.g. vertex attributes, reversing the endianness
+     * of each element. Records are `stride` bytes apart in guest memory and packed in host memory.
+     * @param[out]  dst         Destination buffer or guest address
+     * @param[in]   src         Source guest address or buffer
+     * @param[in]   stride      Distance in bytes between records in guest memory
+     * @param[in]   components  Number of elements per record
+     * @param[in]   count       Number of records
+     */
+    void copyFromGuestSwapStrided16(void* dst, U32 src, U32 stride, Size components, Size count);
+    void copyFromGuestSwapStrided32(void* dst, U32 src, U32 stride, Size components, Size count);
+    void copyFromGuestSwapStrided64(void* dst, U32 src, U32 stride, Size components, Size count);
+    void copyToGuestSwapStrided16(U32 dst, const void* src, U32 stride, Size components, Size count);
+    void copyToGuestSwapStrided32(U32 dst, const void* src, U32 stride, Size components, Size count);
+    void copyToGuestSwapStrided64(U32 dst, const void* src, U32 stride, Size components, Size count);
+
+    /**
+     * Page table
+     * Lookups are a single byte load indexed by `addr >> GUEST_PAGE_SHIFT`, so emitted code
+     * can check flags inline using the address of the table as a constant.
+     */
+    void setPageFlags(U32 addr, U32 size, U08 flags);
+    void clearPageFlags(U32 addr, U32 size, U08 flags);
+    U08 getPageFlags(U32 addr) const {
+        return m_pages[addr >> GUEST_PAGE_SHIFT].load(std::memory_order_acquire);
+    }
+    const std::atomic<U08>* getPageTable() const {
+        return m_pages.get();
+    }
+
+    /**
+     * Mark a range as allocated and accessible
+     * @param[in]  addr      Guest address, aligned to 4 KB
+     * @param[in]  size      Size in bytes, aligned to 4 KB
+     * @param[in]  pageSize  Size of the guest pages backing the range
+     */
+    void mapPages(U32 addr, U32 size, U32 pageSize = 4_KB);
+    void unmapPages(U32 addr, U32 size);
+
+    /**
+     * Self-modifying code detection
+     * Pages backing translated code are write-protected and flagged in a bitmap.
+     * A guest or host write to any of them unprotects the page, clears its flag and
+     * records it. Since the fault handler cannot take locks, the callback is only
+     * notified on the next flush, so that the affected translations can be invalidated.
+     */
+    void protectCode(U32 addr, U32 size);
+    void unprotectCode(U32 addr, U32 size);
+    bool isCode(U32 addr) const;
+    void setCodeWriteCallback(CodeWriteCallback callback);
+
+    // Notify the callback of the code pages written since the last flush, outside signal context
+    void flushCodeWrites();
+
+    /**
+     * Write watching
+     * Watched pages are write-protected until written. The first write marks the page
+     * as dirty and makes it writable again, so that GPU caches can check in bulk which
+     * of their resources changed. Resetting a range clears its dirty pages and protects
+     * them again: callers must read the contents of a resource after resetting it.
+     * Ranges may overlap, and each one is owned by a single subscriber.
+     */
+
+    /**
+     * Start watching a range for writes
+     * @param[in]  addr      Guest address
+     * @param[in]  size      Size in bytes
+     * @param[in]  doorbell  Optional word incremented whenever a page of this range becomes
+     *                       dirty, waking up one thread blocked on it with core::futexWait.
+     *                       This happens in the faulting thread, possibly in signal context.
+     * @return               Handle of the range, or GUEST_WATCH_INVALID on failure
+     */
+    WatchHandle watchWrites(U32 addr, U32 size, std::atomic<U32>* doorbell = nullptr);
+
+    /**
+     * Stop watching a range. Pages covered by other ranges remain watched.
+     * @param[in]  handle  Handle returned by watchWrites
+     */
+    void unwatchWrites(WatchHandle handle);
+
+    bool isDirty(U32 addr, U32 size) const;
+
+    /**
+     * Clear the dirty state of the watched pages in a range
+     * @param[in]   addr   Guest address
+     * @param[in]   size   Size in bytes
+     * @param[out]  pages  Optional list where the address of each dirty page is appended
+     * @return             Number of pages that were dirty
+     */
+    U32 resetDirty(U32 addr, U32 size, std::vector<U32>* pages = nullptr);
+
+    /**
+     * Statistics
+     * Segments keep live usage counters, and when allocation tracing is enabled they
+     * also record the guest code that requested each block, as given by the callback.
+     */
+    void setCallerCallback(CallerCallback callback);
+    U32 getCaller() const;
+
+    /**
+     * Summarize usage of each segment and the callers holding most memory
+     * @param[in]  maxCallers  Maximum number of callers to list
+     */
+    std::string report(Size maxCallers = 10);
+
+    // Print the report to the log
+    void dump();
+
     void* getBaseAddr() { return m_base; }
 
+    ReservationTable& getReservations() { return m_reservations; }
+
     Segment& getSegment(size_t id) { return m_segments[id]; }
 
     template <typename T>
@@ -3,16 +3,21 @@
  * Released under GPL v2 license. Read LICENSE for more details.
  */
 
-#include "segment.h"
-#include "nucleus/memory/memory.h"
+#include "guest_virtual_segment.h"
+#include "nucleus/memory/guest_virtual/guest_virtual_memory.h"
+#include "nucleus/logger/logger.h"
 
 #if defined(NUCLEUS_TARGET_WINDOWS)
 #include <Windows.h>
 #elif defined(NUCLEUS_TARGET_LINUX) || defined(NUCLEUS_TARGET_OSX)
 #include <sys/mman.h>
 #endif
+#if defined(NUCLEUS_TARGET_OSX)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
 
-#include <cstring>
+#include <algorithm>
+#include <tuple>
 
 // Get real size for 4K pages
 #define PAGE_4K(x) (((x) + 4095) & ~(4095))
@@ -20,34 +25,56 @@
 namespace mem {
 
 // Memory blocks
-Block::Block(void* baseAddr, U32 blockAddr, U32 blockSize) {
+Block::Block(void* baseAddr, U32 blockAddr, U32 blockSize, PageBacking preferred) {
     // Initialize members
     addr = blockAddr;
     size = PAGE_4K(blockSize);
     realaddr = reinterpret_cast<void*>((reinterpret_cast<intptr_t>(baseAddr) + blockAddr));
+    backing = BACKING_DEFAULT;
 
-    bool success;
+    // Replacing the reserved range with new anonymous pages yields zeroed memory
+    // that is only backed by the host once the guest touches it
+    bool success = false;
 #if defined(NUCLEUS_TARGET_UWP)
     success = false;
 #elif defined(NUCLEUS_TARGET_WINDOWS)
-    success = VirtualAlloc(realaddr, size, MEM_COMMIT, PAGE_READWRITE) != realaddr;
+    // Large pages can't be committed inside an existing reservation
+    success = VirtualAlloc(realaddr, size, MEM_COMMIT, PAGE_READWRITE) == realaddr;
 #elif defined(NUCLEUS_TARGET_LINUX) || defined(NUCLEUS_TARGET_OSX)
-    success = ::mprotect(realaddr, blockSize, PROT_READ | PROT_WRITE);
+    const int prot = PROT_READ | PROT_WRITE;
+    const int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED;
+    success = ::mmap(realaddr, size, prot, flags, -1, 0) == realaddr;
+#if defined(MADV_HUGEPAGE)
+    // The host decides whether to merge the pages, so this only records the advice
+    if (success && preferred == BACKING_TRANSPARENT) {
+        if (::madvise(realaddr, size, MADV_HUGEPAGE) == 0) {
+            backing = BACKING_TRANSPARENT;
+        }
+    }
+#endif
 #endif
     if (!success) {
         realaddr = nullptr;
-        return;
     }
+}
 
-    //Memory.RegisterPages(_addr, PAGE_4K(_size)); // TODO
-    memset(realaddr, 0, size);
+void Block::release() {
+    if (!realaddr) {
+        return;
+    }
+#if defined(NUCLEUS_TARGET_WINDOWS) && !defined(NUCLEUS_TARGET_UWP)
+    VirtualFree(realaddr, size, MEM_DECOMMIT);
+#elif defined(NUCLEUS_TARGET_LINUX) || defined(NUCLEUS_TARGET_OSX)
+    ::mmap(realaddr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE, -1, 0);
+#endif
+    realaddr = nullptr;
 }
 
 // Memory segments
 Segment::Segment() {
 }
 
-Segment::Segment(Memory* parent, U32 start, U32 size) {
+Segment::Segment(GuestVirtualMemory* parent, U32 start, U32 size) {
     init(parent, start, size);
 }
 
@@ -55,14 +82,65 @@ Segment::~Segment() {
     close();
 }
 
-void Segment::init(Memory* parent, U32 start, U32 size) {
+void Segment::init(GuestVirtualMemory* parent, U32 start, U32 size) {
     close();
     m_parent = parent;
     m_start = start;
     m_size = size;
+    insertFreeRange(start, size);
 }
 
 void Segment::close() {
+    m_allocated.clear();
+    m_freeByAddr.clear();
+    m_freeBySize.clear();
+    m_used = 0;
+    m_peak = 0;
+    for (auto& backed : m_backed) {
+        backed = 0;
+    }
+}
+
+void Segment::insertFreeRange(U32 addr, U32 size) {
+    if (size == 0) {
+        return;
+    }
+    m_freeByAddr.emplace(addr, size);
+    m_freeBySize.emplace(size, addr);
+}
+
+void Segment::eraseFreeRange(std::map<U32, U32>::iterator it) {
+    m_freeBySize.erase(std::make_pair(it->second, it->first));
+    m_freeByAddr.erase(it);
+}
+
+bool Segment::reserve(std::map<U32, U32>::iterator range, U32 addr, U32 size) {
+    // Commit host memory first, so that nothing needs to be undone if it fails
+    Block committed(m_parent->getBaseAddr(), addr, size, m_backing);
+    if (!committed.realaddr) {
+        logger.error(LOG_MEMORY, "Could not commit 0x%X bytes at 0x%08X", size, addr);
+        return false;
+    }
+
+    const U32 rangeAddr = range->first;
+    const U64 rangeEnd = U64(range->first) + range->second;
+    eraseFreeRange(range);
+
+    // Give back the space left at both sides of the block
+    insertFreeRange(rangeAddr, addr - rangeAddr);
+    insertFreeRange(addr + size, U32(rangeEnd - (U64(addr) + size)));
+
+    auto block = m_allocated.emplace(addr, committed).first;
+    m_used += size;
+    m_peak = std::max(m_peak, m_used);
+    m_backed[block->second.backing] += size;
+
+    if (m_tracing) {
+        block->second.caller = m_parent->getCaller();
+        logger.notice(LOG_MEMORY, "Allocated 0x%08X (0x%X bytes) from 0x%08X",
+            addr, size, block->second.caller);
+    }
+    return true;
 }
 
 U32 Segment::alloc(U32 size, U32 align) {
@@ -79,24 +157,21 @@ U32 Segment::alloc(U32 size, U32 align) {
 
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    for (U32 addr = m_start; addr <= m_start + m_size - exsize;) {
-        for (const auto& block : m_allocated) {
-            if ((block.addr <= addr && addr < block.addr + block.size) ||
-                (addr <= block.addr && block.addr < addr + exsize)) {
-                addr = block.addr + block.size;
-                continue;
-            }
-        }
-
-        if (align) {
-            addr = (addr + (align - 1)) & ~(align - 1);
-        }
-
-        m_allocated.emplace_back(m_parent->getBaseAddr(), addr, size);
-        return addr;
+    // Smallest free range that fits the block at any alignment
+    auto bySize = m_freeBySize.lower_bound(std::make_pair(exsize, U32(0)));
+    if (bySize == m_freeBySize.end()) {
+        return 0;
+    }
+    U32 addr = bySize->second;
+    if (align) {
+        addr = (addr + (align - 1)) & ~(align - 1);
     }
 
-    return 0;
+    if (!reserve(m_freeByAddr.find(bySize->second), addr, size)) {
+        return 0;
+    }
+    m_parent->mapPages(addr, size, align ? align : 4_KB);
+    return addr;
 }
 
 U32 Segment::allocFixed(U32 addr, U32 size) {
@@ -109,27 +184,59 @@ U32 Segment::allocFixed(U32 addr, U32 size) {
 
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    for (const auto& block : m_allocated) {
-        if (block.addr <= addr && addr < block.addr + block.size) { // TODO: Check (addr <= block.addr && block.addr < addr + exsize) ?
-            return 0;
-        }
+    // The whole range must lie within a single free range
+    auto range = m_freeByAddr.upper_bound(addr);
+    if (range == m_freeByAddr.begin()) {
+        return 0;
+    }
+    range--;
+    if (U64(range->first) + range->second < U64(addr) + size) {
+        return 0;
     }
 
-    m_allocated.emplace_back(m_parent->getBaseAddr(), addr, size);
+    if (!reserve(range, addr, size)) {
+        return 0;
+    }
+    m_parent->mapPages(addr, size);
     return addr;
 }
 
 bool Segment::free(U32 addr) {
     std::lock_guard<std::mutex> lock(m_mutex);
 
-    for (auto it = m_allocated.begin(); it != m_allocated.end(); it++) {
-        if (it->addr == addr) {
-            m_allocated.erase(it);
-            return true;
+    auto block = m_allocated.find(addr);
+    if (block == m_allocated.end()) {
+        return false;
+    }
+    U32 rangeAddr = block->second.addr;
+    U32 rangeSize = block->second.size;
+    m_parent->unmapPages(rangeAddr, rangeSize);
+    m_backed[block->second.backing] -= rangeSize;
+    if (m_tracing) {
+        logger.notice(LOG_MEMORY, "Freed 0x%08X (0x%X bytes) from 0x%08X, allocated from 0x%08X",
+            rangeAddr, rangeSize, m_parent->getCaller(), block->second.caller);
+    }
+    block->second.release();
+    m_used -= rangeSize;
+    m_allocated.erase(block);
+
+    // Merge with the adjacent free ranges
+    auto next = m_freeByAddr.lower_bound(rangeAddr);
+    if (next != m_freeByAddr.end() && next->first == rangeAddr + rangeSize) {
+        rangeSize += next->second;
+        eraseFreeRange(next);
+    }
+    auto prev = m_freeByAddr.lower_bound(rangeAddr);
+    if (prev != m_freeByAddr.begin()) {
+        prev--;
+        if (prev->first + prev->second == rangeAddr) {
+            rangeAddr = prev->first;
+            rangeSize += prev->second;
+            eraseFreeRange(prev);
         }
     }
-
-    return false;
+    insertFreeRange(rangeAddr, rangeSize);
+    return true;
 }
 
 bool Segment::isValid(U32 addr) {
@@ -144,15 +251,54 @@ U32 Segment::getTotalMemory() const {
 }
 
 U32 Segment::getUsedMemory() const {
-    U32 usedMemory = 0;
-    for (const auto& block : m_allocated) {
-        usedMemory += block.size;
-    }
-    return usedMemory;
+    return m_used;
 }
 
 U32 Segment::getBaseAddr() const {
     return m_start;
 }
 
+void Segment::setBacking(PageBacking backing) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_backing = backing;
+}
+
+U32 Segment::getBackedMemory(PageBacking backing) const {
+    return m_backed[backing];
+}
+
+void Segment::setTracing(bool enable) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tracing = enable;
+}
+
+U32 Segment::getPeakMemory() const {
+    return m_peak;
+}
+
+U32 Segment::getLargestFreeBlock() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_freeBySize.empty()) {
+        return 0;
+    }
+    return m_freeBySize.rbegin()->first;
+}
+
+Size Segment::getBlockCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_allocated.size();
+}
+
+Size Segment::getFreeRangeCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_freeByAddr.size();
+}
+
+void Segment::forEachBlock(const std::function<void(const Block&)>& callback) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& entry : m_allocated) {
+        callback(entry.second);
+    }
+}
+
 }  // namespace mem
@@ -7,35 +7,89 @@
 
 #include "nucleus/common.h"
 
+#include <functional>
+#include <map>
 #include <mutex>
-#include <vector>
+#include <set>
+#include <utility>
 
 namespace mem {
 
 // Forward declarations
-class Memory;
+class GuestVirtualMemory;
 
+// Host pages backing guest memory
+enum PageBacking {
+    BACKING_DEFAULT = 0,   // Regular host pages
+    BACKING_TRANSPARENT,   // Regular host pages, advised to be merged into transparent huge pages
+
+    // Count of backing types
+    _BACKING_COUNT,
+};
+
+/**
+ * Block
+ * =====
+ * Committed range of guest memory. Host pages are mapped as fresh anonymous memory,
+ * so the host kernel supplies zero-filled pages on first touch and untouched parts
+ * of large allocations never consume physical memory.
+ */
 struct Block {
     U32 addr;
     U32 size;
     void* realaddr;
+    PageBacking backing;
+    U32 caller = 0;  // Guest address of the code that requested the block, if traced
+
+    /**
+     * Commit a range of guest memory
+     * @param[in]  baseAddr   Host address of the guest memory reservation
+     * @param[in]  blockAddr  Guest address of the block
+     * @param[in]  blockSize  Size of the block in bytes
+     * @param[in]  backing    Preferred host pages, falling back to regular pages if unavailable
+     */
+    Block(void* baseAddr, U32 blockAddr, U32 blockSize, PageBacking backing=BACKING_DEFAULT);
 
-    Block(void* baseAddr, U32 blockAddr, U32 blockSize);
+    // Return the host pages of this block and make the range inaccessible again
+    void release();
 };
 
+/**
+ * Segment
+ * =======
+ * Range of guest memory where blocks are allocated. Free space is tracked as a set of
+ * disjoint ranges indexed both by address, to merge neighbors when blocks are freed,
+ * and by size, to find the smallest range that fits a request. Every operation takes
+ * logarithmic time in the number of blocks and ranges.
+ */
 class Segment {
-    Memory* m_parent;
+    GuestVirtualMemory* m_parent;
     U32 m_start;
     U32 m_size;
-    std::mutex m_mutex;
-    std::vector<Block> m_allocated;
+    U32 m_used = 0;
+    U32 m_peak = 0;
+    U32 m_backed[_BACKING_COUNT] = {};            // Bytes committed with each backing
+    PageBacking m_backing = BACKING_DEFAULT;
+    bool m_tracing = false;
+    mutable std::mutex m_mutex;
+    std::map<U32, Block> m_allocated;             // Allocated blocks by address
+    std::map<U32, U32> m_freeByAddr;              // Free ranges: address -> size
+    std::set<std::pair<U32, U32>> m_freeBySize;  // Free ranges: (size, address)
+
+    // Free range management
+    void insertFreeRange(U32 addr, U32 size);
+    void eraseFreeRange(std::map<U32, U32>::iterator it);
+
+    // Take [addr, addr+size) out of the given free range and register it as a block.
+    // Returns false, leaving the free range untouched, if host memory could not be committed.
+    bool reserve(std::map<U32, U32>::iterator range, U32 addr, U32 size);
 
 public:
     Segment();
-    Segment(Memory* parent, U32 start, U32 size);
+    Segment(GuestVirtualMemory* parent, U32 start, U32 size);
     ~Segment();
 
-    void init(Memory* parent, U32 start, U32 size);
+    void init(GuestVirtualMemory* parent, U32 start, U32 size);
     void close();
 
     U32 alloc(U32 size, U32 align=1);
@@ -46,6 +100,36 @@ public:
     U32 getTotalMemory() const;
     U32 getUsedMemory() const;
     U32 getBaseAddr() const;
+
+    /**
+     * Request the host pages backing blocks allocated from now on
+     * @param[in]  backing  Preferred backing
+     */
+    void setBacking(PageBacking backing);
+
+    /**
+     * Get the amount of allocated memory committed with the given backing
+     * @param[in]  backing  Type of host pages
+     */
+    U32 getBackedMemory(PageBacking backing) const;
+
+    /**
+     * Log every allocation and release along with the guest code requesting it
+     * @param[in]  enable  Whether to trace allocations
+     */
+    void setTracing(bool enable);
+
+    // Usage statistics
+    U32 getPeakMemory() const;
+    U32 getLargestFreeBlock() const;
+    Size getBlockCount() const;
+    Size getFreeRangeCount() const;
+
+    /**
+     * Visit all allocated blocks while holding the segment lock
+     * @param[in]  callback  Function called for each block, in address order
+     */
+    void forEachBlock(const std::function<void(const Block&)>& callback) const;
 };
 
 }  // namespace mem
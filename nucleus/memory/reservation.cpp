@@ -0,0 +1,66 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "reservation.h"
+
+#include <thread>
+
+namespace mem {
+
+ReservationTable::ReservationTable() {
+    versions = std::make_unique<std::atomic<U64>[]>(RESERVATION_TABLE_SIZE);
+    for (Size i = 0; i < RESERVATION_TABLE_SIZE; i++) {
+        versions[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+U64 ReservationTable::acquire(U32 addr) {
+    auto& version = getVersion(addr);
+    U64 value = version.load(std::memory_order_acquire);
+    while (value & 1) {
+        std::this_thread::yield();
+        value = version.load(std::memory_order_acquire);
+    }
+    return value;
+}
+
+bool ReservationTable::lock(U32 addr, U64 version) {
+    U64 expected = version;
+    return getVersion(addr).compare_exchange_strong(expected, version | 1, std::memory_order_acquire);
+}
+
+void ReservationTable::lock(U32 addr) {
+    auto& version = getVersion(addr);
+    while (true) {
+        U64 expected = version.load(std::memory_order_relaxed) & ~1ULL;
+        if (version.compare_exchange_weak(expected, expected | 1, std::memory_order_acquire)) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+}
+
+void ReservationTable::unlock(U32 addr, bool modified) {
+    // Atomic updates keep the increments made by concurrent notifications
+    auto& version = getVersion(addr);
+    if (modified) {
+        version.fetch_add(1, std::memory_order_release);
+    } else {
+        version.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void ReservationTable::notify(U32 addr, U32 size) {
+    if (size == 0) {
+        return;
+    }
+    const U64 first = addr >> RESERVATION_LINE_SHIFT;
+    const U64 last = (U64(addr) + size - 1) >> RESERVATION_LINE_SHIFT;
+    for (U64 line = first; line <= last && line - first < RESERVATION_TABLE_SIZE; line++) {
+        getVersion(U32(line << RESERVATION_LINE_SHIFT)).fetch_add(2, std::memory_order_release);
+    }
+}
+
+}  // namespace mem
@@ -0,0 +1,89 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+
+#include <atomic>
+#include <memory>
+
+namespace mem {
+
+// Reservation granule: PPU and SPU atomics operate on 128-byte lock lines
+#define RESERVATION_LINE_SHIFT   7
+#define RESERVATION_LINE_SIZE    (1 << RESERVATION_LINE_SHIFT)
+#define RESERVATION_LINE_MASK    (RESERVATION_LINE_SIZE - 1)
+
+// Number of version counters (lines are hashed into this table)
+#define RESERVATION_TABLE_SHIFT  16
+#define RESERVATION_TABLE_SIZE   (1 << RESERVATION_TABLE_SHIFT)
+
+/**
+ * Reservation table
+ * =================
+ * Every 128-byte line of guest memory is mapped to a version counter. Even values mean
+ * the line is unlocked, odd values mean a conditional or atomic store is in progress.
+ * Taking a reservation just records the current version, and a conditional store
+ * succeeds only if it can bump the version it saw, so no global lock is ever taken.
+ * Lines that share a counter can cause spurious failures, which guest code must
+ * tolerate anyway, as reservations can be lost at any time on real hardware.
+ */
+class ReservationTable {
+    std::unique_ptr<std::atomic<U64>[]> versions;
+
+    std::atomic<U64>& getVersion(U32 addr) {
+        return versions[(addr >> RESERVATION_LINE_SHIFT) & (RESERVATION_TABLE_SIZE - 1)];
+    }
+
+public:
+    ReservationTable();
+
+    /**
+     * Get the version of the line containing the address, waiting for pending stores
+     * @param[in]  addr  Guest address
+     * @return           Version to be passed later to `lock`
+     */
+    U64 acquire(U32 addr);
+
+    /**
+     * Check whether the line is still at the given version
+     * @param[in]  addr     Guest address
+     * @param[in]  version  Version obtained with `acquire`
+     */
+    bool check(U32 addr, U64 version) {
+        return getVersion(addr).load(std::memory_order_acquire) == version;
+    }
+
+    /**
+     * Lock the line if it is still at the given version
+     * @param[in]  addr     Guest address
+     * @param[in]  version  Version obtained with `acquire`
+     * @return              True if the line was locked, false if the reservation was lost
+     */
+    bool lock(U32 addr, U64 version);
+
+    /**
+     * Lock the line unconditionally, waiting for other stores to complete
+     * @param[in]  addr  Guest address
+     */
+    void lock(U32 addr);
+
+    /**
+     * Unlock a locked line
+     * @param[in]  addr      Guest address
+     * @param[in]  modified  Whether the line was written, invalidating other reservations
+     */
+    void unlock(U32 addr, bool modified = true);
+
+    /**
+     * Invalidate the reservations of every line overlapping a range written by other means
+     * @param[in]  addr  Guest address
+     * @param[in]  size  Size in bytes
+     */
+    void notify(U32 addr, U32 size);
+};
+
+}  // namespace mem
@@ -0,0 +1,183 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#include "swap.h"
+
+#include <cstring>
+
+#if defined(NUCLEUS_ARCH_X86)
+#include <immintrin.h>
+#if defined(NUCLEUS_COMPILER_MSVC)
+#include <intrin.h>
+#define SWAP_TARGET(extension)
+#else
+#define SWAP_TARGET(extension) __attribute__((target(extension)))
+#endif
+#endif
+
+namespace mem {
+
+// Scalar paths
+void copySwap16Scalar(void* dst, const void* src, Size count) {
+    auto* d = static_cast<U08*>(dst);
+    auto* s = static_cast<const U08*>(src);
+    for (Size i = 0; i < count; i++) {
+        U16 value;
+        std::memcpy(&value, s + 2*i, sizeof(value));
+        value = SE16(value);
+        std::memcpy(d + 2*i, &value, sizeof(value));
+    }
+}
+
+void copySwap32Scalar(void* dst, const void* src, Size count) {
+    auto* d = static_cast<U08*>(dst);
+    auto* s = static_cast<const U08*>(src);
+    for (Size i = 0; i < count; i++) {
+        U32 value;
+        std::memcpy(&value, s + 4*i, sizeof(value));
+        value = SE32(value);
+        std::memcpy(d + 4*i, &value, sizeof(value));
+    }
+}
+
+void copySwap64Scalar(void* dst, const void* src, Size count) {
+    auto* d = static_cast<U08*>(dst);
+    auto* s = static_cast<const U08*>(src);
+    for (Size i = 0; i < count; i++) {
+        U64 value;
+        std::memcpy(&value, s + 8*i, sizeof(value));
+        value = SE64(value);
+        std::memcpy(d + 8*i, &value, sizeof(value));
+    }
+}
+
+#if defined(NUCLEUS_ARCH_X86)
+// Byte shuffles reversing each element within a 16-byte vector
+alignas(16) static const U08 maskSwap16[16] = { 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 };
+alignas(16) static const U08 maskSwap32[16] = { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 };
+alignas(16) static const U08 maskSwap64[16] = { 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 };
+
+static SwapPath detectSwapPath() {
+#if defined(NUCLEUS_COMPILER_MSVC)
+    int data[4];
+    __cpuid(data, 0x00000001);
+    const bool ssse3 = (data[2] >> 9) & 1;
+    const bool osxsave = (data[2] >> 27) & 1;
+    const bool avx = (data[2] >> 28) & 1;
+    __cpuidex(data, 0x00000007, 0);
+    const bool avx2 = (data[1] >> 5) & 1;
+    if (avx && avx2 && osxsave && (_xgetbv(0) & 6) == 6) {
+        return SWAP_PATH_AVX2;
+    }
+    if (ssse3) {
+        return SWAP_PATH_SSSE3;
+    }
+#else
+    if (__builtin_cpu_supports("avx2")) {
+        return SWAP_PATH_AVX2;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        return SWAP_PATH_SSSE3;
+    }
+#endif
+    return SWAP_PATH_SCALAR;
+}
+
+
+// Vector paths: Return the number of bytes copied, always a multiple of 16
+SWAP_TARGET("ssse3")
+static Size copySwapSSSE3(U08* dst, const U08* src, Size bytes, const U08* mask) {
+    const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+    Size i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(value, shuffle));
+    }
+    return i;
+}
+
+SWAP_TARGET("avx2")
+static Size copySwapAVX2(U08* dst, const U08* src, Size bytes, const U08* mask) {
+    // Shuffles don't cross 128-bit lanes, so both lanes use the same mask
+    const __m128i shuffle128 = _mm_load_si128(reinterpret_cast<const __m128i*>(mask));
+    const __m256i shuffle256 = _mm256_broadcastsi128_si256(shuffle128);
+    Size i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_shuffle_epi8(value, shuffle256));
+    }
+    if (i + 16 <= bytes) {
+        const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(value, shuffle128));
+        i += 16;
+    }
+    return i;
+}
+
+static Size copySwapVector(void* dst, const void* src, Size bytes, const U08* mask, SwapPath path) {
+    auto* d = static_cast<U08*>(dst);
+    auto* s = static_cast<const U08*>(src);
+    switch (path) {
+    case SWAP_PATH_AVX2:
+        return copySwapAVX2(d, s, bytes, mask);
+    case SWAP_PATH_SSSE3:
+        return copySwapSSSE3(d, s, bytes, mask);
+    default:
+        return 0;
+    }
+}
+#else
+static SwapPath detectSwapPath() {
+    return SWAP_PATH_SCALAR;
+}
+#endif
+
+// Best implementation supported by the host
+static SwapPath getSwapPath() {
+    static const SwapPath path = detectSwapPath();
+    return path;
+}
+
+bool isSwapPathSupported(SwapPath path) {
+    return path <= getSwapPath();
+}
+
+void copySwap16(void* dst, const void* src, Size count, SwapPath path) {
+    Size done = 0;
+#if defined(NUCLEUS_ARCH_X86)
+    done = copySwapVector(dst, src, 2 * count, maskSwap16, path);
+#endif
+    copySwap16Scalar(static_cast<U08*>(dst) + done, static_cast<const U08*>(src) + done, count - done / 2);
+}
+
+void copySwap32(void* dst, const void* src, Size count, SwapPath path) {
+    Size done = 0;
+#if defined(NUCLEUS_ARCH_X86)
+    done = copySwapVector(dst, src, 4 * count, maskSwap32, path);
+#endif
+    copySwap32Scalar(static_cast<U08*>(dst) + done, static_cast<const U08*>(src) + done, count - done / 4);
+}
+
+void copySwap64(void* dst, const void* src, Size count, SwapPath path) {
+    Size done = 0;
+#if defined(NUCLEUS_ARCH_X86)
+    done = copySwapVector(dst, src, 8 * count, maskSwap64, path);
+#endif
+    copySwap64Scalar(static_cast<U08*>(dst) + done, static_cast<const U08*>(src) + done, count - done / 8);
+}
+
+void copySwap16(void* dst, const void* src, Size count) {
+    copySwap16(dst, src, count, getSwapPath());
+}
+
+void copySwap32(void* dst, const void* src, Size count) {
+    copySwap32(dst, src, count, getSwapPath());
+}
+
+void copySwap64(void* dst, const void* src, Size count) {
+    copySwap64(dst, src, count, getSwapPath());
+}
+
+}  // namespace mem
@@ -0,0 +1,66 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+#pragma once
+
+#include "nucleus/common.h"
+
+namespace mem {
+
+/**
+ * Bulk endianness swapping
+ * ========================
+ * Copy arrays of 16, 32 or 64-bit elements between buffers, reversing the byte order
+ * of each element. On x86 hosts the copy uses a single `pshufb` per 16 bytes (SSSE3)
+ * or 32 bytes (AVX2), selected at startup depending on the host CPU. Source and
+ * destination buffers can be unaligned but must not overlap, unless they are equal.
+ */
+
+// Implementations of the copies, in increasing order of host requirements
+enum SwapPath {
+    SWAP_PATH_SCALAR,
+    SWAP_PATH_SSSE3,
+    SWAP_PATH_AVX2,
+};
+
+/**
+ * Check whether the host can run the given implementation
+ * @param[in]  path  Implementation
+ */
+bool isSwapPathSupported(SwapPath path);
+
+/**
+ * Copy elements reversing their byte order
+ * @param[out]  dst    Destination buffer
+ * @param[in]   src    Source buffer
+ * @param[in]   count  Number of elements
+ */
+void copySwap16(void* dst, const void* src, Size count);
+void copySwap32(void* dst, const void* src, Size count);
+void copySwap64(void* dst, const void* src, Size count);
+
+/**
+ * Copy elements reversing their byte order with a specific implementation, which must be
+ * supported by the host. Vector paths finish the elements that don't fill a vector with scalar code.
+ * @param[out]  dst    Destination buffer
+ * @param[in]   src    Source buffer
+ * @param[in]   count  Number of elements
+ * @param[in]   path   Implementation
+ */
+void copySwap16(void* dst, const void* src, Size count, SwapPath path);
+void copySwap32(void* dst, const void* src, Size count, SwapPath path);
+void copySwap64(void* dst, const void* src, Size count, SwapPath path);
+
+/**
+ * Reference implementation of the copies above, used as fallback on non-x86 hosts
+ * @param[out]  dst    Destination buffer
+ * @param[in]   src    Source buffer
+ * @param[in]   count  Number of elements
+ */
+void copySwap16Scalar(void* dst, const void* src, Size count);
+void copySwap32Scalar(void* dst, const void* src, Size count);
+void copySwap64Scalar(void* dst, const void* src, Size count);
+
+}  // namespace mem
@@ -5,8 +5,12 @@
 
 #include "nucleus.h"
 #include "nucleus/core/config.h"
+#include "nucleus/cpu/backend/profiler.h"
+#include "nucleus/cpu/hir/module.h"
 #include "nucleus/debugger/debugger.h"
 #include "nucleus/emulator.h"
+#include "nucleus/memory/memory.h"
+#include "nucleus/memory/guest_virtual/guest_virtual_memory.h"
 #include "nucleus/ui/ui.h"
 
 #include <iostream>
@@ -55,6 +59,17 @@ int nucleusInitialize(int argc, char **argv) {
             << "  --console      Avoids the Nucleus UI window, disabling GPU backends.\n"
             << "  --debugger     Create a Nerve backend debugging server.\n"
             << "                 More information at: http://alexaltea.github.io/nerve/ \n"
+            << "  --profile      Count calls to translated functions and report the hottest ones at exit.\n"
+            << "  --profile-cycles  Same as --profile, additionally measuring time spent in each function.\n"
+            << "  --spu-module   Translate whole SPU programs when they start, instead of function by function.\n"
+            << "  --spu-interpreter  Interpret SPU programs instead of translating them.\n"
+            << "  --spu-tiered   Interpret SPU programs, translating functions once they are called often.\n"
+            << "  --spu-async-dma  Perform large SPU DMA transfers in the background.\n"
+            << "  --huge-pages   Advise the host to back guest memory with transparent huge pages.\n"
+            << "  --memory-stats  Report guest memory usage per segment at exit.\n"
+            << "  --trace-alloc  Same as --memory-stats, additionally logging each allocation and its caller.\n"
+            << "  --fastmem      Access guest memory from translated code through a pinned base register (x86-64 only).\n"
+            << "  --hir-dump <dir>  Save the HIR of translated PPU/SPU modules to the given directory at exit.\n"
             << std::endl;
     }
 
@@ -71,6 +86,24 @@ int nucleusInitialize(int argc, char **argv) {
         nucleus.idle();
     }
 
+    // Report profiling results
+    if (config.profile) {
+        profiler.dump();
+    }
+
+    // Save translated modules
+    if (!config.hirDump.empty()) {
+        cpu::hir::Module::saveAll(config.hirDump);
+    }
+
+    // Report guest memory usage
+    if (config.memoryStats || config.hugePages) {
+        auto* guestMemory = dynamic_cast<mem::GuestVirtualMemory*>(nucleus.memory.get());
+        if (guestMemory) {
+            guestMemory->dump();
+        }
+    }
+
     return 0;
 }
 
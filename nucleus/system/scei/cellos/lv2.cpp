@@ -131,12 +131,12 @@ LV2::LV2(std::shared_ptr<mem::Memory> memory, U32 fw_type) : memory(std::move(me
         //syscalls[0x0B4] = SYSCALL(sys_spu_thread_group_get_priority, LV2_NONE);
         //syscalls[0x0B5] = SYSCALL(sys_spu_thread_write_ls, LV2_NONE);
         syscalls[0x0B6] = SYSCALL(sys_spu_thread_read_ls, LV2_NONE);
-        //syscalls[0x0B8] = SYSCALL(sys_spu_thread_write_snr, LV2_NONE);
+        syscalls[0x0B8] = SYSCALL(sys_spu_thread_write_snr, LV2_NONE);
         syscalls[0x0B9] = SYSCALL(sys_spu_thread_group_connect_event, LV2_NONE);
         //syscalls[0x0BA] = SYSCALL(sys_spu_thread_group_disconnect_event, LV2_NONE);
         //syscalls[0x0BB] = SYSCALL(sys_spu_thread_set_spu_cfg, LV2_NONE);
         //syscalls[0x0BC] = SYSCALL(sys_spu_thread_get_spu_cfg, LV2_NONE);
-        //syscalls[0x0BE] = SYSCALL(sys_spu_thread_write_spu_mb, LV2_NONE);
+        syscalls[0x0BE] = SYSCALL(sys_spu_thread_write_spu_mb, LV2_NONE);
         //syscalls[0x0BF] = SYSCALL(sys_spu_thread_connect_event, LV2_NONE);
         //syscalls[0x0C0] = SYSCALL(sys_spu_thread_disconnect_event, LV2_NONE);
         //syscalls[0x0C1] = SYSCALL(sys_spu_thread_bind_queue, LV2_NONE);
@@ -8,6 +8,7 @@
 #include "nucleus/system/scei/cellos/lv2/sys_event.h"
 #include "nucleus/cpu/cpu.h"
 #include "nucleus/cpu/cell.h"
+#include "nucleus/cpu/frontend/spu/spu_cache.h"
 #include "nucleus/cpu/frontend/spu/spu_decoder.h"
 #include "nucleus/cpu/frontend/spu/spu_thread.h"
 #include "nucleus/cpu/frontend/spu/spu_state.h"
@@ -15,6 +16,7 @@
 #include "nucleus/assert.h"
 
 #include <cstring>
+#include <mutex>
 
 namespace sys {
 
@@ -114,11 +116,19 @@ S32 sys_spu_thread_initialize(BE<U32>* thread, U32 group, U32 spu_num, sys_spu_i
         void* srcAddr = nucleus.memory->ptr(seg.src.pa_start);
         if (seg.type == SYS_SPU_SEGMENT_TYPE_COPY) {
             memcpy(dstAddr, srcAddr, seg.size);
-            // Assuming the it contains executable code
-            auto segment = new cpu::frontend::spu::Module(nucleus.cpu.get());
-            segment->address = SPU_LS_OFFSET(spu_num) + seg.ls_start;
-            segment->size = seg.size;
-            static_cast<cpu::Cell*>(nucleus.cpu.get())->spu_modules.push_back(segment);
+            // Assuming the it contains executable code, reuse it if the same program was loaded before
+            const U32 lsAddr = SPU_LS_OFFSET(spu_num) + seg.ls_start;
+            auto segment = spuProgramCache.find(lsAddr, dstAddr, seg.size);
+            if (!segment) {
+                segment = new cpu::frontend::spu::Module(nucleus.cpu.get());
+                segment->address = lsAddr;
+                segment->size = seg.size;
+                segment->name = spuThread->name;
+                segment->hirModule->name = segment->name;
+                spuProgramCache.insert(segment, dstAddr);
+                static_cast<cpu::Cell*>(nucleus.cpu.get())->spu_modules.push_back(segment);
+            }
+            spuThread->thread->modules.push_back(segment);
         }
         if (seg.type == SYS_SPU_SEGMENT_TYPE_FILL) {
             assert_always("Unimplemented");
@@ -207,6 +217,45 @@ S32 sys_spu_thread_read_ls(U32 id, U32 address, BE<U64>* value, U32 type) {
     return CELL_OK;
 }
 
+S32 sys_spu_thread_write_snr(U32 id, S32 number, U32 value) {
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
+    auto* spuThread = lv2.objects.get<SPUThread>(id);
+    if (!spuThread) {
+        return CELL_ESRCH;
+    }
+    if (number != 0 && number != 1) {
+        return CELL_EINVAL;
+    }
+
+    // Each signal notification register has a single producer, so serialize concurrent PPU writers
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& state = *spuThread->thread->state;
+    auto& channel = (number == 0) ? state.chSigNotify1 : state.chSigNotify2;
+    if (!channel.tryWrite(value)) {
+        return CELL_EBUSY;
+    }
+    return CELL_OK;
+}
+
+S32 sys_spu_thread_write_spu_mb(U32 id, U32 value) {
+    LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
+
+    auto* spuThread = lv2.objects.get<SPUThread>(id);
+    if (!spuThread) {
+        return CELL_ESRCH;
+    }
+
+    // The inbound mailbox has a single producer, so serialize concurrent PPU writers
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!spuThread->thread->state->chInMbox.tryWrite(value)) {
+        return CELL_EBUSY;
+    }
+    return CELL_OK;
+}
+
 S32 sys_spu_thread_group_connect_event_all_threads(S32 group_id, U32 equeue_id, U64 req, U08* spup) {
     LV2& lv2 = static_cast<LV2&>(*nucleus.sys.get());
 
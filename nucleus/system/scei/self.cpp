@@ -80,6 +80,8 @@ bool SELFLoader::load_elf(sys::sys_process_t& proc)
                 module->parent = nucleus.cpu.get();
                 module->address = phdr.vaddr;
                 module->size = phdr.filesz;
+                module->name = "main";
+                module->hirModule->name = module->name;
                 if (config.ppuTranslator & CPU_TRANSLATOR_MODULE) {
                     module->analyze();
                     module->recompile();
@@ -290,6 +292,8 @@ bool SELFLoader::load_prx(sys::sys_prx_t& prx)
             auto segment = new cpu::frontend::ppu::Module(nucleus.cpu.get());
             segment->address = prx_segment.addr;
             segment->size = prx_segment.size_file;
+            segment->name = prx.name;
+            segment->hirModule->name = segment->name;
             if (config.ppuTranslator & CPU_TRANSLATOR_MODULE) {
                 segment->analyze();
                 segment->recompile();
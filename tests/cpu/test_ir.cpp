@@ -12,7 +12,14 @@
 #include "nucleus/cpu/hir/function.h"
 #include "nucleus/cpu/hir/module.h"
 #include "nucleus/cpu/hir/passes.h"
+#include "nucleus/cpu/backend/profiler.h"
 #include "nucleus/cpu/backend/x86/x86_compiler.h"
+#if defined(NUCLEUS_ARCH_ARM_64BITS)
+#include "nucleus/cpu/backend/arm/arm_compiler.h"
+#endif
+
+// Utility
+#include "nucleus/core/config.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -41,4 +48,43 @@ public:
         //auto result = function->call(3,4);
         //Assert::IsTrue(result == 28);
     }
+
+#if defined(NUCLEUS_ARCH_ARM_64BITS)
+    TEST_METHOD(CPU_BackendTests_ARM) {
+        // State: {lhs, rhs, result}
+        U64 state[3] = { 3, 4, 0 };
+
+        Module* module = new Module();
+        Function* function = new Function(module, TYPE_VOID);
+        Block* block = new Block(function);
+        block->flags |= BLOCK_IS_ENTRY;
+
+        Builder builder;
+        builder.setInsertPoint(block);
+        auto lhs = builder.createCtxLoad(0 * sizeof(U64), TYPE_I64);
+        auto rhs = builder.createCtxLoad(1 * sizeof(U64), TYPE_I64);
+        auto result = builder.createMul(builder.createAdd(lhs, rhs), builder.getConstantI64(4));
+        builder.createCtxStore(2 * sizeof(U64), result);
+        builder.createRet();
+        function->flags |= FUNCTION_IS_DEFINED;
+
+        // Profile the call, so that the cycle counting epilog runs as well
+        const bool previousProfile = config.profile;
+        const bool previousProfileCycles = config.profileCycles;
+        config.profile = true;
+        config.profileCycles = true;
+
+        Compiler* compiler = new arm::ARMCompiler();
+        compiler->addPass(std::make_unique<passes::RegisterAllocationPass>(compiler->targetInfo));
+        Assert::IsTrue(compiler->compile(function));
+        Assert::IsTrue(compiler->call(function, state));
+        config.profile = previousProfile;
+        config.profileCycles = previousProfileCycles;
+
+        Assert::IsTrue(state[0] == 3);
+        Assert::IsTrue(state[1] == 4);
+        Assert::IsTrue(state[2] == 28);
+        Assert::IsTrue(profiler.getProfile(function)->count == 1);
+    }
+#endif
 };
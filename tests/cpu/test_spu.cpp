@@ -20,3 +20,80 @@ public:
 #include "test_spu.inl"
 #undef INSTRUCTION
 };
+
+TEST_CLASS(SPUThreadTests) {
+    SPUTestRunner test;
+
+public:
+    TEST_METHOD_CATEGORY(call_function, L"SPU Tests") {
+        // Calls between functions listed by the analyzer before they were declared
+        auto run_call = [&](ConfigCpuTranslator translator) {
+            memset(&test.state, 0, sizeof(test.state));
+            test.executeThread([](SPUAssembler& a) {
+                a.il(r3, 1);        // 0x00
+                a.brsl(r0, 2);      // 0x04 -> 0x0C
+                a.stop();           // 0x08
+                a.ai(r3, r3, 41);   // 0x0C
+                a.bi(r0);           // 0x10
+            }, translator);
+            Assert::IsTrue(test.state.r[3].u32[3] == 42);
+        };
+        run_call(CPU_TRANSLATOR_FUNCTION);
+        run_call(CPU_TRANSLATOR_MODULE);
+    }
+
+    TEST_METHOD_CATEGORY(dma_list, L"SPU Tests") {
+        auto& memory = test.memory;
+        const U32 lsAddr = 0xF0000000;
+        const U32 listAddr = lsAddr + 0x1000;
+        const U32 eaAddr = memory->alloc(0x100, 0x80);
+        Assert::IsTrue(eaAddr != 0);
+
+        // List elements: {s|lts, leal}
+        auto set_element = [&](U32 index, U32 s, U32 lts, U32 leal) {
+            memory->write32(listAddr + index * 8 + 0, (s << 16) | lts);
+            memory->write32(listAddr + index * 8 + 4, leal);
+        };
+        for (U32 i = 0; i < 0x100; i++) {
+            memory->write8(eaAddr + i, static_cast<U08>(i));
+            memory->write8(lsAddr + i, 0);
+        }
+
+        SPUThread thread(test.cpu.get());
+
+        // GETL: Contiguous elements are coalesced into a single transfer
+        set_element(0, 0, 0x20, eaAddr + 0x00);
+        set_element(1, 0, 0x20, eaAddr + 0x20);
+        set_element(2, 0, 0x10, eaAddr + 0x80);
+        MFCRequest getl = { MFC_GETL_CMD, 0, lsAddr, listAddr, 3 * 8 };
+        Assert::IsTrue(thread.dmaTransferList(getl));
+        Assert::IsTrue(memory->read8(lsAddr + 0x00) == 0x00);
+        Assert::IsTrue(memory->read8(lsAddr + 0x3F) == 0x3F);
+        Assert::IsTrue(memory->read8(lsAddr + 0x40) == 0x80);
+        Assert::IsTrue(memory->read8(lsAddr + 0x4F) == 0x8F);
+        Assert::IsTrue(memory->read8(lsAddr + 0x50) == 0x00);
+
+        // PUTL: Stall-and-notify splits the list, resuming with the remaining elements
+        set_element(0, 0x8000, 0x10, eaAddr + 0xC0);
+        set_element(1, 0, 0x10, eaAddr + 0xE0);
+        MFCRequest putl = { MFC_PUTL_CMD, 0, lsAddr, listAddr, 2 * 8 };
+        Assert::IsFalse(thread.dmaTransferList(putl));
+        Assert::IsTrue(memory->read8(eaAddr + 0xC0) == 0x00);
+        Assert::IsTrue(memory->read8(eaAddr + 0xCF) == 0x0F);
+        Assert::IsTrue(memory->read8(eaAddr + 0xE0) == 0xE0);
+        Assert::IsTrue(putl.lsa == lsAddr + 0x10);
+        Assert::IsTrue(thread.dmaTransferList(putl));
+        Assert::IsTrue(memory->read8(eaAddr + 0xE0) == 0x10);
+        Assert::IsTrue(memory->read8(eaAddr + 0xEF) == 0x1F);
+
+        // GETL: Stall-and-notify on the last element stalls with no elements left
+        set_element(0, 0x8000, 0x10, eaAddr + 0x40);
+        MFCRequest last = { MFC_GETL_CMD, 0, lsAddr, listAddr, 1 * 8 };
+        Assert::IsFalse(thread.dmaTransferList(last));
+        Assert::IsTrue(memory->read8(lsAddr + 0x00) == 0x40);
+        Assert::IsTrue(last.size == 0);
+        Assert::IsTrue(thread.dmaTransferList(last));
+
+        memory->free(eaAddr);
+    }
+};
@@ -13,16 +13,21 @@
 #include "nucleus/cpu/cpu.h"
 #include "nucleus/cpu/backend/x86/x86_compiler.h"
 #include "nucleus/cpu/backend/spu/spu_assembler.h"
+#include "nucleus/cpu/frontend/spu/spu_decoder.h"
 #include "nucleus/cpu/frontend/spu/spu_state.h"
 #include "nucleus/cpu/frontend/spu/spu_tables.h"
+#include "nucleus/cpu/frontend/spu/spu_thread.h"
 #include "nucleus/cpu/frontend/spu/translator/spu_translator.h"
 #include "nucleus/cpu/hir/block.h"
 #include "nucleus/cpu/hir/function.h"
 #include "nucleus/cpu/hir/module.h"
 #include "nucleus/cpu/hir/passes.h"
+#include "nucleus/memory/memory.h"
+#include "nucleus/memory/guest_virtual/guest_virtual_memory.h"
 
 // Utility
 #include "nucleus/assert.h"
+#include "nucleus/core/config.h"
 
 #include <functional>
 
@@ -54,7 +59,7 @@ public:
     std::unique_ptr<backend::Compiler> compiler;
 
     // Mock hardware
-    std::shared_ptr<mem::Memory> memory;
+    std::shared_ptr<mem::GuestVirtualMemory> memory;
     std::shared_ptr<cpu::CPU> cpu;
 
     U32 buffer[256];
@@ -65,7 +70,7 @@ public:
         function = new hir::Function(module, hir::TYPE_VOID);
 
         // Create mock hardware
-        memory = std::make_shared<mem::Memory>();
+        memory = std::make_shared<mem::GuestVirtualMemory>(0x100000000ULL);
         cpu = std::make_shared<cpu::CPU>(memory);
 
         compiler = std::make_unique<backend::x86::X86Compiler>();
@@ -96,6 +101,33 @@ protected:
         compiler->call(function, &state);
     }
 
+    // Load the program into a local storage segment and run it through the thread translator
+    void executeThread(std::function<void(SPUAssembler&)> spuFunc, ConfigCpuTranslator translator = CPU_TRANSLATOR_FUNCTION) {
+        const U32 lsAddr = 0xF0000000;
+
+        U32 buffer[256];
+        SPUAssembler a(sizeof(buffer), buffer);
+        spuFunc(a);
+        for (Size i = 0; (i * sizeof(U32)) < a.curSize; i++) {
+            memory->write32(lsAddr + i * sizeof(U32), static_cast<U32*>(a.codeAddr)[i]);
+        }
+
+        Module module(cpu.get());
+        module.address = lsAddr;
+        module.size = static_cast<U32>(a.curSize);
+
+        SPUThread thread(cpu.get());
+        thread.modules.push_back(&module);
+        memcpy(thread.state->r, state.r, sizeof(state.r));
+        thread.state->pc = lsAddr;
+
+        const auto previousTranslator = config.spuTranslator;
+        config.spuTranslator = translator;
+        thread.task();
+        config.spuTranslator = previousTranslator;
+        memcpy(state.r, thread.state->r, sizeof(state.r));
+    }
+
 public:
 #define INSTRUCTION(name) void name()
 #include "test_spu.inl"
@@ -0,0 +1,323 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+// Visual Studio testing dependencies
+#include "CppUnitTest.h"
+
+// Target
+#include "nucleus/common.h"
+#include "nucleus/memory/memory.h"
+#include "nucleus/memory/guest_virtual/guest_virtual_memory.h"
+#include "nucleus/memory/swap.h"
+
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// Buffer large enough to exercise the 32-byte vector loop, the 16-byte step and the scalar tail
+#define SWAP_BUFFER_SIZE  1024
+
+using SwapFunction = std::function<void(void*, const void*, Size)>;
+using SwapPathFunction = void(*)(void*, const void*, Size, mem::SwapPath);
+
+// Compare a copy against the scalar reference for many counts, and misaligned heads and tails
+static void checkSwap(SwapFunction copy, SwapFunction scalar, Size elementSize) {
+    U08 src[SWAP_BUFFER_SIZE];
+    U08 expected[SWAP_BUFFER_SIZE];
+    U08 actual[SWAP_BUFFER_SIZE];
+    for (Size i = 0; i < SWAP_BUFFER_SIZE; i++) {
+        src[i] = U08(i * 37 + 11);
+    }
+
+    for (Size srcOffset = 0; srcOffset < 4; srcOffset++) {
+        for (Size dstOffset = 0; dstOffset < 4; dstOffset++) {
+            const Size maxCount = (SWAP_BUFFER_SIZE - 4) / elementSize;
+            for (Size count = 0; count <= maxCount; count++) {
+                memset(expected, 0xCC, sizeof(expected));
+                memset(actual, 0xCC, sizeof(actual));
+                scalar(expected + dstOffset, src + srcOffset, count);
+                copy(actual + dstOffset, src + srcOffset, count);
+                Assert::IsTrue(memcmp(expected, actual, sizeof(actual)) == 0);
+            }
+        }
+    }
+}
+
+// Compare each implementation supported by the host against the scalar reference
+static void checkSwapPaths(SwapPathFunction copy, SwapFunction scalar, Size elementSize) {
+    for (auto path : { mem::SWAP_PATH_SCALAR, mem::SWAP_PATH_SSSE3, mem::SWAP_PATH_AVX2 }) {
+        if (!mem::isSwapPathSupported(path)) {
+            continue;
+        }
+        checkSwap([=](void* dst, const void* src, Size count) {
+            copy(dst, src, count, path);
+        }, scalar, elementSize);
+    }
+}
+
+TEST_CLASS(MemoryTests) {
+
+public:
+    TEST_METHOD(Memory_CopySwapScalar) {
+        const U16 value16 = 0x1122;
+        const U32 value32 = 0x11223344;
+        const U64 value64 = 0x1122334455667788ULL;
+        U16 result16;
+        U32 result32;
+        U64 result64;
+
+        mem::copySwap16Scalar(&result16, &value16, 1);
+        mem::copySwap32Scalar(&result32, &value32, 1);
+        mem::copySwap64Scalar(&result64, &value64, 1);
+        Assert::IsTrue(result16 == 0x2211);
+        Assert::IsTrue(result32 == 0x44332211);
+        Assert::IsTrue(result64 == 0x8877665544332211ULL);
+    }
+
+    TEST_METHOD(Memory_CopySwap16) {
+        checkSwap(static_cast<void(*)(void*, const void*, Size)>(mem::copySwap16), mem::copySwap16Scalar, 2);
+        checkSwapPaths(mem::copySwap16, mem::copySwap16Scalar, 2);
+    }
+
+    TEST_METHOD(Memory_CopySwap32) {
+        checkSwap(static_cast<void(*)(void*, const void*, Size)>(mem::copySwap32), mem::copySwap32Scalar, 4);
+        checkSwapPaths(mem::copySwap32, mem::copySwap32Scalar, 4);
+    }
+
+    TEST_METHOD(Memory_CopySwap64) {
+        checkSwap(static_cast<void(*)(void*, const void*, Size)>(mem::copySwap64), mem::copySwap64Scalar, 8);
+        checkSwapPaths(mem::copySwap64, mem::copySwap64Scalar, 8);
+    }
+
+    TEST_METHOD(Memory_CopySwapInPlace) {
+        U32 buffer[64];
+        U32 expected[64];
+        for (U32 i = 0; i < 64; i++) {
+            buffer[i] = 0x01020304 * (i + 1);
+            expected[i] = SE32(buffer[i]);
+        }
+        mem::copySwap32(buffer, buffer, 64);
+        Assert::IsTrue(memcmp(buffer, expected, sizeof(buffer)) == 0);
+    }
+
+    TEST_METHOD(Memory_CopySwapStrided) {
+        mem::GuestVirtualMemory memory(0x100000000ULL);
+        const U32 addr = memory.alloc(0x1000);
+        Assert::IsTrue(addr != 0);
+
+        // Records of 3 elements, with 4 padding bytes after each one
+        const U32 components = 3;
+        const U32 count = 16;
+        auto check = [&](Size elementSize, auto copyFrom, auto copyTo, auto swap) {
+            const U32 stride = U32(components * elementSize + 4);
+            U08* guest = memory.ptr<U08>(addr);
+            for (U32 i = 0; i < 0x1000; i++) {
+                guest[i] = U08(i * 37 + 11);
+            }
+
+            // Guest to host: Records are packed and each element swapped
+            std::vector<U08> host(components * count * elementSize);
+            copyFrom(host.data(), addr, stride, components, count);
+            for (U32 i = 0; i < count; i++) {
+                for (U32 j = 0; j < components; j++) {
+                    const U08* g = guest + i * stride + j * elementSize;
+                    const U08* h = host.data() + (i * components + j) * elementSize;
+                    Assert::IsTrue(swap(g, h, elementSize));
+                }
+            }
+
+            // Host to guest: Only the elements are written, keeping the padding
+            std::vector<U08> before(guest, guest + 0x1000);
+            for (auto& byte : host) {
+                byte = U08(~byte);
+            }
+            copyTo(addr, host.data(), stride, components, count);
+            for (U32 i = 0; i < count * stride; i++) {
+                const U32 offset = i % stride;
+                if (offset >= components * elementSize) {
+                    Assert::IsTrue(guest[i] == before[i]);
+                    continue;
+                }
+                const U08* g = guest + i - (offset % elementSize);
+                const U08* h = host.data() + ((i / stride) * components + offset / elementSize) * elementSize;
+                Assert::IsTrue(swap(g, h, elementSize));
+            }
+        };
+
+        // Whether two elements hold the same bytes in reverse order
+        auto isSwapped = [](const U08* a, const U08* b, Size size) {
+            for (Size k = 0; k < size; k++) {
+                if (a[k] != b[size - 1 - k]) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        using namespace std::placeholders;
+        check(2, std::bind(&mem::GuestVirtualMemory::copyFromGuestSwapStrided16, &memory, _1, _2, _3, _4, _5),
+                 std::bind(&mem::GuestVirtualMemory::copyToGuestSwapStrided16, &memory, _1, _2, _3, _4, _5), isSwapped);
+        check(4, std::bind(&mem::GuestVirtualMemory::copyFromGuestSwapStrided32, &memory, _1, _2, _3, _4, _5),
+                 std::bind(&mem::GuestVirtualMemory::copyToGuestSwapStrided32, &memory, _1, _2, _3, _4, _5), isSwapped);
+        check(8, std::bind(&mem::GuestVirtualMemory::copyFromGuestSwapStrided64, &memory, _1, _2, _3, _4, _5),
+                 std::bind(&mem::GuestVirtualMemory::copyToGuestSwapStrided64, &memory, _1, _2, _3, _4, _5), isSwapped);
+        memory.free(addr);
+    }
+
+    TEST_METHOD(Memory_SegmentAllocFree) {
+        mem::GuestVirtualMemory memory(0x100000000ULL);
+        auto& segment = memory.getSegment(mem::SEG_MMAPPER_MEMORY);
+        const U32 base = segment.getBaseAddr();
+        const U32 total = segment.getTotalMemory();
+
+        // Blocks are carved from the start of the only free range
+        const U32 a = segment.alloc(0x1000);
+        const U32 b = segment.alloc(0x2800);
+        const U32 c = segment.alloc(0x1000);
+        Assert::IsTrue(a == base);
+        Assert::IsTrue(b == base + 0x1000);
+        Assert::IsTrue(c == base + 0x4000);
+        Assert::IsTrue(segment.getUsedMemory() == 0x5000);
+        Assert::IsTrue(segment.getFreeRangeCount() == 1);
+
+        // Aligned blocks give back the space skipped before them
+        const U32 d = segment.alloc(0x1000, 0x10000);
+        Assert::IsTrue(d == base + 0x10000);
+        Assert::IsTrue(segment.getFreeRangeCount() == 2);
+        Assert::IsTrue(segment.getLargestFreeBlock() == total - 0x11000);
+
+        // Fixed blocks must lie within a single free range
+        Assert::IsTrue(segment.free(b));
+        Assert::IsTrue(segment.getFreeRangeCount() == 3);
+        Assert::IsTrue(segment.allocFixed(base + 0x3000, 0x3000) == 0);
+        Assert::IsTrue(segment.getFreeRangeCount() == 3);
+        Assert::IsTrue(segment.allocFixed(base + 0x6000, 0x1000) == base + 0x6000);
+        Assert::IsTrue(segment.getFreeRangeCount() == 4);
+        Assert::IsTrue(segment.free(base + 0x6000));
+        Assert::IsTrue(segment.getFreeRangeCount() == 3);
+
+        // Freed blocks merge with the free ranges at both sides
+        Assert::IsTrue(!segment.free(b));
+        Assert::IsTrue(segment.free(c));
+        Assert::IsTrue(segment.getFreeRangeCount() == 2);
+        Assert::IsTrue(segment.free(a));
+        Assert::IsTrue(segment.getFreeRangeCount() == 2);
+        Assert::IsTrue(segment.getLargestFreeBlock() == total - 0x11000);
+        Assert::IsTrue(segment.free(d));
+        Assert::IsTrue(segment.getFreeRangeCount() == 1);
+        Assert::IsTrue(segment.getLargestFreeBlock() == total);
+        Assert::IsTrue(segment.getUsedMemory() == 0);
+        Assert::IsTrue(segment.getPeakMemory() == 0x6000);
+        Assert::IsTrue(segment.getBlockCount() == 0);
+    }
+
+    TEST_METHOD(Memory_SegmentFragmentation) {
+        mem::GuestVirtualMemory memory(0x100000000ULL);
+        auto& segment = memory.getSegment(mem::SEG_MMAPPER_MEMORY);
+        const U32 base = segment.getBaseAddr();
+        const U32 total = segment.getTotalMemory();
+
+        // Leave eight isolated holes of 4 KB before the remaining free space
+        std::vector<U32> blocks;
+        for (U32 i = 0; i < 16; i++) {
+            blocks.push_back(segment.alloc(0x1000));
+            Assert::IsTrue(blocks.back() == base + i * 0x1000);
+        }
+        for (U32 i = 0; i < 16; i += 2) {
+            Assert::IsTrue(segment.free(blocks[i]));
+        }
+        Assert::IsTrue(segment.getFreeRangeCount() == 9);
+        Assert::IsTrue(segment.getLargestFreeBlock() == total - 0x10000);
+        Assert::IsTrue(segment.getBlockCount() == 8);
+
+        // Blocks larger than the holes go after them, while smaller ones fill a hole
+        const U32 large = segment.alloc(0x2000);
+        Assert::IsTrue(large == base + 0x10000);
+        const U32 small = segment.alloc(0x1000);
+        Assert::IsTrue(small < base + 0x10000 && (small - base) % 0x2000 == 0);
+        Assert::IsTrue(segment.getFreeRangeCount() == 8);
+
+        Assert::IsTrue(segment.free(large));
+        Assert::IsTrue(segment.free(small));
+        for (U32 i = 1; i < 16; i += 2) {
+            Assert::IsTrue(segment.free(blocks[i]));
+        }
+        Assert::IsTrue(segment.getFreeRangeCount() == 1);
+        Assert::IsTrue(segment.getLargestFreeBlock() == total);
+    }
+
+    TEST_METHOD(Memory_PageFlags) {
+        mem::GuestVirtualMemory memory(0x100000000ULL);
+        const U08 access = mem::PAGE_ALLOCATED | mem::PAGE_READ | mem::PAGE_WRITE;
+
+        // Every 4 KB page of a block records its access and the size of its guest pages
+        const U32 addr4k = memory.alloc(0x2000);
+        const U32 addr64k = memory.alloc(0x20000, 64_KB);
+        const U32 addr1m = memory.alloc(0x100000, 1_MB);
+        Assert::IsTrue(addr4k != 0 && addr64k != 0 && addr1m != 0);
+        Assert::IsTrue(addr64k % 64_KB == 0 && addr1m % 1_MB == 0);
+        for (U32 offset = 0; offset < 0x2000; offset += GUEST_PAGE_SIZE) {
+            Assert::IsTrue(memory.getPageFlags(addr4k + offset) == access);
+        }
+        for (U32 offset = 0; offset < 0x20000; offset += GUEST_PAGE_SIZE) {
+            Assert::IsTrue(memory.getPageFlags(addr64k + offset) == (access | mem::PAGE_SIZE_64K));
+        }
+        for (U32 offset = 0; offset < 0x100000; offset += GUEST_PAGE_SIZE) {
+            Assert::IsTrue(memory.getPageFlags(addr1m + offset) == (access | mem::PAGE_SIZE_1M));
+        }
+        Assert::IsTrue(memory.check(addr4k));
+        Assert::IsTrue(memory.getPageFlags(addr4k + 0x2000) == 0);
+
+        // Freed pages are cleared entirely
+        memory.free(addr4k);
+        memory.free(addr64k);
+        memory.free(addr1m);
+        Assert::IsTrue(memory.getPageFlags(addr4k) == 0);
+        Assert::IsTrue(memory.getPageFlags(addr4k + 0x1000) == 0);
+        Assert::IsTrue(memory.getPageFlags(addr64k + 0x1F000) == 0);
+        Assert::IsTrue(memory.getPageFlags(addr1m + 0xFF000) == 0);
+        Assert::IsTrue(!memory.check(addr4k));
+    }
+
+    TEST_METHOD(Memory_WatchWrites) {
+        mem::GuestVirtualMemory memory(0x100000000ULL);
+        const U32 addr = memory.alloc(0x2000);
+        Assert::IsTrue(addr != 0);
+
+        std::atomic<U32> doorbell(0);
+        const mem::WatchHandle handle = memory.watchWrites(addr, 0x2000, &doorbell);
+        Assert::IsTrue(handle != GUEST_WATCH_INVALID);
+        Assert::IsTrue(memory.getPageFlags(addr) & mem::PAGE_GPU);
+        Assert::IsTrue(!memory.isDirty(addr, 0x2000));
+
+        // Only the first write to a clean page marks it as dirty and rings the doorbell
+        memory.write32(addr + 0x10, 0x11223344);
+        memory.write32(addr + 0x20, 0x55667788);
+        Assert::IsTrue(doorbell.load() == 1);
+        Assert::IsTrue(memory.getPageFlags(addr) & mem::PAGE_DIRTY);
+        Assert::IsTrue(memory.isDirty(addr, 0x1000));
+        Assert::IsTrue(!memory.isDirty(addr + 0x1000, 0x1000));
+        Assert::IsTrue(memory.read32(addr + 0x10) == 0x11223344);
+        Assert::IsTrue(memory.read32(addr + 0x20) == 0x55667788);
+
+        // Resetting protects the page again, so the next write is reported as well
+        std::vector<U32> pages;
+        Assert::IsTrue(memory.resetDirty(addr, 0x2000, &pages) == 1);
+        Assert::IsTrue(pages.size() == 1 && pages[0] == addr);
+        Assert::IsTrue(!memory.isDirty(addr, 0x2000));
+        memory.write32(addr + 0x10, 0);
+        Assert::IsTrue(doorbell.load() == 2);
+
+        // Unwatched pages are writable without further notifications
+        memory.unwatchWrites(handle);
+        Assert::IsTrue(!(memory.getPageFlags(addr + 0x1000) & (mem::PAGE_GPU | mem::PAGE_DIRTY)));
+        memory.write32(addr + 0x1000, 0);
+        Assert::IsTrue(doorbell.load() == 2);
+        memory.free(addr);
+    }
+};
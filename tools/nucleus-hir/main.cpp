@@ -0,0 +1,248 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+// Nucleus
+#include "nucleus/common.h"
+#include "nucleus/cpu/hir/function.h"
+#include "nucleus/cpu/hir/module.h"
+#include "nucleus/cpu/hir/passes.h"
+#include "nucleus/logger/logger.h"
+
+// Backends
+#if defined(NUCLEUS_ARCH_X86)
+#include "nucleus/cpu/backend/x86/x86_compiler.h"
+#elif defined(NUCLEUS_ARCH_ARM)
+#include "nucleus/cpu/backend/arm/arm_compiler.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace cpu;
+
+struct Options {
+    std::string command;
+    std::string input;
+    std::string output;    // Path where the optimized module is saved
+    std::string function;  // Only process the function with this name
+    int iterations = 100;
+};
+
+static void printUsage() {
+    printf(
+        "Usage: nucleus-hir <command> [options] path/to/module.hir\n"
+        "Commands:\n"
+        "  dump           Print the HIR of the module.\n"
+        "  optimize       Run the optimization passes and print the resulting HIR.\n"
+        "  compile        Compile each function for the host and print its native size.\n"
+        "  time           Measure the time to optimize and compile each function.\n"
+        "Options:\n"
+        "  -f <name>      Only process the function with the given name, e.g. ppu_00010200.\n"
+        "  -n <count>     Number of iterations for the time command (default: 100).\n"
+        "  -o <path>      Save the optimized module to the given path.\n");
+}
+
+static bool parseArguments(int argc, char** argv, Options& options) {
+    if (argc < 3) {
+        return false;
+    }
+    options.command = argv[1];
+    for (int i = 2; i < argc; i++) {
+        if (!strcmp(argv[i], "-f") && i + 1 < argc) {
+            options.function = argv[++i];
+        } else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            options.iterations = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+            options.output = argv[++i];
+        } else {
+            options.input = argv[i];
+        }
+    }
+    return !options.input.empty();
+}
+
+/**
+ * Optimization pipeline: generic passes followed by the mandatory ones
+ */
+static std::vector<std::unique_ptr<hir::Pass>> createPasses(const backend::TargetInfo& targetInfo) {
+    std::vector<std::unique_ptr<hir::Pass>> passes;
+    passes.push_back(std::make_unique<hir::passes::DeadCodeEliminationPass>());
+    passes.push_back(std::make_unique<hir::passes::RegisterAllocationPass>(targetInfo));
+    return passes;
+}
+
+static std::unique_ptr<backend::Compiler> createCompiler() {
+    std::unique_ptr<backend::Compiler> compiler;
+#if defined(NUCLEUS_ARCH_X86)
+    compiler = std::make_unique<backend::x86::X86Compiler>();
+#elif defined(NUCLEUS_ARCH_ARM)
+    compiler = std::make_unique<backend::arm::ARMCompiler>();
+#endif
+    if (!compiler) {
+        logger.error(LOG_CPU, "No backend available for this architecture");
+        return nullptr;
+    }
+    if (compiler->targetInfo.regSets.empty()) {
+        logger.error(LOG_CPU, "Backend does not define register sets for this platform");
+        return nullptr;
+    }
+    for (auto& pass : createPasses(compiler->targetInfo)) {
+        compiler->addPass(std::move(pass));
+    }
+    return compiler;
+}
+
+/**
+ * Get the functions of a module that should be processed
+ */
+static std::vector<hir::Function*> getFunctions(hir::Module* module, const Options& options) {
+    std::vector<hir::Function*> functions;
+    for (auto* function : module->functions) {
+        if ((function->flags & hir::FUNCTION_IS_EXTERN) || !(function->flags & hir::FUNCTION_IS_DEFINED)) {
+            continue;
+        }
+        if (!options.function.empty() && function->name != options.function) {
+            continue;
+        }
+        functions.push_back(function);
+    }
+    return functions;
+}
+
+static int commandDump(hir::Module* module, const Options& options) {
+    for (auto* function : getFunctions(module, options)) {
+        printf("; %s\n%s", function->name.c_str(), function->dump().c_str());
+    }
+    return 0;
+}
+
+static int commandOptimize(hir::Module* module, const Options& options) {
+    auto compiler = createCompiler();
+    if (!compiler) {
+        return 1;
+    }
+
+    auto passes = createPasses(compiler->targetInfo);
+    for (auto* function : getFunctions(module, options)) {
+        for (auto& pass : passes) {
+            if (!pass->run(function)) {
+                logger.error(LOG_CPU, "Could not run pass %s on %s", pass->name(), function->name.c_str());
+                return 1;
+            }
+        }
+        printf("; %s\n%s", function->name.c_str(), function->dump().c_str());
+    }
+    if (!options.output.empty() && !module->save(options.output)) {
+        return 1;
+    }
+    return 0;
+}
+
+static int commandCompile(hir::Module* module, const Options& options) {
+    auto compiler = createCompiler();
+    if (!compiler) {
+        return 1;
+    }
+
+    U64 totalSize = 0;
+    for (auto* function : getFunctions(module, options)) {
+        if (!compiler->compile(function)) {
+            logger.error(LOG_CPU, "Could not compile %s", function->name.c_str());
+            return 1;
+        }
+        printf("%-24s %8llu bytes\n", function->name.c_str(), static_cast<unsigned long long>(function->nativeSize));
+        totalSize += function->nativeSize;
+    }
+    printf("%-24s %8llu bytes\n", "Total", static_cast<unsigned long long>(totalSize));
+    return 0;
+}
+
+static int commandTime(const std::vector<U08>& buffer, const Options& options) {
+    using Clock = std::chrono::high_resolution_clock;
+
+    auto compiler = createCompiler();
+    if (!compiler) {
+        return 1;
+    }
+
+    // Compilation modifies the HIR, so every iteration works on a fresh copy of the module
+    hir::Module reference;
+    reference.deserialize(buffer.data(), buffer.size());
+    const auto names = getFunctions(&reference, options);
+
+    printf("%-24s %12s %12s %12s\n", "Function", "Min (us)", "Avg (us)", "Max (us)");
+    for (const auto* target : names) {
+        Options single = options;
+        single.function = target->name;
+
+        double minTime = 0.0;
+        double maxTime = 0.0;
+        double sumTime = 0.0;
+        for (int i = 0; i < options.iterations; i++) {
+            hir::Module module;
+            module.deserialize(buffer.data(), buffer.size());
+            const auto functions = getFunctions(&module, single);
+            if (functions.empty()) {
+                break;
+            }
+            auto* function = functions[0];
+
+            const auto start = Clock::now();
+            const bool success = compiler->compile(function);
+            const auto end = Clock::now();
+            if (!success) {
+                logger.error(LOG_CPU, "Could not compile %s", function->name.c_str());
+                return 1;
+            }
+            compiler->freeRWXMemory(function->nativeAddress.load());
+            for (auto* f : module.functions) {
+                delete f;
+            }
+
+            const double time = std::chrono::duration<double, std::micro>(end - start).count();
+            minTime = (i == 0) ? time : std::min(minTime, time);
+            maxTime = (i == 0) ? time : std::max(maxTime, time);
+            sumTime += time;
+        }
+        printf("%-24s %12.2f %12.2f %12.2f\n", target->name.c_str(), minTime, sumTime / options.iterations, maxTime);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    // Load module
+    hir::Module module;
+    if (!module.load(options.input)) {
+        return 1;
+    }
+
+    if (options.command == "dump") {
+        return commandDump(&module, options);
+    }
+    if (options.command == "optimize") {
+        return commandOptimize(&module, options);
+    }
+    if (options.command == "compile") {
+        return commandCompile(&module, options);
+    }
+    if (options.command == "time") {
+        return commandTime(module.serialize(), options);
+    }
+
+    printUsage();
+    return 1;
+}
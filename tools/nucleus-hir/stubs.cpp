@@ -0,0 +1,42 @@
+/**
+ * (c) 2014-2016 Alexandro Sanchez Bach. All rights reserved.
+ * Released under GPL v2 license. Read LICENSE for more details.
+ */
+
+// Nucleus
+#include "nucleus/common.h"
+#include "nucleus/cpu/util.h"
+#include "nucleus/assert.h"
+
+/**
+ * The HIR builder identifies calls to these emulator entry points by their address.
+ * The tool never runs the generated code, so they only need to exist at link time.
+ */
+namespace cpu {
+
+void nucleusTranslate(void* guestFunc, U64 guestAddr) {
+    assert_always("Unreachable");
+}
+
+void nucleusCall(U64 guestAddr) {
+    assert_always("Unreachable");
+}
+
+void nucleusSysCall() {
+    assert_always("Unreachable");
+}
+
+void nucleusHook(U32 fnid) {
+    assert_always("Unreachable");
+}
+
+void nucleusLog(U64 guestAddr) {
+    assert_always("Unreachable");
+}
+
+U64 nucleusTime() {
+    assert_always("Unreachable");
+    return 0;
+}
+
+}  // namespace cpu